@@ -70,6 +70,7 @@
 #include "base/net/downloadmanager.h"
 #include "base/net/geoipmanager.h"
 #include "base/net/proxyconfigurationmanager.h"
+#include "base/net/reverseresolution.h"
 #include "base/net/smtp.h"
 #include "base/preferences.h"
 #include "base/profile.h"
@@ -110,6 +111,8 @@ namespace
     const QString KEY_FILELOGGER_MAXSIZEBYTES = FILELOGGER_SETTINGS_KEY("MaxSizeBytes");
     const QString KEY_FILELOGGER_AGE = FILELOGGER_SETTINGS_KEY("Age");
     const QString KEY_FILELOGGER_AGETYPE = FILELOGGER_SETTINGS_KEY("AgeType");
+    const QString KEY_FILELOGGER_COMPRESSBACKUPS = FILELOGGER_SETTINGS_KEY("CompressBackups");
+    const QString KEY_FILELOGGER_OVERLOADPOLICY = FILELOGGER_SETTINGS_KEY("OverloadPolicy");
 
     // just a shortcut
     inline SettingsStorage *settings() { return  SettingsStorage::instance(); }
@@ -179,7 +182,7 @@ Application::Application(int &argc, char **argv)
 #endif
 
     if (isFileLoggerEnabled())
-        m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
+        createFileLogger();
 
     Logger::instance()->addMessage(tr("qBittorrent %1 started", "qBittorrent v3.2.0alpha started").arg(QBT_VERSION));
     if (portableModeEnabled)
@@ -221,7 +224,7 @@ bool Application::isFileLoggerEnabled() const
 void Application::setFileLoggerEnabled(const bool value)
 {
     if (value && !m_fileLogger)
-        m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
+        createFileLogger();
     else if (!value)
         delete m_fileLogger;
     settings()->storeValue(KEY_FILELOGGER_ENABLED, value);
@@ -300,6 +303,39 @@ void Application::setFileLoggerAgeType(const int value)
     settings()->storeValue(KEY_FILELOGGER_AGETYPE, ((value < 0) || (value > 2)) ? 1 : value);
 }
 
+bool Application::isFileLoggerCompressBackups() const
+{
+    return settings()->loadValue(KEY_FILELOGGER_COMPRESSBACKUPS, false);
+}
+
+void Application::setFileLoggerCompressBackups(const bool value)
+{
+    if (m_fileLogger)
+        m_fileLogger->setCompressBackups(value);
+    settings()->storeValue(KEY_FILELOGGER_COMPRESSBACKUPS, value);
+}
+
+int Application::fileLoggerOverloadPolicy() const
+{
+    const int val = settings()->loadValue(KEY_FILELOGGER_OVERLOADPOLICY, static_cast<int>(FileLogger::DropMessages));
+    return ((val < 0) || (val > 1)) ? FileLogger::DropMessages : val;
+}
+
+void Application::setFileLoggerOverloadPolicy(const int value)
+{
+    const int policy = ((value < 0) || (value > 1)) ? FileLogger::DropMessages : value;
+    if (m_fileLogger)
+        m_fileLogger->setOverloadPolicy(static_cast<FileLogger::OverloadPolicy>(policy));
+    settings()->storeValue(KEY_FILELOGGER_OVERLOADPOLICY, policy);
+}
+
+void Application::createFileLogger()
+{
+    m_fileLogger = new FileLogger(fileLoggerPath(), isFileLoggerBackup(), fileLoggerMaxSize(), isFileLoggerDeleteOld(), fileLoggerAge(), static_cast<FileLogger::FileLogAgeType>(fileLoggerAgeType()));
+    m_fileLogger->setCompressBackups(isFileLoggerCompressBackups());
+    m_fileLogger->setOverloadPolicy(static_cast<FileLogger::OverloadPolicy>(fileLoggerOverloadPolicy()));
+}
+
 void Application::processMessage(const QString &message)
 {
     const QStringList params = message.split(PARAMS_SEPARATOR, QString::SkipEmptyParts);
@@ -643,6 +679,7 @@ int Application::exec(const QStringList &params)
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::allTorrentsFinished, this, &Application::allTorrentsFinished, Qt::QueuedConnection);
 
         Net::GeoIPManager::initInstance();
+        Net::ReverseResolution::initInstance();
         ScanFoldersModel::initInstance();
 
 #ifndef DISABLE_WEBUI
@@ -841,6 +878,7 @@ void Application::cleanup()
 
     ScanFoldersModel::freeInstance();
     BitTorrent::Session::freeInstance();
+    Net::ReverseResolution::freeInstance();
     Net::GeoIPManager::freeInstance();
     Net::DownloadManager::freeInstance();
     Net::ProxyConfigurationManager::freeInstance();
@@ -102,6 +102,10 @@ public:
     void setFileLoggerAge(int value);
     int fileLoggerAgeType() const;
     void setFileLoggerAgeType(int value);
+    bool isFileLoggerCompressBackups() const;
+    void setFileLoggerCompressBackups(bool value);
+    int fileLoggerOverloadPolicy() const;
+    void setFileLoggerOverloadPolicy(int value);
 
 protected:
 #ifndef DISABLE_GUI
@@ -140,6 +144,7 @@ private:
     QTranslator m_translator;
     QStringList m_paramsQueue;
 
+    void createFileLogger();
     void initializeTranslation();
     void processParams(const QStringList &params);
     void runExternalProgram(const BitTorrent::Torrent *torrent) const;
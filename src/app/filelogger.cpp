@@ -28,47 +28,101 @@
 
 #include "filelogger.h"
 
-#include <chrono>
-
 #include <QDateTime>
 #include <QDir>
-#include <QTextStream>
-#include <QVector>
+#include <QThread>
 
 #include "base/global.h"
-#include "base/logger.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 
 namespace
 {
-    const std::chrono::seconds FLUSH_INTERVAL {2};
+    // enough to hold a full replay of the in-memory log
+    const int MAX_PENDING_MESSAGES = MAX_LOG_MESSAGES;
+
+    QByteArray formatMessage(const Log::MsgType type, const qint64 timestamp, const QString &message)
+    {
+        QByteArray line;
+
+        switch (type)
+        {
+        case Log::INFO:
+            line = "(I) ";
+            break;
+        case Log::WARNING:
+            line = "(W) ";
+            break;
+        case Log::CRITICAL:
+            line = "(C) ";
+            break;
+        default:
+            line = "(N) ";
+        }
+
+        line += QDateTime::fromMSecsSinceEpoch(timestamp).toString(Qt::ISODate).toLatin1();
+        line += " - ";
+        line += message.toUtf8();
+        line += '\n';
+        return line;
+    }
 }
 
-FileLogger::FileLogger(const QString &path, const bool backup, const int maxSize, const bool deleteOld, const int age, const FileLogAgeType ageType)
+FileLoggerWriter::FileLoggerWriter(const bool backup, const int maxSize)
     : m_backup(backup)
     , m_maxSize(maxSize)
 {
-    m_flusher.setInterval(FLUSH_INTERVAL);
-    m_flusher.setSingleShot(true);
-    connect(&m_flusher, &QTimer::timeout, this, &FileLogger::flushLog);
+}
 
-    changePath(path);
-    if (deleteOld)
-        this->deleteOld(age, ageType);
+FileLoggerWriter::~FileLoggerWriter()
+{
+    closeLogFile();
+}
 
-    const Logger *const logger = Logger::instance();
-    for (const Log::Msg &msg : asConst(logger->getMessages()))
-        addLogMessage(msg);
+bool FileLoggerWriter::enqueue(const Log::Msg &msg, const bool wait)
+{
+    QMutexLocker locker(&m_pendingMutex);
 
-    connect(logger, &Logger::newLogMessage, this, &FileLogger::addLogMessage);
+    while (m_pendingMessages.size() >= MAX_PENDING_MESSAGES)
+    {
+        if (!wait)
+        {
+            ++m_droppedMessages;
+            Logger::instance()->addFileLogCounts(0, 1);
+            return false;
+        }
+
+        m_pendingSpaceAvailable.wait(&m_pendingMutex);
+    }
+
+    m_pendingMessages.append(msg);
+
+    // everything queued until the writer gets to it is written as a single batch
+    if (!m_isWriteScheduled)
+    {
+        m_isWriteScheduled = true;
+        QMetaObject::invokeMethod(this, "writePending", Qt::QueuedConnection);
+    }
+
+    return true;
 }
 
-FileLogger::~FileLogger()
+void FileLoggerWriter::setBackup(const bool value)
 {
-    closeLogFile();
+    m_backup = value;
 }
 
-void FileLogger::changePath(const QString &newPath)
+void FileLoggerWriter::setMaxSize(const int value)
+{
+    m_maxSize = value;
+}
+
+void FileLoggerWriter::setCompressBackups(const bool value)
+{
+    m_compressBackups = value;
+}
+
+void FileLoggerWriter::changePath(const QString &newPath)
 {
     const QDir dir(newPath);
     dir.mkpath(newPath);
@@ -84,7 +138,7 @@ void FileLogger::changePath(const QString &newPath)
     }
 }
 
-void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
+void FileLoggerWriter::deleteOld(const int age, const int ageType)
 {
     const QDateTime date = QDateTime::currentDateTime();
     const QDir dir(Utils::Fs::branchPath(m_path));
@@ -96,10 +150,10 @@ void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
         QDateTime modificationDate = file.lastModified();
         switch (ageType)
         {
-        case DAYS:
+        case FileLogger::DAYS:
             modificationDate = modificationDate.addDays(age);
             break;
-        case MONTHS:
+        case FileLogger::MONTHS:
             modificationDate = modificationDate.addMonths(age);
             break;
         default:
@@ -111,80 +165,155 @@ void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
     }
 }
 
-void FileLogger::setBackup(const bool value)
+void FileLoggerWriter::writePending()
 {
-    m_backup = value;
+    QVector<Log::Msg> messages;
+    {
+        const QMutexLocker locker(&m_pendingMutex);
+        messages.swap(m_pendingMessages);
+        m_isWriteScheduled = false;
+    }
+    m_pendingSpaceAvailable.wakeAll();
+
+    if (messages.isEmpty() || !m_logFile.isOpen())
+        return;
+
+    QByteArray data;
+
+    const qint64 droppedMessages = m_droppedMessages - m_reportedDroppedMessages;
+    if (droppedMessages > 0)
+    {
+        m_reportedDroppedMessages += droppedMessages;
+        data += formatMessage(Log::WARNING, QDateTime::currentMSecsSinceEpoch()
+            , FileLogger::tr("%1 log messages were not written to the file because of the overload.").arg(droppedMessages));
+    }
+
+    for (const Log::Msg &msg : asConst(messages))
+        data += formatMessage(msg.type, msg.timestamp, msg.message);
+
+    m_logFile.write(data);
+    m_logFile.flush();
+    Logger::instance()->addFileLogCounts(messages.size(), 0);
+
+    if (m_backup && (m_logFile.size() >= m_maxSize))
+        rotateLogFile();
 }
 
-void FileLogger::setMaxSize(const int value)
+void FileLoggerWriter::openLogFile()
 {
-    m_maxSize = value;
+    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)
+        || !m_logFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner))
+    {
+        m_logFile.close();
+        LogMsg(FileLogger::tr("An error occurred while trying to open the log file. Logging to file is disabled."), Log::CRITICAL);
+    }
 }
 
-void FileLogger::addLogMessage(const Log::Msg &msg)
+void FileLoggerWriter::closeLogFile()
+{
+    m_logFile.close();
+}
+
+void FileLoggerWriter::rotateLogFile()
 {
-    if (!m_logFile.isOpen()) return;
+    closeLogFile();
 
-    QTextStream stream(&m_logFile);
-    stream.setCodec("UTF-8");
+    int counter = 0;
+    QString backupLogFilename = m_path + ".bak";
 
-    switch (msg.type)
+    while (QFile::exists(backupLogFilename) || QFile::exists(backupLogFilename + ".gz"))
     {
-    case Log::INFO:
-        stream << "(I) ";
-        break;
-    case Log::WARNING:
-        stream << "(W) ";
-        break;
-    case Log::CRITICAL:
-        stream << "(C) ";
-        break;
-    default:
-        stream << "(N) ";
+        ++counter;
+        backupLogFilename = m_path + ".bak" + QString::number(counter);
     }
 
-    stream << QDateTime::fromMSecsSinceEpoch(msg.timestamp).toString(Qt::ISODate) << " - " << msg.message << '\n';
-
-    if (m_backup && (m_logFile.size() >= m_maxSize))
+    bool isCompressed = false;
+    if (m_compressBackups)
     {
-        closeLogFile();
-        int counter = 0;
-        QString backupLogFilename = m_path + ".bak";
-
-        while (QFile::exists(backupLogFilename))
+        QFile logFile(m_path);
+        QFile backupFile(backupLogFilename + ".gz");
+        if (logFile.open(QIODevice::ReadOnly))
         {
-            ++counter;
-            backupLogFilename = m_path + ".bak" + QString::number(counter);
+            bool ok = false;
+            const QByteArray compressedData = Utils::Gzip::compress(logFile.readAll(), 6, &ok);
+            logFile.close();
+
+            isCompressed = ok && backupFile.open(QIODevice::WriteOnly)
+                && (backupFile.write(compressedData) == compressedData.size());
+            backupFile.close();
+
+            if (isCompressed)
+                Utils::Fs::forceRemove(m_path);
+            else
+                Utils::Fs::forceRemove(backupFile.fileName());
         }
+    }
 
+    if (!isCompressed)
         QFile::rename(m_path, backupLogFilename);
-        openLogFile();
-    }
-    else
-    {
-        if (!m_flusher.isActive())
-            m_flusher.start();
-    }
+
+    openLogFile();
+}
+
+FileLogger::FileLogger(const QString &path, const bool backup, const int maxSize, const bool deleteOld, const int age, const FileLogAgeType ageType)
+    : m_writerThread(new QThread(this))
+    , m_writer(new FileLoggerWriter(backup, maxSize))
+{
+    m_writer->moveToThread(m_writerThread);
+    connect(m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    m_writerThread->start();
+
+    changePath(path);
+    if (deleteOld)
+        this->deleteOld(age, ageType);
+
+    const Logger *const logger = Logger::instance();
+    for (const Log::Msg &msg : asConst(logger->getMessages()))
+        m_writer->enqueue(msg, true);
+
+    connect(logger, &Logger::newLogMessage, this, &FileLogger::addLogMessage);
 }
 
-void FileLogger::flushLog()
+FileLogger::~FileLogger()
 {
-    if (m_logFile.isOpen())
-        m_logFile.flush();
+    // write out what is still queued, the writer is deleted once its thread finishes
+    QMetaObject::invokeMethod(m_writer, "writePending", Qt::BlockingQueuedConnection);
+    m_writerThread->quit();
+    m_writerThread->wait();
 }
 
-void FileLogger::openLogFile()
+void FileLogger::changePath(const QString &newPath)
 {
-    if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)
-        || !m_logFile.setPermissions(QFile::ReadOwner | QFile::WriteOwner))
-        {
-        m_logFile.close();
-        LogMsg(tr("An error occurred while trying to open the log file. Logging to file is disabled."), Log::CRITICAL);
-    }
+    QMetaObject::invokeMethod(m_writer, "changePath", Qt::QueuedConnection, Q_ARG(QString, newPath));
 }
 
-void FileLogger::closeLogFile()
+void FileLogger::deleteOld(const int age, const FileLogAgeType ageType)
 {
-    m_flusher.stop();
-    m_logFile.close();
+    QMetaObject::invokeMethod(m_writer, "deleteOld", Qt::QueuedConnection
+        , Q_ARG(int, age), Q_ARG(int, ageType));
+}
+
+void FileLogger::setBackup(const bool value)
+{
+    m_writer->setBackup(value);
+}
+
+void FileLogger::setMaxSize(const int value)
+{
+    m_writer->setMaxSize(value);
+}
+
+void FileLogger::setCompressBackups(const bool value)
+{
+    m_writer->setCompressBackups(value);
+}
+
+void FileLogger::setOverloadPolicy(const OverloadPolicy value)
+{
+    m_overloadPolicy = value;
+}
+
+void FileLogger::addLogMessage(const Log::Msg &msg)
+{
+    m_writer->enqueue(msg, (m_overloadPolicy == BlockLogging));
 }
@@ -28,14 +28,59 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <QFile>
+#include <QMutex>
 #include <QObject>
-#include <QTimer>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "base/logger.h"
 
-namespace Log
+class QThread;
+
+// Writes the queued messages to the log file from its own thread
+class FileLoggerWriter final : public QObject
 {
-    struct Msg;
-}
+    Q_OBJECT
+    Q_DISABLE_COPY(FileLoggerWriter)
+
+public:
+    FileLoggerWriter(bool backup, int maxSize);
+    ~FileLoggerWriter() override;
+
+    // Thread-safe. When the queue is full the message is dropped
+    // or, if 'wait' is true, the caller is blocked until there is room for it.
+    bool enqueue(const Log::Msg &msg, bool wait);
+
+    void setBackup(bool value);
+    void setMaxSize(int value);
+    void setCompressBackups(bool value);
+
+public slots:
+    void changePath(const QString &newPath);
+    void deleteOld(int age, int ageType);
+    void writePending();
+
+private:
+    void openLogFile();
+    void closeLogFile();
+    void rotateLogFile();
+
+    QString m_path;
+    QFile m_logFile;
+    std::atomic_bool m_backup;
+    std::atomic_int m_maxSize;
+    std::atomic_bool m_compressBackups {false};
+    std::atomic<qint64> m_droppedMessages {0};
+    qint64 m_reportedDroppedMessages = 0;
+
+    QMutex m_pendingMutex;
+    QWaitCondition m_pendingSpaceAvailable;
+    QVector<Log::Msg> m_pendingMessages;
+    bool m_isWriteScheduled = false;
+};
 
 class FileLogger : public QObject
 {
@@ -50,6 +95,13 @@ public:
         YEARS
     };
 
+    // What to do with new messages when the writer can't keep up
+    enum OverloadPolicy
+    {
+        DropMessages,
+        BlockLogging
+    };
+
     FileLogger(const QString &path, bool backup, int maxSize, bool deleteOld, int age, FileLogAgeType ageType);
     ~FileLogger();
 
@@ -57,18 +109,14 @@ public:
     void deleteOld(int age, FileLogAgeType ageType);
     void setBackup(bool value);
     void setMaxSize(int value);
+    void setCompressBackups(bool value);
+    void setOverloadPolicy(OverloadPolicy value);
 
 private slots:
     void addLogMessage(const Log::Msg &msg);
-    void flushLog();
 
 private:
-    void openLogFile();
-    void closeLogFile();
-
-    QString m_path;
-    bool m_backup;
-    int m_maxSize;
-    QFile m_logFile;
-    QTimer m_flusher;
+    QThread *m_writerThread = nullptr;
+    FileLoggerWriter *m_writer = nullptr;
+    OverloadPolicy m_overloadPolicy = DropMessages;
 };
@@ -7,8 +7,10 @@ HEADERS += \
     $$PWD/bittorrent/cachestatus.h \
     $$PWD/bittorrent/common.h \
     $$PWD/bittorrent/customstorage.h \
+    $$PWD/bittorrent/diskreadcache.h \
     $$PWD/bittorrent/downloadpriority.h \
     $$PWD/bittorrent/filesearcher.h \
+    $$PWD/bittorrent/filesizecounter.h \
     $$PWD/bittorrent/filterparserthread.h \
     $$PWD/bittorrent/infohash.h \
     $$PWD/bittorrent/ltqhash.h \
@@ -20,6 +22,7 @@ HEADERS += \
     $$PWD/bittorrent/peerinfo.h \
     $$PWD/bittorrent/portforwarderimpl.h \
     $$PWD/bittorrent/resumedatasavingmanager.h \
+    $$PWD/bittorrent/resumedataverifier.h \
     $$PWD/bittorrent/session.h \
     $$PWD/bittorrent/sessionstatus.h \
     $$PWD/bittorrent/speedmonitor.h \
@@ -30,11 +33,15 @@ HEADERS += \
     $$PWD/bittorrent/torrentimpl.h \
     $$PWD/bittorrent/torrentinfo.h \
     $$PWD/bittorrent/tracker.h \
+    $$PWD/bittorrent/trackerannouncecoordinator.h \
     $$PWD/bittorrent/trackerentry.h \
+    $$PWD/bittorrent/trackerregistry.h \
+    $$PWD/bittorrent/transferhistory.h \
     $$PWD/exceptions.h \
     $$PWD/filesystemwatcher.h \
     $$PWD/global.h \
     $$PWD/http/connection.h \
+    $$PWD/http/eventstream.h \
     $$PWD/http/httperror.h \
     $$PWD/http/irequesthandler.h \
     $$PWD/http/requestparser.h \
@@ -45,6 +52,7 @@ HEADERS += \
     $$PWD/iconprovider.h \
     $$PWD/indexrange.h \
     $$PWD/logger.h \
+    $$PWD/metrics.h \
     $$PWD/net/dnsupdater.h \
     $$PWD/net/downloadhandlerimpl.h \
     $$PWD/net/downloadmanager.h \
@@ -69,6 +77,7 @@ HEADERS += \
     $$PWD/search/searchdownloadhandler.h \
     $$PWD/search/searchhandler.h \
     $$PWD/search/searchpluginmanager.h \
+    $$PWD/search/searchworkerpool.h \
     $$PWD/settingsstorage.h \
     $$PWD/settingvalue.h \
     $$PWD/torrentfileguard.h \
@@ -93,8 +102,10 @@ SOURCES += \
     $$PWD/bittorrent/abstractfilestorage.cpp \
     $$PWD/bittorrent/bandwidthscheduler.cpp \
     $$PWD/bittorrent/customstorage.cpp \
+    $$PWD/bittorrent/diskreadcache.cpp \
     $$PWD/bittorrent/downloadpriority.cpp \
     $$PWD/bittorrent/filesearcher.cpp \
+    $$PWD/bittorrent/filesizecounter.cpp \
     $$PWD/bittorrent/filterparserthread.cpp \
     $$PWD/bittorrent/infohash.cpp \
     $$PWD/bittorrent/magneturi.cpp \
@@ -104,6 +115,7 @@ SOURCES += \
     $$PWD/bittorrent/peerinfo.cpp \
     $$PWD/bittorrent/portforwarderimpl.cpp \
     $$PWD/bittorrent/resumedatasavingmanager.cpp \
+    $$PWD/bittorrent/resumedataverifier.cpp \
     $$PWD/bittorrent/session.cpp \
     $$PWD/bittorrent/speedmonitor.cpp \
     $$PWD/bittorrent/statistics.cpp \
@@ -112,10 +124,14 @@ SOURCES += \
     $$PWD/bittorrent/torrentimpl.cpp \
     $$PWD/bittorrent/torrentinfo.cpp \
     $$PWD/bittorrent/tracker.cpp \
+    $$PWD/bittorrent/trackerannouncecoordinator.cpp \
     $$PWD/bittorrent/trackerentry.cpp \
+    $$PWD/bittorrent/trackerregistry.cpp \
+    $$PWD/bittorrent/transferhistory.cpp \
     $$PWD/exceptions.cpp \
     $$PWD/filesystemwatcher.cpp \
     $$PWD/http/connection.cpp \
+    $$PWD/http/eventstream.cpp \
     $$PWD/http/httperror.cpp \
     $$PWD/http/requestparser.cpp \
     $$PWD/http/responsebuilder.cpp \
@@ -123,6 +139,7 @@ SOURCES += \
     $$PWD/http/server.cpp \
     $$PWD/iconprovider.cpp \
     $$PWD/logger.cpp \
+    $$PWD/metrics.cpp \
     $$PWD/net/dnsupdater.cpp \
     $$PWD/net/downloadhandlerimpl.cpp \
     $$PWD/net/downloadmanager.cpp \
@@ -147,6 +164,7 @@ SOURCES += \
     $$PWD/search/searchdownloadhandler.cpp \
     $$PWD/search/searchhandler.cpp \
     $$PWD/search/searchpluginmanager.cpp \
+    $$PWD/search/searchworkerpool.cpp \
     $$PWD/settingsstorage.cpp \
     $$PWD/torrentfileguard.cpp \
     $$PWD/torrentfilter.cpp \
@@ -38,6 +38,13 @@ namespace BitTorrent
         quint64 jobQueueLength = 0;
         quint64 averageJobTime = 0;
         quint64 queuedBytes = 0;
-        qreal readRatio = 0;  // TODO: remove when LIBTORRENT_VERSION_NUM >= 20000
+        qreal readRatio = 0;
+
+        // in-process read cache, libtorrent 2.0 only
+        quint64 readCacheHits = 0;
+        quint64 readCacheMisses = 0;
+        quint64 readCacheEvictions = 0;
+        quint64 readCacheBytesServed = 0;
+        quint64 readCacheUsedBytes = 0;
     };
 }
@@ -28,6 +28,8 @@
 
 #include "customstorage.h"
 
+#include <algorithm>
+
 #include <libtorrent/download_priority.hpp>
 
 #include <QDir>
@@ -36,16 +38,41 @@
 #include "common.h"
 
 #if (LIBTORRENT_VERSION_NUM >= 20000)
+#include <boost/asio/post.hpp>
+#include <libtorrent/disk_buffer_holder.hpp>
 #include <libtorrent/session.hpp>
 
+namespace
+{
+    // Number of blocks read in advance for a torrent whose blocks are requested in order
+    const int READ_AHEAD_BLOCKS = 4;
+
+    // Owns the buffers handed out for blocks served from the read cache
+    class CachedBufferAllocator final : public lt::buffer_allocator_interface
+    {
+    public:
+        void free_disk_buffer(char *buffer) override
+        {
+            delete[] buffer;
+        }
+    };
+
+    CachedBufferAllocator cachedBufferAllocator;
+}
+
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
-        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters)
+        lt::io_context &ioContext, const lt::settings_interface &settings, lt::counters &counters
+        , std::shared_ptr<BitTorrent::DiskReadCache> readCache)
 {
-    return std::make_unique<CustomDiskIOThread>(lt::default_disk_io_constructor(ioContext, settings, counters));
+    return std::make_unique<CustomDiskIOThread>(lt::default_disk_io_constructor(ioContext, settings, counters)
+                                                , ioContext, std::move(readCache));
 }
 
-CustomDiskIOThread::CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread)
+CustomDiskIOThread::CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread
+                                       , lt::io_context &ioContext, std::shared_ptr<BitTorrent::DiskReadCache> readCache)
     : m_nativeDiskIO {std::move(nativeDiskIOThread)}
+    , m_ioContext {ioContext}
+    , m_readCache {std::move(readCache)}
 {
 }
 
@@ -58,13 +85,15 @@ lt::storage_holder CustomDiskIOThread::new_torrent(const lt::storage_params &sto
     {
             savePath
             , storageParams.mapped_files ? *storageParams.mapped_files : storageParams.files
-            , storageParams.priorities};
+            , storageParams.priorities
+            , ++m_lastReadCacheID};
 
     return storageHolder;
 }
 
 void CustomDiskIOThread::remove_torrent(lt::storage_index_t storage)
 {
+    invalidateReadCache(storage);
     m_nativeDiskIO->remove_torrent(storage);
 }
 
@@ -72,13 +101,45 @@ void CustomDiskIOThread::async_read(lt::storage_index_t storage, const lt::peer_
                                     , std::function<void (lt::disk_buffer_holder, const lt::storage_error &)> handler
                                     , lt::disk_job_flags_t flags)
 {
-    m_nativeDiskIO->async_read(storage, peerRequest, std::move(handler), flags);
+    if (!isReadCacheEnabled())
+    {
+        m_nativeDiskIO->async_read(storage, peerRequest, std::move(handler), flags);
+        return;
+    }
+
+    const BitTorrent::DiskReadCache::BlockKey key = readCacheKey(storage, peerRequest.piece, peerRequest.start);
+    std::unique_ptr<char[]> buffer = m_readCache->read(key, peerRequest.length);
+    if (buffer)
+    {
+        // libtorrent doesn't expect the handler to be invoked before async_read() returns
+        boost::asio::post(m_ioContext, [handler = std::move(handler), buffer = buffer.release(), length = peerRequest.length]()
+        {
+            handler(lt::disk_buffer_holder {cachedBufferAllocator, buffer, length}, {});
+        });
+    }
+    else
+    {
+        m_nativeDiskIO->async_read(storage, peerRequest
+                                   , [readCache = m_readCache, key, length = peerRequest.length
+                                      , generation = m_readCache->generation(), handler = std::move(handler)]
+                                     (lt::disk_buffer_holder buffer, const lt::storage_error &error)
+        {
+            if (!error && buffer)
+                readCache->insert(key, buffer.data(), length, generation);
+            handler(std::move(buffer), error);
+        }, flags);
+    }
+
+    readAhead(storage, peerRequest, flags);
 }
 
 bool CustomDiskIOThread::async_write(lt::storage_index_t storage, const lt::peer_request &peerRequest
                                      , const char *buf, std::shared_ptr<lt::disk_observer> diskObserver
                                      , std::function<void (const lt::storage_error &)> handler, lt::disk_job_flags_t flags)
 {
+    if (isReadCacheEnabled())
+        m_readCache->invalidate(readCacheKey(storage, peerRequest.piece, peerRequest.start));
+
     return m_nativeDiskIO->async_write(storage, peerRequest, buf, diskObserver, std::move(handler), flags);
 }
 
@@ -104,6 +165,9 @@ void CustomDiskIOThread::async_move_storage(lt::storage_index_t storage, std::st
     if (flags == lt::move_flags_t::dont_replace)
         handleCompleteFiles(storage, newSavePath);
 
+    // files that already exist at the destination may be used instead of the moved ones
+    invalidateReadCache(storage);
+
     m_nativeDiskIO->async_move_storage(storage, path, flags
                                        , [=, handler = std::move(handler)](lt::status_t status, const std::string &path, const lt::storage_error &error)
     {
@@ -124,6 +188,7 @@ void CustomDiskIOThread::async_check_files(lt::storage_index_t storage, const lt
                                            , std::function<void (lt::status_t, const lt::storage_error &)> handler)
 {
     handleCompleteFiles(storage, m_storageData[storage].savePath);
+    invalidateReadCache(storage);
     m_nativeDiskIO->async_check_files(storage, resume_data, links, std::move(handler));
 }
 
@@ -147,6 +212,7 @@ void CustomDiskIOThread::async_rename_file(lt::storage_index_t storage, lt::file
 void CustomDiskIOThread::async_delete_files(lt::storage_index_t storage, lt::remove_flags_t options
                                             , std::function<void (const lt::storage_error &)> handler)
 {
+    invalidateReadCache(storage);
     m_nativeDiskIO->async_delete_files(storage, options, std::move(handler));
 }
 
@@ -164,6 +230,9 @@ void CustomDiskIOThread::async_set_file_priority(lt::storage_index_t storage, lt
 void CustomDiskIOThread::async_clear_piece(lt::storage_index_t storage, lt::piece_index_t index
                                            , std::function<void (lt::piece_index_t)> handler)
 {
+    if (isReadCacheEnabled())
+        m_readCache->invalidatePiece(m_storageData[storage].readCacheID, static_cast<int>(index));
+
     m_nativeDiskIO->async_clear_piece(storage, index, std::move(handler));
 }
 
@@ -192,6 +261,69 @@ void CustomDiskIOThread::settings_updated()
     m_nativeDiskIO->settings_updated();
 }
 
+BitTorrent::DiskReadCache::BlockKey CustomDiskIOThread::readCacheKey(const lt::storage_index_t storage
+        , const lt::piece_index_t piece, const int offset) const
+{
+    const auto iter = m_storageData.constFind(storage);
+    const quint64 readCacheID = (iter != m_storageData.cend()) ? iter->readCacheID : 0;
+    return {readCacheID, static_cast<int>(piece), offset};
+}
+
+bool CustomDiskIOThread::isReadCacheEnabled() const
+{
+    return (m_readCache && m_readCache->isEnabled());
+}
+
+void CustomDiskIOThread::invalidateReadCache(const lt::storage_index_t storage)
+{
+    if (isReadCacheEnabled())
+        m_readCache->invalidateStorage(m_storageData[storage].readCacheID);
+}
+
+void CustomDiskIOThread::readAhead(const lt::storage_index_t storage, const lt::peer_request &peerRequest, const lt::disk_job_flags_t flags)
+{
+    StorageData &storageData = m_storageData[storage];
+    const lt::file_storage &fileStorage = storageData.files;
+    const qint64 pieceLength = fileStorage.piece_length();
+    const qint64 requestOffset = (static_cast<int>(peerRequest.piece) * pieceLength) + peerRequest.start;
+
+    const bool isSequential = (requestOffset == storageData.nextReadOffset);
+    storageData.nextReadOffset = requestOffset + peerRequest.length;
+    if (!isSequential)
+    {
+        storageData.readAheadEnd = 0;
+        return;
+    }
+
+    // The disk I/O doesn't know which pieces we have, so only the blocks remaining
+    // in the requested piece are safe to read
+    const qint64 pieceEnd = (static_cast<int>(peerRequest.piece) * pieceLength) + fileStorage.piece_size(peerRequest.piece);
+    const qint64 readAheadLimit = std::min<qint64>((storageData.nextReadOffset + (READ_AHEAD_BLOCKS * lt::default_block_size)), pieceEnd);
+    qint64 offset = std::max(storageData.nextReadOffset, storageData.readAheadEnd);
+    while (offset < readAheadLimit)
+    {
+        lt::peer_request request;
+        request.piece = peerRequest.piece;
+        request.start = static_cast<int>(offset % pieceLength);
+        request.length = static_cast<int>(std::min<qint64>(lt::default_block_size, (pieceEnd - offset)));
+        offset += request.length;
+
+        const BitTorrent::DiskReadCache::BlockKey key {storageData.readCacheID, static_cast<int>(request.piece), request.start};
+        if (m_readCache->contains(key))
+            continue;
+
+        m_nativeDiskIO->async_read(storage, request
+                                   , [readCache = m_readCache, key, length = request.length, generation = m_readCache->generation()]
+                                     (lt::disk_buffer_holder buffer, const lt::storage_error &error)
+        {
+            if (!error && buffer)
+                readCache->insert(key, buffer.data(), length, generation);
+        }, flags);
+    }
+
+    storageData.readAheadEnd = std::max(offset, storageData.readAheadEnd);
+}
+
 void CustomDiskIOThread::handleCompleteFiles(lt::storage_index_t storage, const QString &savePath)
 {
     const QDir saveDir {savePath};
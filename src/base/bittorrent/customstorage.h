@@ -41,6 +41,7 @@
 
 #include <QHash>
 
+#include "diskreadcache.h"
 #include "ltqhash.h"
 #else
 #include <libtorrent/storage.hpp>
@@ -48,12 +49,14 @@
 
 #if (LIBTORRENT_VERSION_NUM >= 20000)
 std::unique_ptr<lt::disk_interface> customDiskIOConstructor(
-        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters);
+        lt::io_context &ioContext, lt::settings_interface const &settings, lt::counters &counters
+        , std::shared_ptr<BitTorrent::DiskReadCache> readCache = {});
 
 class CustomDiskIOThread final : public lt::disk_interface
 {
 public:
-    explicit CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread);
+    CustomDiskIOThread(std::unique_ptr<libtorrent::disk_interface> nativeDiskIOThread
+                       , lt::io_context &ioContext, std::shared_ptr<BitTorrent::DiskReadCache> readCache);
 
     lt::storage_holder new_torrent(const lt::storage_params &storageParams, const std::shared_ptr<void> &torrent) override;
     void remove_torrent(lt::storage_index_t storageIndex) override;
@@ -88,16 +91,27 @@ public:
 
 private:
     void handleCompleteFiles(libtorrent::storage_index_t storage, const QString &savePath);
+    BitTorrent::DiskReadCache::BlockKey readCacheKey(lt::storage_index_t storage, lt::piece_index_t piece, int offset) const;
+    bool isReadCacheEnabled() const;
+    void invalidateReadCache(lt::storage_index_t storage);
+    void readAhead(lt::storage_index_t storage, const lt::peer_request &peerRequest, lt::disk_job_flags_t flags);
 
     std::unique_ptr<lt::disk_interface> m_nativeDiskIO;
+    lt::io_context &m_ioContext;
+    std::shared_ptr<BitTorrent::DiskReadCache> m_readCache;
 
     struct StorageData
     {
         QString savePath;
         lt::file_storage files;
         lt::aux::vector<lt::download_priority_t, lt::file_index_t> filePriorities;
+        // storage indices get reused, the read cache needs a unique ID
+        quint64 readCacheID = 0;
+        qint64 nextReadOffset = -1;
+        qint64 readAheadEnd = 0;
     };
     QHash<lt::storage_index_t, StorageData> m_storageData;
+    quint64 m_lastReadCacheID = 0;
 };
 
 #else
@@ -0,0 +1,358 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "diskreadcache.h"
+
+#include <cstring>
+#include <limits>
+
+#include <QHash>
+
+using namespace BitTorrent;
+
+namespace
+{
+    // Share of the capacity used by the queue of blocks seen only once
+    const int IN_QUEUE_PERCENT = 25;
+    // Number of evicted keys remembered, as a share of the blocks fitting in the capacity
+    const int GHOST_QUEUE_PERCENT = 50;
+    const int TYPICAL_BLOCK_SIZE = 16 * 1024;
+    // Number of recent invalidations remembered to reject the blocks read before them
+    const std::size_t MAX_INVALIDATION_RECORDS = 4096;
+}
+
+std::size_t DiskReadCache::BlockKeyHash::operator()(const BlockKey &key) const
+{
+    return qHash(key.storageID, qHash(key.piece, static_cast<uint>(key.offset)));
+}
+
+bool DiskReadCache::BlockKeyEqual::operator()(const BlockKey &left, const BlockKey &right) const
+{
+    return (left.storageID == right.storageID)
+        && (left.piece == right.piece)
+        && (left.offset == right.offset);
+}
+
+std::size_t DiskReadCache::PieceIDHash::operator()(const PieceID &pieceID) const
+{
+    return qHash(pieceID.first, static_cast<uint>(pieceID.second));
+}
+
+DiskReadCache::DiskReadCache(const quint64 capacity)
+    : m_capacity {capacity}
+{
+}
+
+bool DiskReadCache::isEnabled() const
+{
+    return (capacity() > 0);
+}
+
+quint64 DiskReadCache::capacity() const
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    return m_capacity;
+}
+
+void DiskReadCache::setCapacity(const quint64 capacity)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    m_capacity = capacity;
+    reclaim();
+}
+
+std::unique_ptr<char[]> DiskReadCache::read(const BlockKey &key, const int length)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+
+    const auto iter = m_blocks.find(key);
+    if ((iter == m_blocks.end()) || (static_cast<int>(iter->second.data.size()) < length))
+    {
+        ++m_misses;
+        return {};
+    }
+
+    Block &block = iter->second;
+    // Blocks in A1in stay where they are, only A1out hits are proven to be popular
+    if (block.queue == Queue::Main)
+        m_mainQueue.splice(m_mainQueue.begin(), m_mainQueue, block.position);
+
+    std::unique_ptr<char[]> buffer {new char[length]};
+    std::memcpy(buffer.get(), block.data.data(), length);
+    ++m_hits;
+    m_bytesServed += length;
+    return buffer;
+}
+
+bool DiskReadCache::contains(const BlockKey &key) const
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    return (m_blocks.find(key) != m_blocks.end());
+}
+
+quint64 DiskReadCache::generation() const
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    return m_generation;
+}
+
+void DiskReadCache::insert(const BlockKey &key, const char *data, const int length, const quint64 generation)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+
+    if ((length <= 0) || (static_cast<quint64>(length) > m_capacity))
+        return;
+
+    // the block was written while it was being read, the data may be stale
+    if (isInvalidatedSince(key, generation))
+        return;
+
+    const auto blockIter = m_blocks.find(key);
+    if (blockIter != m_blocks.end())
+    {
+        if (static_cast<int>(blockIter->second.data.size()) >= length)
+            return;
+        removeBlock(key);
+    }
+
+    Block block;
+    block.data.assign(data, data + length);
+
+    if (m_ghosts.find(key) != m_ghosts.end())
+    {
+        removeGhost(key);
+
+        block.queue = Queue::Main;
+        block.position = m_mainQueue.insert(m_mainQueue.begin(), key);
+    }
+    else
+    {
+        block.queue = Queue::In;
+        block.position = m_inQueue.insert(m_inQueue.begin(), key);
+        m_inQueueBytes += length;
+    }
+
+    m_usedBytes += length;
+    m_blocks.emplace(key, std::move(block));
+    addToIndex(m_blockIndex, key);
+
+    reclaim();
+}
+
+void DiskReadCache::invalidate(const BlockKey &key)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    rememberInvalidation(key.storageID, key.piece);
+    removeBlock(key);
+}
+
+void DiskReadCache::invalidatePiece(const quint64 storageID, const int piece)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    rememberInvalidation(storageID, piece);
+    removeKeys(storageID, piece);
+}
+
+void DiskReadCache::invalidateStorage(const quint64 storageID)
+{
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    rememberInvalidation(storageID, -1);
+    removeKeys(storageID, -1);
+}
+
+DiskReadCacheStats DiskReadCache::stats() const
+{
+    DiskReadCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.bytesServed = m_bytesServed;
+
+    const std::lock_guard<std::mutex> lock {m_mutex};
+    stats.usedBytes = m_usedBytes;
+    stats.capacity = m_capacity;
+    return stats;
+}
+
+void DiskReadCache::addToIndex(KeyIndex &index, const BlockKey &key)
+{
+    index[key.storageID].emplace(key.piece, key.offset);
+}
+
+void DiskReadCache::removeFromIndex(KeyIndex &index, const BlockKey &key)
+{
+    const auto iter = index.find(key.storageID);
+    if (iter == index.end())
+        return;
+
+    iter->second.erase({key.piece, key.offset});
+    if (iter->second.empty())
+        index.erase(iter);
+}
+
+std::vector<DiskReadCache::BlockKey> DiskReadCache::indexedKeys(const KeyIndex &index, const quint64 storageID, const int piece)
+{
+    std::vector<BlockKey> keys;
+
+    const auto iter = index.find(storageID);
+    if (iter == index.end())
+        return keys;
+
+    const std::set<std::pair<int, int>> &offsets = iter->second;
+    auto begin = offsets.cbegin();
+    auto end = offsets.cend();
+    if (piece >= 0)
+    {
+        begin = offsets.lower_bound({piece, std::numeric_limits<int>::min()});
+        end = offsets.lower_bound({(piece + 1), std::numeric_limits<int>::min()});
+    }
+
+    for (auto offsetIter = begin; offsetIter != end; ++offsetIter)
+        keys.push_back({storageID, offsetIter->first, offsetIter->second});
+    return keys;
+}
+
+void DiskReadCache::removeKeys(const quint64 storageID, const int piece)
+{
+    for (const BlockKey &key : indexedKeys(m_ghostIndex, storageID, piece))
+        removeGhost(key);
+    for (const BlockKey &key : indexedKeys(m_blockIndex, storageID, piece))
+        removeBlock(key);
+}
+
+void DiskReadCache::removeBlock(const BlockKey &key)
+{
+    const auto iter = m_blocks.find(key);
+    if (iter == m_blocks.end())
+        return;
+
+    const Block &block = iter->second;
+    m_usedBytes -= block.data.size();
+    if (block.queue == Queue::In)
+    {
+        m_inQueueBytes -= block.data.size();
+        m_inQueue.erase(block.position);
+    }
+    else
+    {
+        m_mainQueue.erase(block.position);
+    }
+
+    m_blocks.erase(iter);
+    removeFromIndex(m_blockIndex, key);
+}
+
+void DiskReadCache::removeGhost(const BlockKey &key)
+{
+    const auto iter = m_ghosts.find(key);
+    if (iter == m_ghosts.end())
+        return;
+
+    m_ghostQueue.erase(iter->second);
+    m_ghosts.erase(iter);
+    removeFromIndex(m_ghostIndex, key);
+}
+
+void DiskReadCache::rememberEvicted(const BlockKey &key)
+{
+    const std::size_t maxGhosts = (m_capacity / TYPICAL_BLOCK_SIZE) * GHOST_QUEUE_PERCENT / 100;
+    if (maxGhosts == 0)
+        return;
+
+    while (m_ghostQueue.size() >= maxGhosts)
+    {
+        const BlockKey oldestKey = m_ghostQueue.back();
+        removeGhost(oldestKey);
+    }
+
+    m_ghosts[key] = m_ghostQueue.insert(m_ghostQueue.begin(), key);
+    addToIndex(m_ghostIndex, key);
+}
+
+void DiskReadCache::rememberInvalidation(const quint64 storageID, const int piece)
+{
+    ++m_generation;
+    const PieceID pieceID {storageID, piece};
+    m_invalidations[pieceID] = m_generation;
+    m_invalidationLog.emplace_back(pieceID, m_generation);
+
+    while (m_invalidationLog.size() > MAX_INVALIDATION_RECORDS)
+    {
+        const std::pair<PieceID, quint64> record = m_invalidationLog.front();
+        m_invalidationLog.pop_front();
+
+        const auto iter = m_invalidations.find(record.first);
+        if ((iter != m_invalidations.end()) && (iter->second == record.second))
+            m_invalidations.erase(iter);
+        m_oldestCheckableGeneration = record.second;
+    }
+}
+
+bool DiskReadCache::isInvalidatedSince(const BlockKey &key, const quint64 generation) const
+{
+    if (generation < m_oldestCheckableGeneration)
+        return true;
+
+    for (const PieceID &pieceID : {PieceID {key.storageID, -1}, PieceID {key.storageID, key.piece}})
+    {
+        const auto iter = m_invalidations.find(pieceID);
+        if ((iter != m_invalidations.end()) && (iter->second > generation))
+            return true;
+    }
+
+    return false;
+}
+
+void DiskReadCache::reclaim()
+{
+    const quint64 maxInQueueBytes = m_capacity * IN_QUEUE_PERCENT / 100;
+
+    while (m_usedBytes > m_capacity)
+    {
+        if ((m_inQueueBytes > maxInQueueBytes) || m_mainQueue.empty())
+        {
+            const BlockKey key = m_inQueue.back();
+            removeBlock(key);
+            rememberEvicted(key);
+        }
+        else
+        {
+            const BlockKey key = m_mainQueue.back();
+            removeBlock(key);
+        }
+
+        ++m_evictions;
+    }
+
+    if (m_capacity == 0)
+    {
+        m_ghosts.clear();
+        m_ghostQueue.clear();
+        m_ghostIndex.clear();
+    }
+}
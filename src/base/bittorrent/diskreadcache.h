@@ -0,0 +1,164 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+
+namespace BitTorrent
+{
+    struct DiskReadCacheStats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        quint64 bytesServed = 0;
+        quint64 usedBytes = 0;
+        quint64 capacity = 0;
+    };
+
+    // Bounded cache of blocks read from disk, shared between the session and the disk I/O.
+    // Uses the 2Q replacement policy: blocks seen once wait in a small FIFO queue and
+    // only the ones requested again (even after being evicted from it) are promoted
+    // to the main LRU queue, so a single scan can't flush the popular blocks.
+    // Reads racing with writes are handled with generations: a block read from disk
+    // is only inserted if its piece wasn't invalidated since the read was issued.
+    class DiskReadCache
+    {
+        Q_DISABLE_COPY(DiskReadCache)
+
+    public:
+        struct BlockKey
+        {
+            quint64 storageID = 0;
+            int piece = 0;
+            int offset = 0;
+        };
+
+        explicit DiskReadCache(quint64 capacity = 0);
+
+        bool isEnabled() const;
+        quint64 capacity() const;
+        void setCapacity(quint64 capacity);
+
+        // Returns a copy of the block if it is cached with at least "length" bytes
+        std::unique_ptr<char[]> read(const BlockKey &key, int length);
+        bool contains(const BlockKey &key) const;
+        // To be taken before reading a block from disk and passed to insert()
+        quint64 generation() const;
+        void insert(const BlockKey &key, const char *data, int length, quint64 generation);
+
+        void invalidate(const BlockKey &key);
+        void invalidatePiece(quint64 storageID, int piece);
+        void invalidateStorage(quint64 storageID);
+
+        DiskReadCacheStats stats() const;
+
+    private:
+        struct BlockKeyHash
+        {
+            std::size_t operator()(const BlockKey &key) const;
+        };
+
+        struct BlockKeyEqual
+        {
+            bool operator()(const BlockKey &left, const BlockKey &right) const;
+        };
+
+        enum class Queue
+        {
+            In,
+            Main
+        };
+
+        using KeyList = std::list<BlockKey>;
+        // <storage ID, <piece, offset>>, to find the keys of a piece or a storage without a full scan
+        using KeyIndex = std::unordered_map<quint64, std::set<std::pair<int, int>>>;
+        // <storage ID, piece>, piece is -1 for the whole storage
+        using PieceID = std::pair<quint64, int>;
+
+        struct PieceIDHash
+        {
+            std::size_t operator()(const PieceID &pieceID) const;
+        };
+
+        struct Block
+        {
+            std::vector<char> data;
+            Queue queue;
+            KeyList::iterator position;
+        };
+
+        static void addToIndex(KeyIndex &index, const BlockKey &key);
+        static void removeFromIndex(KeyIndex &index, const BlockKey &key);
+        static std::vector<BlockKey> indexedKeys(const KeyIndex &index, quint64 storageID, int piece);
+
+        void removeKeys(quint64 storageID, int piece);
+        void removeBlock(const BlockKey &key);
+        void removeGhost(const BlockKey &key);
+        void rememberEvicted(const BlockKey &key);
+        void rememberInvalidation(quint64 storageID, int piece);
+        bool isInvalidatedSince(const BlockKey &key, quint64 generation) const;
+        void reclaim();
+
+        mutable std::mutex m_mutex;
+        quint64 m_capacity = 0;
+        quint64 m_usedBytes = 0;
+        quint64 m_inQueueBytes = 0;
+
+        std::unordered_map<BlockKey, Block, BlockKeyHash, BlockKeyEqual> m_blocks;
+        KeyList m_inQueue; // A1in, FIFO, newest first
+        KeyList m_mainQueue; // Am, LRU, most recently used first
+        KeyList m_ghostQueue; // A1out, keys of blocks evicted from A1in, newest first
+        std::unordered_map<BlockKey, KeyList::iterator, BlockKeyHash, BlockKeyEqual> m_ghosts;
+        KeyIndex m_blockIndex;
+        KeyIndex m_ghostIndex;
+
+        quint64 m_generation = 0;
+        // generation of the latest invalidation of the pieces, only the recent ones are kept
+        std::unordered_map<PieceID, quint64, PieceIDHash> m_invalidations;
+        std::deque<std::pair<PieceID, quint64>> m_invalidationLog;
+        // reads issued before it can't be checked anymore
+        quint64 m_oldestCheckableGeneration = 0;
+
+        std::atomic<quint64> m_hits {0};
+        std::atomic<quint64> m_misses {0};
+        std::atomic<quint64> m_evictions {0};
+        std::atomic<quint64> m_bytesServed {0};
+    };
+}
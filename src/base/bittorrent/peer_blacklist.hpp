@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <regex>
 
 #include <libtorrent/torrent_info.hpp>
@@ -73,13 +76,45 @@ private:
 };
 
 
+// number of peers dropped by each filter, counted from the network thread
+class peer_filter_counters
+{
+public:
+  static peer_filter_counters& instance()
+  {
+    static peer_filter_counters counters;
+    return counters;
+  }
+
+  void add(const std::string& tag)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_counts[tag];
+  }
+
+  std::map<std::string, std::uint64_t> counts() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counts;
+  }
+
+private:
+  peer_filter_counters() = default;
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, std::uint64_t> m_counts;
+};
+
+
 template<typename F>
 auto wrap_filter(F filter, const std::string& tag)
 {
   return [=](const lt::peer_info& info, bool) {
     bool matched = filter(info);
-    if (matched)
+    if (matched) {
+      peer_filter_counters::instance().add(tag);
       peer_logger_singleton::instance().log_peer(info, tag);
+    }
     return matched;
   };
 }
@@ -32,8 +32,12 @@
 #include <libtorrent/entry.hpp>
 
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 #include <QSaveFile>
+#include <QStringList>
 
+#include "base/bittorrent/infohash.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
 #include "base/utils/io.h"
@@ -43,8 +47,17 @@ ResumeDataSavingManager::ResumeDataSavingManager(const QString &resumeFolderPath
 {
 }
 
+Metrics::Histogram ResumeDataSavingManager::saveLatency() const
+{
+    const QMutexLocker locker {&m_saveLatencyMutex};
+    return m_saveLatency;
+}
+
 void ResumeDataSavingManager::save(const QString &filename, const QByteArray &data) const
 {
+    QElapsedTimer timer;
+    timer.start();
+
     const QString filepath = m_resumeDataDir.absoluteFilePath(filename);
 
     QSaveFile file {filepath};
@@ -53,10 +66,15 @@ void ResumeDataSavingManager::save(const QString &filename, const QByteArray &da
         LogMsg(tr("Couldn't save data to '%1'. Error: %2")
             .arg(filepath, file.errorString()), Log::CRITICAL);
     }
+
+    addSaveLatency(timer.nsecsElapsed() / 1e9);
 }
 
 void ResumeDataSavingManager::save(const QString &filename, const std::shared_ptr<lt::entry> &data) const
 {
+    QElapsedTimer timer;
+    timer.start();
+
     const QString filepath = m_resumeDataDir.absoluteFilePath(filename);
 
     QSaveFile file {filepath};
@@ -73,6 +91,21 @@ void ResumeDataSavingManager::save(const QString &filename, const std::shared_pt
         LogMsg(tr("Couldn't save data to '%1'. Error: %2")
             .arg(filepath, file.errorString()), Log::CRITICAL);
     }
+
+    addSaveLatency(timer.nsecsElapsed() / 1e9);
+}
+
+void ResumeDataSavingManager::saveWithFileSnapshot(const BitTorrent::InfoHash &hash, const std::shared_ptr<lt::entry> &data
+                                                   , const QStringList &filePaths)
+{
+    QVector<BitTorrent::FileSnapshot> snapshot;
+    snapshot.reserve(filePaths.size());
+    for (const QString &filePath : filePaths)
+        snapshot.append(BitTorrent::FileSnapshot::take(filePath));
+    (*data)["qBt-fileSnapshot"] = BitTorrent::fileSnapshotToEntry(snapshot);
+
+    save(QString::fromLatin1("%1.fastresume").arg(hash), data);
+    emit fileSnapshotTaken(hash, snapshot);
 }
 
 void ResumeDataSavingManager::remove(const QString &filename) const
@@ -81,3 +114,9 @@ void ResumeDataSavingManager::remove(const QString &filename) const
 
     Utils::Fs::forceRemove(filepath);
 }
+
+void ResumeDataSavingManager::addSaveLatency(const double seconds) const
+{
+    const QMutexLocker locker {&m_saveLatencyMutex};
+    m_saveLatency.observe(seconds);
+}
@@ -33,9 +33,20 @@
 #include <libtorrent/fwd.hpp>
 
 #include <QDir>
+#include <QMutex>
 #include <QObject>
+#include <QVector>
+
+#include "base/bittorrent/resumedataverifier.h"
+#include "base/metrics.h"
 
 class QByteArray;
+class QStringList;
+
+namespace BitTorrent
+{
+    class InfoHash;
+}
 
 class ResumeDataSavingManager : public QObject
 {
@@ -45,11 +56,24 @@ class ResumeDataSavingManager : public QObject
 public:
     explicit ResumeDataSavingManager(const QString &resumeFolderPath);
 
+    // Thread-safe
+    Metrics::Histogram saveLatency() const;
+
 public slots:
     void save(const QString &filename, const QByteArray &data) const;
     void save(const QString &filename, const std::shared_ptr<lt::entry> &data) const;
+    // Takes the snapshot of the files and stores it in the resume data before saving it
+    void saveWithFileSnapshot(const BitTorrent::InfoHash &hash, const std::shared_ptr<lt::entry> &data
+                              , const QStringList &filePaths);
     void remove(const QString &filename) const;
 
+signals:
+    void fileSnapshotTaken(const BitTorrent::InfoHash &hash, const QVector<BitTorrent::FileSnapshot> &snapshot);
+
 private:
+    void addSaveLatency(double seconds) const;
+
     const QDir m_resumeDataDir;
+    mutable QMutex m_saveLatencyMutex;
+    mutable Metrics::Histogram m_saveLatency;
 };
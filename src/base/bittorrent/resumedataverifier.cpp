@@ -0,0 +1,253 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "resumedataverifier.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+#include <libtorrent/entry.hpp>
+#include <libtorrent/torrent_info.hpp>
+#include <libtorrent/version.hpp>
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "ltunderlyingtype.h"
+
+using namespace BitTorrent;
+
+FileSnapshot FileSnapshot::take(const QString &path)
+{
+#ifdef Q_OS_UNIX
+    // A single stat() call provides everything, don't let QFileInfo query the file again
+    struct stat fileStat {};
+    if ((::stat(QFile::encodeName(path).constData(), &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+        return {};
+
+#ifdef Q_OS_MACOS
+    const struct timespec &modificationTime = fileStat.st_mtimespec;
+#else
+    const struct timespec &modificationTime = fileStat.st_mtim;
+#endif
+
+    FileSnapshot snapshot;
+    snapshot.size = fileStat.st_size;
+    snapshot.lastModified = (static_cast<qint64>(modificationTime.tv_sec) * 1000) + (modificationTime.tv_nsec / 1000000);
+    snapshot.inode = fileStat.st_ino;
+    return snapshot;
+#else
+    const QFileInfo fileInfo {path};
+    if (!fileInfo.isFile())
+        return {};
+
+    FileSnapshot snapshot;
+    snapshot.size = fileInfo.size();
+    snapshot.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    return snapshot;
+#endif
+}
+
+bool BitTorrent::operator==(const FileSnapshot &left, const FileSnapshot &right)
+{
+    return (left.size == right.size)
+        && (left.lastModified == right.lastModified)
+        && (left.inode == right.inode);
+}
+
+bool BitTorrent::operator!=(const FileSnapshot &left, const FileSnapshot &right)
+{
+    return !(left == right);
+}
+
+lt::entry BitTorrent::fileSnapshotToEntry(const QVector<FileSnapshot> &snapshot)
+{
+    lt::entry::list_type snapshotList;
+    snapshotList.reserve(snapshot.size());
+    for (const FileSnapshot &fileSnapshot : snapshot)
+    {
+        snapshotList.emplace_back(lt::entry::list_type {
+            lt::entry(static_cast<std::int64_t>(fileSnapshot.size))
+            , lt::entry(static_cast<std::int64_t>(fileSnapshot.lastModified))
+            , lt::entry(static_cast<std::int64_t>(fileSnapshot.inode))});
+    }
+    return snapshotList;
+}
+
+ResumeDataVerifier::ResumeDataVerifier(const lt::torrent_info &torrentInfo, const QString &savePath
+        , const QVector<FileSnapshot> &snapshot, const lt::typed_bitfield<lt::piece_index_t> &havePieces
+        , const int spotCheckCount, QObject *parent)
+    : QThread {parent}
+    , m_fileStorage {torrentInfo.files()}
+    , m_savePath {savePath.toStdString()}
+    , m_snapshot {snapshot}
+    , m_havePieces {havePieces}
+    , m_spotCheckCount {spotCheckCount}
+{
+    m_pieceHashes.reserve(m_fileStorage.num_pieces());
+    for (const lt::piece_index_t piece : m_fileStorage.piece_range())
+        m_pieceHashes.push_back(torrentInfo.hash_for_piece(piece));
+}
+
+ResumeDataVerifier::~ResumeDataVerifier()
+{
+    abort();
+    wait();
+}
+
+bool ResumeDataVerifier::isSupported(const lt::torrent_info &torrentInfo)
+{
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+    // only SHA-1 piece hashes are checked
+    return torrentInfo.is_valid() && torrentInfo.v1();
+#else
+    return torrentInfo.is_valid();
+#endif
+}
+
+void ResumeDataVerifier::abort()
+{
+    m_abortRequested = true;
+}
+
+bool ResumeDataVerifier::isSucceeded() const
+{
+    return m_succeeded;
+}
+
+lt::typed_bitfield<lt::piece_index_t> ResumeDataVerifier::verifiedPieces() const
+{
+    return m_verifiedPieces;
+}
+
+int ResumeDataVerifier::hashedPiecesCount() const
+{
+    return m_hashedPiecesCount;
+}
+
+void ResumeDataVerifier::run()
+{
+    m_verifiedPieces.resize(m_fileStorage.num_pieces(), false);
+
+    std::vector<bool> changedFiles(m_fileStorage.num_files(), false);
+    for (const lt::file_index_t index : m_fileStorage.file_range())
+    {
+        if (m_fileStorage.pad_file_at(index))
+            continue;
+
+        const int i = static_cast<LTUnderlyingType<lt::file_index_t>>(index);
+        const QString filePath = QString::fromStdString(m_fileStorage.file_path(index, m_savePath));
+        changedFiles[i] = (i >= m_snapshot.size()) || (FileSnapshot::take(filePath) != m_snapshot[i]);
+    }
+
+    std::vector<lt::piece_index_t> trustedPieces;
+    for (const lt::piece_index_t piece : m_fileStorage.piece_range())
+    {
+        if (m_abortRequested)
+            return;
+
+        const std::vector<lt::file_slice> slices = m_fileStorage.map_block(piece, 0, m_fileStorage.piece_size(piece));
+        const bool isChanged = std::any_of(slices.cbegin(), slices.cend(), [&changedFiles](const lt::file_slice &slice)
+        {
+            return changedFiles[static_cast<LTUnderlyingType<lt::file_index_t>>(slice.file_index)];
+        });
+
+        if (isChanged)
+        {
+            if (checkPiece(piece))
+                m_verifiedPieces.set_bit(piece);
+        }
+        else if ((static_cast<LTUnderlyingType<lt::piece_index_t>>(piece) < m_havePieces.size()) && m_havePieces[piece])
+        {
+            m_verifiedPieces.set_bit(piece);
+            trustedPieces.push_back(piece);
+        }
+    }
+
+    if ((m_spotCheckCount > 0) && !trustedPieces.empty())
+    {
+        std::vector<lt::piece_index_t> sample;
+        std::sample(trustedPieces.cbegin(), trustedPieces.cend(), std::back_inserter(sample)
+            , m_spotCheckCount, std::mt19937 {std::random_device {}()});
+
+        for (const lt::piece_index_t piece : sample)
+        {
+            // The snapshot can't be trusted if any of its pieces is corrupted
+            if (m_abortRequested || !checkPiece(piece))
+                return;
+        }
+    }
+
+    m_file.close();
+    m_succeeded = true;
+}
+
+bool ResumeDataVerifier::checkPiece(const lt::piece_index_t piece)
+{
+    ++m_hashedPiecesCount;
+
+    QCryptographicHash hash {QCryptographicHash::Sha1};
+    QByteArray buffer;
+    for (const lt::file_slice &slice : m_fileStorage.map_block(piece, 0, m_fileStorage.piece_size(piece)))
+    {
+        if (m_fileStorage.pad_file_at(slice.file_index))
+            buffer.fill('\0', static_cast<int>(slice.size));
+        else if (!readSlice(slice, buffer))
+            return false;
+
+        hash.addData(buffer);
+    }
+
+    const lt::sha1_hash &expectedHash = m_pieceHashes[static_cast<LTUnderlyingType<lt::piece_index_t>>(piece)];
+    return (hash.result() == QByteArray::fromRawData(expectedHash.data(), expectedHash.size()));
+}
+
+bool ResumeDataVerifier::readSlice(const lt::file_slice &slice, QByteArray &buffer)
+{
+    if (slice.file_index != m_fileIndex)
+    {
+        m_file.close();
+        m_file.setFileName(QString::fromStdString(m_fileStorage.file_path(slice.file_index, m_savePath)));
+        m_fileIndex = slice.file_index;
+        if (!m_file.open(QIODevice::ReadOnly))
+            return false;
+    }
+
+    if (!m_file.isOpen() || !m_file.seek(slice.offset))
+        return false;
+
+    buffer = m_file.read(slice.size);
+    return (buffer.size() == slice.size);
+}
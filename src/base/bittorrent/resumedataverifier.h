@@ -0,0 +1,113 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <libtorrent/bitfield.hpp>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/fwd.hpp>
+#include <libtorrent/sha1_hash.hpp>
+#include <libtorrent/units.hpp>
+
+#include <QFile>
+#include <QMetaType>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+namespace BitTorrent
+{
+    // Identifies the state of a file on disk at some point in time
+    struct FileSnapshot
+    {
+        qint64 size = -1; // -1 if the file doesn't exist
+        qint64 lastModified = 0; // msecs since epoch
+        quint64 inode = 0; // 0 if not available on this platform
+
+        static FileSnapshot take(const QString &path);
+    };
+
+    bool operator==(const FileSnapshot &left, const FileSnapshot &right);
+    bool operator!=(const FileSnapshot &left, const FileSnapshot &right);
+
+    // The "qBt-fileSnapshot" resume data field
+    lt::entry fileSnapshotToEntry(const QVector<FileSnapshot> &snapshot);
+
+    // Rebuilds the piece state of a torrent without hashing all of its content.
+    // Pieces that lie in files unchanged since the snapshot keep their previous state,
+    // the other ones are hashed. A random sample of the trusted pieces can be hashed too,
+    // the verification fails if any of them doesn't match.
+    class ResumeDataVerifier final : public QThread
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(ResumeDataVerifier)
+
+    public:
+        ResumeDataVerifier(const lt::torrent_info &torrentInfo, const QString &savePath
+            , const QVector<FileSnapshot> &snapshot, const lt::typed_bitfield<lt::piece_index_t> &havePieces
+            , int spotCheckCount, QObject *parent = nullptr);
+        ~ResumeDataVerifier() override;
+
+        static bool isSupported(const lt::torrent_info &torrentInfo);
+
+        void abort();
+
+        // valid once the thread has finished
+        bool isSucceeded() const;
+        lt::typed_bitfield<lt::piece_index_t> verifiedPieces() const;
+        int hashedPiecesCount() const;
+
+    protected:
+        void run() override;
+
+    private:
+        bool checkPiece(lt::piece_index_t piece);
+        bool readSlice(const lt::file_slice &slice, QByteArray &buffer);
+
+        const lt::file_storage m_fileStorage;
+        std::vector<lt::sha1_hash> m_pieceHashes;
+        const std::string m_savePath;
+        const QVector<FileSnapshot> m_snapshot;
+        const lt::typed_bitfield<lt::piece_index_t> m_havePieces;
+        const int m_spotCheckCount;
+
+        std::atomic_bool m_abortRequested {false};
+        bool m_succeeded = false;
+        lt::typed_bitfield<lt::piece_index_t> m_verifiedPieces;
+        int m_hashedPiecesCount = 0;
+
+        // pieces are read in order, so keep the current file open
+        QFile m_file;
+        lt::file_index_t m_fileIndex {-1};
+    };
+}
+
+Q_DECLARE_METATYPE(QVector<BitTorrent::FileSnapshot>)
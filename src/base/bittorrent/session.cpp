@@ -59,11 +59,13 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QHostAddress>
 #include <QNetworkAddressEntry>
 #include <QNetworkConfigurationManager>
 #include <QNetworkInterface>
 #include <QRegularExpression>
+#include <QStorageInfo>
 #include <QString>
 #include <QThread>
 #include <QTimer>
@@ -89,7 +91,9 @@
 #include "bandwidthscheduler.h"
 #include "common.h"
 #include "customstorage.h"
+#include "diskreadcache.h"
 #include "filesearcher.h"
+#include "filesizecounter.h"
 #include "filterparserthread.h"
 #include "ltunderlyingtype.h"
 #include "magneturi.h"
@@ -100,7 +104,10 @@
 #include "statistics.h"
 #include "torrentimpl.h"
 #include "tracker.h"
+#include "trackerannouncecoordinator.h"
 #include "trackerentry.h"
+#include "trackerregistry.h"
+#include "transferhistory.h"
 
 static const char PEER_ID[] = "qB";
 static const char RESUME_FOLDER[] = "BT_backup";
@@ -110,6 +117,15 @@ using namespace BitTorrent;
 
 namespace
 {
+    // Keep it low so that moves between slow disks don't thrash them
+    const int MAX_MOVE_STORAGE_JOBS_PER_DEVICE = 2;
+    const int MOVE_STORAGE_PROGRESS_INTERVAL = 2000; // 2 s
+    // Mount points may change, don't keep stale entries forever
+    const qint64 STORAGE_DEVICE_CACHE_TTL = 10 * 60 * 1000; // 10 min
+    // Announces moved after a tracker enters or leaves backoff, in torrents per tick
+    const int MAX_TRACKER_RESCHEDULES_PER_TICK = 100;
+    const int TRACKER_RESCHEDULE_INTERVAL = 1000; // 1 s
+
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
     {
@@ -350,6 +366,7 @@ Session::Session(QObject *parent)
     , m_checkingMemUsage(BITTORRENT_SESSION_KEY("CheckingMemUsageSize"), 32)
     , m_diskCacheSize(BITTORRENT_SESSION_KEY("DiskCacheSize"), -1)
     , m_diskCacheTTL(BITTORRENT_SESSION_KEY("DiskCacheTTL"), 60)
+    , m_readCacheSize(BITTORRENT_SESSION_KEY("ReadCacheSize"), 0, lowerLimited(0))
     , m_useOSCache(BITTORRENT_SESSION_KEY("UseOSCache"), true)
 #ifdef Q_OS_WIN
     , m_coalesceReadWriteEnabled(BITTORRENT_SESSION_KEY("CoalesceReadWrite"), true)
@@ -410,6 +427,9 @@ Session::Session(QObject *parent)
     , m_isAltGlobalSpeedLimitEnabled(BITTORRENT_SESSION_KEY("UseAlternativeGlobalSpeedLimit"), false)
     , m_isBandwidthSchedulerEnabled(BITTORRENT_SESSION_KEY("BandwidthSchedulerEnabled"), false)
     , m_saveResumeDataInterval(BITTORRENT_SESSION_KEY("SaveResumeDataInterval"), 60)
+    , m_dormantTorrentTimeout(BITTORRENT_SESSION_KEY("DormantTorrentTimeout"), 0, lowerLimited(0))
+    , m_isQuickRecheckEnabled(BITTORRENT_SESSION_KEY("QuickRecheckEnabled"), false)
+    , m_quickRecheckSpotCheckCount(BITTORRENT_SESSION_KEY("QuickRecheckSpotCheckPieces"), 0, lowerLimited(0))
     , m_port(BITTORRENT_SESSION_KEY("Port"), -1)
     , m_useRandomPort(BITTORRENT_SESSION_KEY("UseRandomPort"), false)
     , m_networkInterface(BITTORRENT_SESSION_KEY("Interface"))
@@ -455,7 +475,11 @@ Session::Session(QObject *parent)
     , m_resumeFolderLock {new QFile {this}}
     , m_seedingLimitTimer {new QTimer {this}}
     , m_resumeDataTimer {new QTimer {this}}
+    , m_dormancyTimer {new QTimer {this}}
     , m_statistics {new Statistics {this}}
+    , m_transferHistory {new TransferHistory {this}}
+    , m_announceCoordinator {new TrackerAnnounceCoordinator {this}}
+    , m_trackerRescheduleTimer {new QTimer {this}}
     , m_ioThread {new QThread {this}}
     , m_recentErroredTorrentsTimer {new QTimer {this}}
     , m_networkManager {new QNetworkConfigurationManager {this}}
@@ -473,6 +497,11 @@ Session::Session(QObject *parent)
     m_seedingLimitTimer->setInterval(10000);
     connect(m_seedingLimitTimer, &QTimer::timeout, this, &Session::processShareLimits);
 
+    connect(m_announceCoordinator, &TrackerAnnounceCoordinator::suppressionChanged
+        , this, &Session::handleTrackerSuppressionChanged);
+    m_trackerRescheduleTimer->setInterval(TRACKER_RESCHEDULE_INTERVAL);
+    connect(m_trackerRescheduleTimer, &QTimer::timeout, this, &Session::processTrackerReschedules);
+
     initializeNativeSession();
     configureComponents();
 
@@ -509,16 +538,27 @@ Session::Session(QObject *parent)
     m_resumeDataSavingManager = new ResumeDataSavingManager {m_resumeFolderPath};
     m_resumeDataSavingManager->moveToThread(m_ioThread);
     connect(m_ioThread, &QThread::finished, m_resumeDataSavingManager, &QObject::deleteLater);
+    qRegisterMetaType<QVector<FileSnapshot>>();
+    connect(m_resumeDataSavingManager, &ResumeDataSavingManager::fileSnapshotTaken, this, &Session::fileSnapshotTaken);
 
     m_fileSearcher = new FileSearcher;
     m_fileSearcher->moveToThread(m_ioThread);
     connect(m_ioThread, &QThread::finished, m_fileSearcher, &QObject::deleteLater);
     connect(m_fileSearcher, &FileSearcher::searchFinished, this, &Session::fileSearchFinished);
 
+    m_fileSizeCounter = new FileSizeCounter;
+    m_fileSizeCounter->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_fileSizeCounter, &QObject::deleteLater);
+    connect(m_fileSizeCounter, &FileSizeCounter::countFinished, this, &Session::movedSizeCountFinished);
+
+    m_moveStorageProgressTimer = new QTimer {this};
+    m_moveStorageProgressTimer->setInterval(MOVE_STORAGE_PROGRESS_INTERVAL);
+    connect(m_moveStorageProgressTimer, &QTimer::timeout, this, &Session::countMovedSizes);
+
     m_ioThread->start();
 
     // Regular saving of fastresume data
-    connect(m_resumeDataTimer, &QTimer::timeout, this, [this]() { generateResumeData(); });
+    connect(m_resumeDataTimer, &QTimer::timeout, this, [this]() { generateResumeData(false); });
     const int saveInterval = saveResumeDataInterval();
     if (saveInterval > 0)
     {
@@ -526,6 +566,12 @@ Session::Session(QObject *parent)
         m_resumeDataTimer->start();
     }
 
+    // Detach long-stopped torrents from libtorrent
+    m_dormancyTimer->setInterval(60 * 1000);
+    connect(m_dormancyTimer, &QTimer::timeout, this, &Session::processDormantTorrents);
+    if (dormantTorrentTimeout() > 0)
+        m_dormancyTimer->start();
+
     // initialize PortForwarder instance
     new PortForwarderImpl {m_nativeSession};
 
@@ -855,6 +901,14 @@ bool Session::hasTag(const QString &tag) const
     return m_tags.contains(tag);
 }
 
+// Returns the session's own copy of the tag so that torrents
+// having the same tag share a single string buffer
+QString Session::internTag(const QString &tag) const
+{
+    const auto iter = m_tags.constFind(tag);
+    return (iter != m_tags.cend()) ? *iter : tag;
+}
+
 bool Session::addTag(const QString &tag)
 {
     if (!isValidTag(tag))
@@ -1159,7 +1213,12 @@ void Session::initializeNativeSession()
     loadLTSettings(pack);
     lt::session_params sessionParams {pack, {}};
 #if (LIBTORRENT_VERSION_NUM >= 20000)
-    sessionParams.disk_io_constructor = customDiskIOConstructor;
+    m_diskReadCache = std::make_shared<DiskReadCache>(readCacheSize() * 1024ULL * 1024);
+    sessionParams.disk_io_constructor = [readCache = m_diskReadCache](lt::io_context &ioContext
+            , const lt::settings_interface &settings, lt::counters &counters)
+    {
+        return customDiskIOConstructor(ioContext, settings, counters, readCache);
+    };
 #endif
     m_nativeSession = new lt::session {sessionParams};
 
@@ -1272,6 +1331,14 @@ void Session::initMetrics()
     m_metricIndices.disk.hashJobs = findMetricIndex("disk.num_blocks_hashed");
     m_metricIndices.disk.queuedDiskJobs = findMetricIndex("disk.queued_disk_jobs");
     m_metricIndices.disk.diskJobTime = findMetricIndex("disk.disk_job_time");
+
+    const std::vector<lt::stats_metric> sessionMetrics = lt::session_stats_metrics();
+    m_metrics.reserve(static_cast<int>(sessionMetrics.size()));
+    for (const lt::stats_metric &metric : sessionMetrics)
+    {
+        m_metrics.append({(QByteArray("libtorrent_") + QByteArray(metric.name).replace('.', '_'))
+            , metric.value_index, (metric.type == lt::metric_type_t::gauge)});
+    }
 }
 
 void Session::loadLTSettings(lt::settings_pack &settingsPack)
@@ -1807,6 +1874,13 @@ void Session::handleDownloadFinished(const Net::DownloadResult &result)
     }
 }
 
+void Session::fileSnapshotTaken(const InfoHash &id, const QVector<FileSnapshot> &snapshot)
+{
+    TorrentImpl *torrent = m_torrents.value(id);
+    if (torrent)
+        torrent->handleFileSnapshotTaken(snapshot);
+}
+
 void Session::fileSearchFinished(const InfoHash &id, const QString &savePath, const QStringList &fileNames)
 {
     TorrentImpl *torrent = m_torrents.value(id);
@@ -1885,24 +1959,31 @@ void Session::banIP(const QString &ip)
 // and from the disk, if the corresponding deleteOption is chosen
 bool Session::deleteTorrent(const InfoHash &hash, const DeleteOption deleteOption)
 {
-    TorrentImpl *const torrent = m_torrents.take(hash);
+    TorrentImpl *const torrent = m_torrents.value(hash);
     if (!torrent) return false;
 
+    // libtorrent has to know about the torrent in order to remove its files
+    if ((deleteOption == DeleteTorrentAndFiles) && !torrent->attach())
+        return false;
+
+    m_torrents.remove(hash);
+
     qDebug("Deleting torrent with hash: %s", qUtf8Printable(torrent->hash()));
     emit torrentAboutToBeRemoved(torrent);
+    removeFromTrackerIndex(torrent->hash(), torrent->trackers());
 
     // Remove it from session
-    if (deleteOption == DeleteTorrent)
+    if (torrent->isDormant())
+    {
+        takeDormantQueuePosition(hash);
+        LogMsg(tr("'%1' was removed from the transfer list.", "'xxx.avi' was removed...").arg(torrent->name()));
+    }
+    else if (deleteOption == DeleteTorrent)
     {
         m_removingTorrents[torrent->hash()] = {torrent->name(), "", deleteOption};
 
         const lt::torrent_handle nativeHandle {torrent->nativeHandle()};
-        const auto iter = std::find_if(m_moveStorageQueue.begin(), m_moveStorageQueue.end()
-                                 , [&nativeHandle](const MoveStorageJob &job)
-        {
-            return job.torrentHandle == nativeHandle;
-        });
-        if (iter != m_moveStorageQueue.end())
+        if (m_activeMoveStorageJobs.contains(hash) || m_pendingMoveStorageJobs.contains(hash))
         {
             // We shouldn't actually remove torrent until existing "move storage jobs" are done
             torrentQueuePositionBottom(nativeHandle);
@@ -1925,18 +2006,9 @@ bool Session::deleteTorrent(const InfoHash &hash, const DeleteOption deleteOptio
 
         m_removingTorrents[torrent->hash()] = {torrent->name(), rootPath, deleteOption};
 
-        if (m_moveStorageQueue.size() > 1)
-        {
-            // Delete "move storage job" for the deleted torrent
-            // (note: we shouldn't delete active job)
-            const auto iter = std::find_if(m_moveStorageQueue.begin() + 1, m_moveStorageQueue.end()
-                                     , [torrent](const MoveStorageJob &job)
-            {
-                return job.torrentHandle == torrent->nativeHandle();
-            });
-            if (iter != m_moveStorageQueue.end())
-                m_moveStorageQueue.erase(iter);
-        }
+        // Delete "move storage job" for the deleted torrent
+        // (note: we shouldn't delete active job)
+        cancelMoveStorageJob(hash);
 
         m_nativeSession->remove_torrent(torrent->nativeHandle(), lt::session::delete_files);
     }
@@ -1964,10 +2036,11 @@ bool Session::cancelDownloadMetadata(const InfoHash &hash)
     const auto downloadedMetadataIter = m_downloadedMetadata.find(hash);
     if (downloadedMetadataIter == m_downloadedMetadata.end()) return false;
 
+    const lt::torrent_handle nativeHandle = downloadedMetadataIter.value();
     m_downloadedMetadata.erase(downloadedMetadataIter);
     --m_extraLimit;
     adjustLimits();
-    m_nativeSession->remove_torrent(m_nativeSession->find_torrent(hash), lt::session::delete_files);
+    m_nativeSession->remove_torrent(nativeHandle, lt::session::delete_files);
     return true;
 }
 
@@ -1982,7 +2055,8 @@ void Session::increaseTorrentsQueuePos(const QVector<InfoHash> &hashes)
     for (const InfoHash &infoHash : hashes)
     {
         TorrentImpl *const torrent = m_torrents.value(infoHash);
-        if (torrent && !torrent->isSeed())
+        // dormant torrents are moved in libtorrent's queue, attach them first
+        if (torrent && !torrent->isSeed() && torrent->attach())
             torrentQueue.emplace(torrent->queuePosition(), torrent);
     }
 
@@ -2006,7 +2080,8 @@ void Session::decreaseTorrentsQueuePos(const QVector<InfoHash> &hashes)
     for (const InfoHash &infoHash : hashes)
     {
         TorrentImpl *const torrent = m_torrents.value(infoHash);
-        if (torrent && !torrent->isSeed())
+        // dormant torrents are moved in libtorrent's queue, attach them first
+        if (torrent && !torrent->isSeed() && torrent->attach())
             torrentQueue.emplace(torrent->queuePosition(), torrent);
     }
 
@@ -2018,8 +2093,8 @@ void Session::decreaseTorrentsQueuePos(const QVector<InfoHash> &hashes)
         torrentQueue.pop();
     }
 
-    for (auto i = m_downloadedMetadata.cbegin(); i != m_downloadedMetadata.cend(); ++i)
-        torrentQueuePositionBottom(m_nativeSession->find_torrent(*i));
+    for (const lt::torrent_handle &nativeHandle : asConst(m_downloadedMetadata))
+        torrentQueuePositionBottom(nativeHandle);
 
     saveTorrentsQueue();
 }
@@ -2033,7 +2108,8 @@ void Session::topTorrentsQueuePos(const QVector<InfoHash> &hashes)
     for (const InfoHash &infoHash : hashes)
     {
         TorrentImpl *const torrent = m_torrents.value(infoHash);
-        if (torrent && !torrent->isSeed())
+        // dormant torrents are moved in libtorrent's queue, attach them first
+        if (torrent && !torrent->isSeed() && torrent->attach())
             torrentQueue.emplace(torrent->queuePosition(), torrent);
     }
 
@@ -2059,7 +2135,8 @@ void Session::bottomTorrentsQueuePos(const QVector<InfoHash> &hashes)
     for (const InfoHash &infoHash : hashes)
     {
         TorrentImpl *const torrent = m_torrents.value(infoHash);
-        if (torrent && !torrent->isSeed())
+        // dormant torrents are moved in libtorrent's queue, attach them first
+        if (torrent && !torrent->isSeed() && torrent->attach())
             torrentQueue.emplace(torrent->queuePosition(), torrent);
     }
 
@@ -2071,8 +2148,8 @@ void Session::bottomTorrentsQueuePos(const QVector<InfoHash> &hashes)
         torrentQueue.pop();
     }
 
-    for (auto i = m_downloadedMetadata.cbegin(); i != m_downloadedMetadata.cend(); ++i)
-        torrentQueuePositionBottom(m_nativeSession->find_torrent(*i));
+    for (const lt::torrent_handle &nativeHandle : asConst(m_downloadedMetadata))
+        torrentQueuePositionBottom(nativeHandle);
 
     saveTorrentsQueue();
 }
@@ -2093,6 +2170,93 @@ QVector<Torrent *> Session::torrents() const
     return result;
 }
 
+QHash<QString, QSet<InfoHash>> Session::trackerIndex() const
+{
+    return m_trackerIndex;
+}
+
+QVector<TrackerHealth> Session::trackerHealth() const
+{
+    return m_announceCoordinator->health();
+}
+
+void Session::handleTrackerSuppressionChanged(const QString &url)
+{
+    // Only the announces to this tracker are moved, the other trackers of the torrents
+    // keep their schedule. This is spread over time since a tracker can be used by
+    // thousands of torrents.
+    for (const InfoHash &hash : asConst(m_trackerIndex.value(url)))
+        enqueueTrackerReschedule(hash, url);
+}
+
+void Session::enqueueTrackerReschedule(const InfoHash &hash, const QString &url)
+{
+    m_pendingTrackerReschedules[hash].insert(url);
+    if (!m_trackerRescheduleTimer->isActive())
+        m_trackerRescheduleTimer->start();
+}
+
+void Session::processTrackerReschedules()
+{
+    int count = 0;
+    for (auto i = m_pendingTrackerReschedules.begin(); i != m_pendingTrackerReschedules.end();)
+    {
+        if (count == MAX_TRACKER_RESCHEDULES_PER_TICK)
+            return;
+
+        TorrentImpl *const torrent = m_torrents.value(i.key());
+        // dormant torrents get the backoff state when they wake up
+        if (torrent && !torrent->isDormant())
+        {
+            for (const QString &url : asConst(i.value()))
+            {
+                const int backoff = m_announceCoordinator->remainingBackoff(url);
+                torrent->rescheduleTrackerAnnounce(url
+                    , ((backoff > 0) ? backoff : m_announceCoordinator->takeAnnounceSlot(url)));
+            }
+            ++count;
+        }
+
+        i = m_pendingTrackerReschedules.erase(i);
+    }
+
+    m_trackerRescheduleTimer->stop();
+}
+
+void Session::addToTrackerIndex(const InfoHash &hash, const QVector<TrackerEntry> &trackers)
+{
+    for (const TrackerEntry &tracker : trackers)
+    {
+        QSet<InfoHash> &hashes = m_trackerIndex[tracker.url()];
+        if (hashes.contains(hash))
+            continue;
+
+        hashes.insert(hash);
+        TrackerRegistry::addReference(tracker.url());
+
+        // don't let a new torrent announce to a tracker that is known to be down
+        if (m_announceCoordinator->isSuppressed(tracker.url()))
+            enqueueTrackerReschedule(hash, tracker.url());
+    }
+}
+
+void Session::removeFromTrackerIndex(const InfoHash &hash, const QVector<TrackerEntry> &trackers)
+{
+    for (const TrackerEntry &tracker : trackers)
+    {
+        const auto iter = m_trackerIndex.find(tracker.url());
+        if (iter == m_trackerIndex.end())
+            continue;
+
+        if (!iter->remove(hash))
+            continue;
+
+        TrackerRegistry::releaseReference(tracker.url());
+        if (iter->isEmpty())
+            m_trackerIndex.erase(iter);
+    }
+}
+
 bool Session::addTorrent(const QString &source, const AddTorrentParams &params)
 {
     // `source`: .torrent file path/url or magnet uri
@@ -2302,6 +2466,28 @@ bool Session::loadTorrent(LoadTorrentParams params)
     return true;
 }
 
+// Restore a stopped torrent from its resume data without adding it to libtorrent.
+// It is attached to the session when something needs its native handle.
+void Session::loadDormantTorrent(const LoadTorrentParams &params, const int queuePosition)
+{
+    auto *const torrent = new TorrentImpl {this, m_nativeSession, lt::torrent_handle {}, params};
+    m_torrents.insert(torrent->hash(), torrent);
+    if (queuePosition >= 0)
+    {
+        m_dormantQueue.insert(queuePosition, torrent->hash());
+        m_dormantQueuePositions.insert(torrent->hash(), queuePosition);
+    }
+    addToTrackerIndex(torrent->hash(), torrent->trackers());
+
+    LogMsg(tr("'%1' restored.", "'torrent name' restored.").arg(torrent->name()));
+
+    if (((torrent->ratioLimit() >= 0) || (torrent->seedingTimeLimit() >= 0))
+        && !m_seedingLimitTimer->isActive())
+        m_seedingLimitTimer->start();
+
+    emit torrentLoaded(torrent);
+}
+
 void Session::findIncompleteFiles(const TorrentInfo &torrentInfo, const QString &savePath) const
 {
     const InfoHash searchId = torrentInfo.hash();
@@ -2372,7 +2558,7 @@ bool Session::downloadMetadata(const MagnetUri &magnetUri)
     if (ec) return false;
 
     // waiting for metadata...
-    m_downloadedMetadata.insert(h.info_hash());
+    m_downloadedMetadata.insert(h.info_hash(), h);
     ++m_extraLimit;
     adjustLimits();
 
@@ -2405,14 +2591,14 @@ void Session::exportTorrentFile(const Torrent *torrent, TorrentExportFolder fold
     }
 }
 
-void Session::generateResumeData()
+void Session::generateResumeData(const bool flushDiskCache)
 {
     for (TorrentImpl *const torrent : asConst(m_torrents))
     {
         if (!torrent->isValid()) continue;
 
         if (torrent->needSaveResumeData())
-            torrent->saveResumeData();
+            torrent->saveResumeData(flushDiskCache);
     }
 }
 
@@ -2424,7 +2610,7 @@ void Session::saveResumeData()
 
     if (isQueueingSystemEnabled())
         saveTorrentsQueue();
-    generateResumeData();
+    generateResumeData(true);
 
     while (m_numResumeData > 0)
     {
@@ -2451,14 +2637,36 @@ void Session::saveResumeData()
 
 void Session::saveTorrentsQueue()
 {
+    // We require actual (non-cached) queue positions here!
+    // Take them all in a single request instead of querying every torrent handle.
+    const std::vector<lt::torrent_status> queuedTorrents = m_nativeSession->get_torrent_status(
+        [](const lt::torrent_status &status) { return (status.queue_position >= lt::queue_position_t {0}); }
+        , {});
+
     // store hash in textual representation
-    QMap<int, QString> queue; // Use QMap since it should be ordered by key
-    for (const TorrentImpl *torrent : asConst(m_torrents))
+    QMap<int, QString> nativeQueue; // Use QMap since it should be ordered by key
+    for (const lt::torrent_status &status : queuedTorrents)
+    {
+        TorrentImpl *const torrent = m_torrents.value(status.info_hash);
+        if (!torrent) continue;
+
+        // Keep the cached position current until the next state update arrives
+        torrent->handleQueuePositionUpdate(status.queue_position);
+
+        const int queuePos = static_cast<LTUnderlyingType<lt::queue_position_t>>(status.queue_position);
+        nativeQueue[queuePos] = torrent->hash();
+    }
+
+    // Put the dormant torrents back at their places. Their positions are renumbered
+    // as they go, to close the gaps left by the torrents that left the queue since.
+    QStringList queue = nativeQueue.values();
+    const QMap<int, InfoHash> dormantQueue = std::exchange(m_dormantQueue, {});
+    for (auto i = dormantQueue.cbegin(); i != dormantQueue.cend(); ++i)
     {
-        // We require actual (non-cached) queue position here!
-        const int queuePos = static_cast<LTUnderlyingType<lt::queue_position_t>>(torrent->nativeHandle().queue_position());
-        if (queuePos >= 0)
-            queue[queuePos] = torrent->hash();
+        const int queuePos = std::min(i.key(), queue.size());
+        queue.insert(queuePos, i.value());
+        m_dormantQueue.insert(queuePos, i.value());
+        m_dormantQueuePositions[i.value()] = queuePos;
     }
 
     QByteArray data;
@@ -2825,6 +3033,44 @@ void Session::setSaveResumeDataInterval(const int value)
     }
 }
 
+bool Session::isQuickRecheckEnabled() const
+{
+    return m_isQuickRecheckEnabled;
+}
+
+void Session::setQuickRecheckEnabled(const bool enabled)
+{
+    m_isQuickRecheckEnabled = enabled;
+}
+
+int Session::quickRecheckSpotCheckCount() const
+{
+    return m_quickRecheckSpotCheckCount;
+}
+
+void Session::setQuickRecheckSpotCheckCount(const int count)
+{
+    m_quickRecheckSpotCheckCount = count;
+}
+
+int Session::dormantTorrentTimeout() const
+{
+    return m_dormantTorrentTimeout;
+}
+
+void Session::setDormantTorrentTimeout(const int minutes)
+{
+    if (minutes == m_dormantTorrentTimeout)
+        return;
+
+    m_dormantTorrentTimeout = minutes;
+
+    if (minutes > 0)
+        m_dormancyTimer->start();
+    else
+        m_dormancyTimer->stop();
+}
+
 int Session::port() const
 {
     return m_port;
@@ -3305,6 +3551,30 @@ void Session::setDiskCacheSize(int size)
     }
 }
 
+int Session::readCacheSize() const
+{
+#ifdef QBT_APP_64BIT
+    return qMin(m_readCacheSize.get(), 33554431);  // 32768GiB
+#else
+    return qMin(m_readCacheSize.get(), 1536);
+#endif
+}
+
+void Session::setReadCacheSize(int size)
+{
+#ifdef QBT_APP_64BIT
+    size = qBound(0, size, 33554431);  // 32768GiB
+#else
+    size = qBound(0, size, 1536);
+#endif
+    if (size == m_readCacheSize)
+        return;
+
+    m_readCacheSize = size;
+    if (m_diskReadCache)
+        m_diskReadCache->setCapacity(size * 1024ULL * 1024);
+}
+
 int Session::diskCacheTTL() const
 {
     return m_diskCacheTTL;
@@ -3919,6 +4189,7 @@ void Session::handleTorrentSavingModeChanged(TorrentImpl *const torrent)
 void Session::handleTorrentTrackersAdded(TorrentImpl *const torrent, const QVector<TrackerEntry> &newTrackers)
 {
     torrent->saveResumeData();
+    addToTrackerIndex(torrent->hash(), newTrackers);
 
     for (const TrackerEntry &newTracker : newTrackers)
         LogMsg(tr("Tracker '%1' was added to torrent '%2'").arg(newTracker.url(), torrent->name()));
@@ -3932,6 +4203,18 @@ void Session::handleTorrentTrackersRemoved(TorrentImpl *const torrent, const QVe
 {
     torrent->saveResumeData();
 
+    // a tracker moved to another tier is reported as deleted and added again
+    QSet<QString> remainingURLs;
+    for (const TrackerEntry &tracker : asConst(torrent->trackers()))
+        remainingURLs.insert(tracker.url());
+    QVector<TrackerEntry> unusedTrackers;
+    for (const TrackerEntry &deletedTracker : deletedTrackers)
+    {
+        if (!remainingURLs.contains(deletedTracker.url()))
+            unusedTrackers.append(deletedTracker);
+    }
+    removeFromTrackerIndex(torrent->hash(), unusedTrackers);
+
     for (const TrackerEntry &deletedTracker : deletedTrackers)
         LogMsg(tr("Tracker '%1' was deleted from torrent '%2'").arg(deletedTracker.url(), torrent->name()));
     emit trackersRemoved(torrent, deletedTrackers);
@@ -3989,6 +4272,12 @@ void Session::handleTorrentPaused(TorrentImpl *const torrent)
 
 void Session::handleTorrentResumed(TorrentImpl *const torrent)
 {
+    for (const TrackerEntry &tracker : asConst(torrent->trackers()))
+    {
+        if (m_announceCoordinator->isSuppressed(tracker.url()))
+            enqueueTrackerReschedule(torrent->hash(), tracker.url());
+    }
+
     torrent->saveResumeData();
     emit torrentResumed(torrent);
 }
@@ -4037,13 +4326,30 @@ void Session::handleTorrentFinished(TorrentImpl *const torrent)
         emit allTorrentsFinished();
 }
 
-void Session::handleTorrentResumeDataReady(TorrentImpl *const torrent, const std::shared_ptr<lt::entry> &data)
+void Session::handleTorrentResumeDataReady(TorrentImpl *const torrent, const std::shared_ptr<lt::entry> &data
+                                           , const QStringList &snapshotFilePaths)
 {
     --m_numResumeData;
 
     // Separated thread is used for the blocking IO which results in slow processing of many torrents.
     // Copying lt::entry objects around isn't cheap.
 
+    if (!snapshotFilePaths.isEmpty())
+    {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+        QMetaObject::invokeMethod(m_resumeDataSavingManager
+            , [this, hash = torrent->hash(), data, snapshotFilePaths]()
+        {
+            m_resumeDataSavingManager->saveWithFileSnapshot(hash, data, snapshotFilePaths);
+        });
+#else
+        QMetaObject::invokeMethod(m_resumeDataSavingManager, "saveWithFileSnapshot"
+            , Q_ARG(BitTorrent::InfoHash, torrent->hash()), Q_ARG(std::shared_ptr<lt::entry>, data)
+            , Q_ARG(QStringList, snapshotFilePaths));
+#endif
+        return;
+    }
+
     const QString filename = QString::fromLatin1("%1.fastresume").arg(torrent->hash());
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
     QMetaObject::invokeMethod(m_resumeDataSavingManager
@@ -4054,8 +4360,20 @@ void Session::handleTorrentResumeDataReady(TorrentImpl *const torrent, const std
 #endif
 }
 
-void Session::handleTorrentTrackerReply(TorrentImpl *const torrent, const QString &trackerUrl)
+void Session::handleTorrentTrackerAnnounce(TorrentImpl *const torrent, const QString &trackerUrl)
+{
+    m_announceCoordinator->handleAnnounce(torrent->hash(), trackerUrl);
+}
+
+void Session::handleTorrentTrackerAnnounceFailed(TorrentImpl *const torrent, const QString &trackerUrl
+    , const QString &endpoint, const QString &message)
 {
+    m_announceCoordinator->handleFailure(torrent->hash(), trackerUrl, endpoint, message);
+}
+
+void Session::handleTorrentTrackerReply(TorrentImpl *const torrent, const QString &trackerUrl, const QString &endpoint)
+{
+    m_announceCoordinator->handleReply(torrent->hash(), trackerUrl, endpoint);
     emit trackerSuccess(torrent, trackerUrl);
 }
 
@@ -4064,34 +4382,121 @@ void Session::handleTorrentTrackerError(TorrentImpl *const torrent, const QStrin
     emit trackerError(torrent, trackerUrl);
 }
 
+lt::torrent_handle Session::attachTorrent(const TorrentImpl *torrent, lt::add_torrent_params p)
+{
+#if (LIBTORRENT_VERSION_NUM < 20000)
+    p.storage = customStorageConstructor;
+#endif
+    // Limits
+    p.max_connections = maxConnectionsPerTorrent();
+    p.max_uploads = maxUploadsPerTorrent();
+
+    // Added synchronously since the caller needs the handle right away.
+    // The resulting add_torrent_alert is ignored as the torrent isn't in m_loadingTorrents.
+    lt::error_code ec = lt::errors::make_error_code(lt::errors::no_metadata);
+    const lt::torrent_handle nativeHandle = p.ti ? m_nativeSession->add_torrent(p, ec) : lt::torrent_handle {};
+    if (!nativeHandle.is_valid())
+    {
+        LogMsg(tr("Couldn't restore dormant torrent \"%1\". Reason: %2")
+            .arg(torrent->name(), QString::fromStdString(ec.message())), Log::WARNING);
+        return {};
+    }
+
+    // It is added at the end of the queue, move it back to its place
+    const int queuePosition = takeDormantQueuePosition(torrent->hash());
+    if (queuePosition >= 0)
+    {
+        int nativePosition = queuePosition;
+        for (auto i = m_dormantQueue.cbegin(); (i != m_dormantQueue.cend()) && (i.key() < queuePosition); ++i)
+            --nativePosition;
+        nativeHandle.queue_position_set(lt::queue_position_t {nativePosition});
+    }
+
+    return nativeHandle;
+}
+
+void Session::detachTorrent(const TorrentImpl *torrent)
+{
+    const lt::torrent_handle nativeHandle = torrent->nativeHandle();
+
+    // The actual position is needed, the cached one can be behind the latest queue changes
+    const int queuePosition = queuePositionOf(nativeHandle.queue_position());
+    if (queuePosition >= 0)
+    {
+        m_dormantQueue.insert(queuePosition, torrent->hash());
+        m_dormantQueuePositions.insert(torrent->hash(), queuePosition);
+    }
+
+    m_nativeSession->remove_torrent(nativeHandle);
+}
+
+int Session::queuePositionOf(const lt::queue_position_t nativePosition) const
+{
+    if (nativePosition < lt::queue_position_t {0})
+        return -1;
+
+    int queuePosition = static_cast<LTUnderlyingType<lt::queue_position_t>>(nativePosition);
+    for (auto i = m_dormantQueue.cbegin(); (i != m_dormantQueue.cend()) && (i.key() <= queuePosition); ++i)
+        ++queuePosition;
+    return queuePosition;
+}
+
+int Session::dormantQueuePosition(const InfoHash &hash) const
+{
+    return m_dormantQueuePositions.value(hash, -1);
+}
+
+int Session::takeDormantQueuePosition(const InfoHash &hash)
+{
+    const auto iter = m_dormantQueuePositions.find(hash);
+    if (iter == m_dormantQueuePositions.end())
+        return -1;
+
+    const int queuePosition = iter.value();
+    m_dormantQueuePositions.erase(iter);
+    m_dormantQueue.remove(queuePosition);
+    return queuePosition;
+}
+
+bool Session::hasTorrentMetadataFile(const InfoHash &hash) const
+{
+    return QFile::exists(QDir(m_resumeFolderPath).absoluteFilePath(QString::fromLatin1("%1.torrent").arg(hash)));
+}
+
+TorrentInfo Session::loadTorrentMetadata(const InfoHash &hash) const
+{
+    const QString torrentFilePath = QDir(m_resumeFolderPath).absoluteFilePath(QString::fromLatin1("%1.torrent").arg(hash));
+    QString error;
+    const TorrentInfo metadata = TorrentInfo::loadFromFile(torrentFilePath, &error);
+    if (!metadata.isValid())
+    {
+        LogMsg(tr("Couldn't load torrent metadata file '%1'. Reason: %2").arg(torrentFilePath, error)
+            , Log::WARNING);
+    }
+    return metadata;
+}
+
 bool Session::addMoveTorrentStorageJob(TorrentImpl *torrent, const QString &newPath, const MoveStorageMode mode)
 {
     Q_ASSERT(torrent);
 
-    const lt::torrent_handle torrentHandle = torrent->nativeHandle();
+    const InfoHash hash = torrent->hash();
     const QString currentLocation = torrent->actualStorageLocation();
 
-    if (m_moveStorageQueue.size() > 1)
+    const auto pendingJobIter = m_pendingMoveStorageJobs.constFind(hash);
+    if (pendingJobIter != m_pendingMoveStorageJobs.cend())
     {
-        const auto iter = std::find_if(m_moveStorageQueue.begin() + 1, m_moveStorageQueue.end()
-                                 , [&torrentHandle](const MoveStorageJob &job)
-        {
-            return job.torrentHandle == torrentHandle;
-        });
-
-        if (iter != m_moveStorageQueue.end())
-        {
-            // remove existing inactive job
-            m_moveStorageQueue.erase(iter);
-            LogMsg(tr("Cancelled moving \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, iter->path));
-        }
+        // remove existing inactive job
+        LogMsg(tr("Cancelled moving \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, pendingJobIter->path));
+        cancelMoveStorageJob(hash);
     }
 
-    if (!m_moveStorageQueue.isEmpty() && (m_moveStorageQueue.first().torrentHandle == torrentHandle))
+    const auto activeJobIter = m_activeMoveStorageJobs.constFind(hash);
+    if (activeJobIter != m_activeMoveStorageJobs.cend())
     {
         // if there is active job for this torrent prevent creating meaningless
         // job that will move torrent to the same location as current one
-        if (QDir {m_moveStorageQueue.first().path} == QDir {newPath})
+        if (QDir {activeJobIter->path} == QDir {newPath})
         {
             LogMsg(tr("Couldn't enqueue move of \"%1\" to \"%2\". Torrent is currently moving to the same destination location.")
                    .arg(torrent->name(), newPath));
@@ -4108,43 +4513,248 @@ bool Session::addMoveTorrentStorageJob(TorrentImpl *torrent, const QString &newP
         }
     }
 
-    const MoveStorageJob moveStorageJob {torrentHandle, newPath, mode};
-    m_moveStorageQueue << moveStorageJob;
+    MoveStorageJob moveStorageJob {torrent->nativeHandle(), newPath, mode};
+    // the job starts from where the active one (if any) leaves the torrent
+    moveStorageJob.sourcePath = ((activeJobIter != m_activeMoveStorageJobs.cend()) ? activeJobIter->path : currentLocation);
+    moveStorageJob.sourceDevice = storageDevice(moveStorageJob.sourcePath);
+    moveStorageJob.destinationDevice = storageDevice(newPath);
+    moveStorageJob.sequence = ++m_moveStorageJobSequence;
+
+    if (const TorrentImpl *torrent = m_torrents.value(hash))
+        moveStorageJob.totalSize = torrent->totalSize();
+
+    m_pendingMoveStorageJobs.insert(hash, moveStorageJob);
+    m_moveStorageQueue.insert(moveStorageJob.sequence, hash);
+    m_pendingMoveStorageJobsPerDevices[qMakePair(moveStorageJob.sourceDevice, moveStorageJob.destinationDevice)]
+            .insert(moveStorageJob.sequence, hash);
     LogMsg(tr("Enqueued to move \"%1\" from \"%2\" to \"%3\".").arg(torrent->name(), currentLocation, newPath));
 
-    if (m_moveStorageQueue.size() == 1)
-        moveTorrentStorage(moveStorageJob);
+    processMoveStorageQueue();
 
     return true;
 }
 
-void Session::moveTorrentStorage(const MoveStorageJob &job) const
+QVector<MoveStorageJobStatus> Session::moveStorageJobs() const
+{
+    QVector<MoveStorageJobStatus> jobs;
+    jobs.reserve(m_activeMoveStorageJobs.size() + m_pendingMoveStorageJobs.size());
+
+    for (auto iter = m_activeMoveStorageJobs.cbegin(); iter != m_activeMoveStorageJobs.cend(); ++iter)
+    {
+        const MoveStorageJob &job = iter.value();
+
+        MoveStorageJobStatus jobStatus;
+        jobStatus.hash = iter.key();
+        jobStatus.sourcePath = job.sourcePath;
+        jobStatus.destinationPath = job.path;
+        jobStatus.isActive = true;
+        jobStatus.totalSize = job.totalSize;
+        jobStatus.movedSize = job.movedSize;
+
+        const qint64 elapsed = job.elapsedTimer.elapsed();
+        if (elapsed > 0)
+            jobStatus.speed = job.movedSize * 1000 / elapsed;
+
+        jobs << jobStatus;
+    }
+
+    for (const InfoHash &hash : m_moveStorageQueue)
+    {
+        const MoveStorageJob job = m_pendingMoveStorageJobs.value(hash);
+
+        MoveStorageJobStatus jobStatus;
+        jobStatus.hash = hash;
+        jobStatus.sourcePath = job.sourcePath;
+        jobStatus.destinationPath = job.path;
+        jobStatus.totalSize = job.totalSize;
+
+        jobs << jobStatus;
+    }
+
+    return jobs;
+}
+
+QString Session::storageDevice(const QString &path)
+{
+    if (!m_storageDeviceCacheTimer.isValid() || m_storageDeviceCacheTimer.hasExpired(STORAGE_DEVICE_CACHE_TTL))
+    {
+        m_storageDeviceCache.clear();
+        m_storageDeviceCacheTimer.start();
+    }
+
+    const auto iter = m_storageDeviceCache.constFind(path);
+    if (iter != m_storageDeviceCache.cend())
+        return *iter;
+
+    // Destination folder may not exist yet, so look up the closest existing parent
+    QString existingPath = path;
+    while (!QFileInfo::exists(existingPath))
+    {
+        const QString parentPath = QFileInfo(existingPath).path();
+        if (parentPath == existingPath)
+            break;
+        existingPath = parentPath;
+    }
+
+    const QStorageInfo storageInfo {existingPath};
+    // Treat unknown devices as separate ones rather than blocking them on each other
+    const QString device = storageInfo.isValid() ? QString::fromLocal8Bit(storageInfo.device()) : path;
+    m_storageDeviceCache.insert(path, device);
+    return device;
+}
+
+void Session::processMoveStorageQueue()
+{
+    const auto isDeviceAvailable = [this](const QString &device)
+    {
+        return (m_activeMoveStorageJobsPerDevice.value(device) < MAX_MOVE_STORAGE_JOBS_PER_DEVICE);
+    };
+
+    // Only the first jobs of the queues whose devices have a free slot can be started,
+    // so start the earliest enqueued of them until there is none left
+    forever
+    {
+        auto nextQueueIter = m_pendingMoveStorageJobsPerDevices.end();
+        auto nextJobIter = QMap<quint64, InfoHash>::iterator {};
+        for (auto queueIter = m_pendingMoveStorageJobsPerDevices.begin(); queueIter != m_pendingMoveStorageJobsPerDevices.end(); ++queueIter)
+        {
+            if (!isDeviceAvailable(queueIter.key().first) || !isDeviceAvailable(queueIter.key().second))
+                continue;
+
+            // a torrent can only be moved by one job at once
+            QMap<quint64, InfoHash> &queue = queueIter.value();
+            auto jobIter = std::find_if(queue.begin(), queue.end(), [this](const InfoHash &hash)
+            {
+                return !m_activeMoveStorageJobs.contains(hash);
+            });
+            if (jobIter == queue.end())
+                continue;
+
+            if ((nextQueueIter == m_pendingMoveStorageJobsPerDevices.end()) || (jobIter.key() < nextJobIter.key()))
+            {
+                nextQueueIter = queueIter;
+                nextJobIter = jobIter;
+            }
+        }
+
+        if (nextQueueIter == m_pendingMoveStorageJobsPerDevices.end())
+            break;
+
+        const InfoHash hash = nextJobIter.value();
+        m_moveStorageQueue.remove(nextJobIter.key());
+        nextQueueIter->erase(nextJobIter);
+        if (nextQueueIter->isEmpty())
+            m_pendingMoveStorageJobsPerDevices.erase(nextQueueIter);
+
+        moveTorrentStorage(m_pendingMoveStorageJobs.take(hash));
+    }
+}
+
+void Session::moveTorrentStorage(MoveStorageJob job)
 {
     const InfoHash infoHash = job.torrentHandle.info_hash();
     const TorrentImpl *torrent = m_torrents.value(infoHash);
     const QString torrentName = (torrent ? torrent->name() : QString {infoHash});
     LogMsg(tr("Moving \"%1\" to \"%2\"...").arg(torrentName, job.path));
 
+    ++m_activeMoveStorageJobsPerDevice[job.sourceDevice];
+    if (job.destinationDevice != job.sourceDevice)
+        ++m_activeMoveStorageJobsPerDevice[job.destinationDevice];
+
+    job.elapsedTimer.start();
+    if (!m_moveStorageProgressTimer->isActive())
+        m_moveStorageProgressTimer->start();
     job.torrentHandle.move_storage(job.path.toUtf8().constData()
                             , ((job.mode == MoveStorageMode::Overwrite)
                             ? lt::move_flags_t::always_replace_files : lt::move_flags_t::dont_replace));
+    m_activeMoveStorageJobs.insert(infoHash, job);
 }
 
-void Session::handleMoveTorrentStorageJobFinished()
+void Session::cancelMoveStorageJob(const InfoHash &hash)
 {
-    const MoveStorageJob finishedJob = m_moveStorageQueue.takeFirst();
-    if (!m_moveStorageQueue.isEmpty())
-        moveTorrentStorage(m_moveStorageQueue.first());
+    const auto iter = m_pendingMoveStorageJobs.find(hash);
+    if (iter == m_pendingMoveStorageJobs.end())
+        return;
+
+    m_moveStorageQueue.remove(iter->sequence);
 
-    const auto iter = std::find_if(m_moveStorageQueue.cbegin(), m_moveStorageQueue.cend()
-                                   , [&finishedJob](const MoveStorageJob &job)
+    const auto queueIter = m_pendingMoveStorageJobsPerDevices.find(qMakePair(iter->sourceDevice, iter->destinationDevice));
+    if (queueIter != m_pendingMoveStorageJobsPerDevices.end())
     {
-        return job.torrentHandle == finishedJob.torrentHandle;
-    });
+        queueIter->remove(iter->sequence);
+        if (queueIter->isEmpty())
+            m_pendingMoveStorageJobsPerDevices.erase(queueIter);
+    }
+
+    m_pendingMoveStorageJobs.erase(iter);
+}
+
+void Session::countMovedSizes()
+{
+    // libtorrent doesn't report the progress of moves, so look at how much
+    // of the content is already in place, off the main thread
+    for (auto iter = m_activeMoveStorageJobs.begin(); iter != m_activeMoveStorageJobs.end(); ++iter)
+    {
+        MoveStorageJob &job = iter.value();
+        if (job.isCountingMovedSize)
+            continue;
+
+        const TorrentImpl *torrent = m_torrents.value(iter.key());
+        if (!torrent || !torrent->hasMetadata())
+            continue;
+
+        QStringList fileNames;
+        fileNames.reserve(torrent->filesCount());
+        for (int i = 0; i < torrent->filesCount(); ++i)
+            fileNames << torrent->filePath(i);
+
+        job.isCountingMovedSize = true;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+        QMetaObject::invokeMethod(m_fileSizeCounter, [this, id = iter.key(), basePath = job.path, fileNames]()
+        {
+            m_fileSizeCounter->count(id, basePath, fileNames);
+        });
+#else
+        QMetaObject::invokeMethod(m_fileSizeCounter, "count"
+                                  , Q_ARG(BitTorrent::InfoHash, iter.key()), Q_ARG(QString, job.path)
+                                  , Q_ARG(QStringList, fileNames));
+#endif
+    }
+}
+
+void Session::movedSizeCountFinished(const InfoHash &id, const QString &basePath, const qint64 size)
+{
+    const auto iter = m_activeMoveStorageJobs.find(id);
+    // the job may have finished or been replaced in the meantime
+    if ((iter == m_activeMoveStorageJobs.end()) || (iter->path != basePath))
+        return;
+
+    iter->isCountingMovedSize = false;
+    iter->movedSize = std::min(size, iter->totalSize);
+}
+
+void Session::handleMoveTorrentStorageJobFinished(const InfoHash &hash)
+{
+    const MoveStorageJob finishedJob = m_activeMoveStorageJobs.take(hash);
+
+    const auto releaseDevice = [this](const QString &device)
+    {
+        if (--m_activeMoveStorageJobsPerDevice[device] <= 0)
+            m_activeMoveStorageJobsPerDevice.remove(device);
+    };
+    releaseDevice(finishedJob.sourceDevice);
+    if (finishedJob.destinationDevice != finishedJob.sourceDevice)
+        releaseDevice(finishedJob.destinationDevice);
+
+    if (m_activeMoveStorageJobs.isEmpty())
+        m_moveStorageProgressTimer->stop();
 
-    const bool torrentHasOutstandingJob = (iter != m_moveStorageQueue.cend());
+    processMoveStorageQueue();
 
-    TorrentImpl *torrent = m_torrents.value(finishedJob.torrentHandle.info_hash());
+    const bool torrentHasOutstandingJob = (m_activeMoveStorageJobs.contains(hash)
+                                           || m_pendingMoveStorageJobs.contains(hash));
+
+    TorrentImpl *torrent = m_torrents.value(hash);
     if (torrent)
     {
         torrent->handleMoveStorageJobFinished(torrentHasOutstandingJob);
@@ -4286,6 +4896,30 @@ const CacheStatus &Session::cacheStatus() const
     return m_cacheStatus;
 }
 
+const QVector<SessionMetric> &Session::metrics() const
+{
+    return m_metrics;
+}
+
+const QVector<qint64> &Session::metricValues() const
+{
+    return m_metricValues;
+}
+
+QHash<QString, quint64> Session::blockedPeerCounts() const
+{
+    QHash<QString, quint64> counts = m_blockedPeerCounts;
+    // the peers dropped by the client filters never show up in the alerts
+    for (const auto &tagCount : peer_filter_counters::instance().counts())
+        counts[QString::fromStdString(tagCount.first).replace(QLatin1Char(' '), QLatin1Char('_'))] += tagCount.second;
+    return counts;
+}
+
+Metrics::Histogram Session::resumeDataSaveLatency() const
+{
+    return m_resumeDataSavingManager->saveLatency();
+}
+
 bool Session::loadTorrentResumeData(const QByteArray &data, const TorrentInfo &metadata, LoadTorrentParams &torrentParams)
 {
     torrentParams = {};
@@ -4303,6 +4937,28 @@ bool Session::loadTorrentResumeData(const QByteArray &data, const TorrentInfo &m
     torrentParams.firstLastPiecePriority = root.dict_find_int_value("qBt-firstLastPiecePriority");
     torrentParams.seedingTimeLimit = root.dict_find_int_value("qBt-seedingTimeLimit", Torrent::USE_GLOBAL_SEEDING_TIME);
 
+    const lt::bdecode_node fileSnapshotNode = root.dict_find_list("qBt-fileSnapshot");
+    if (fileSnapshotNode)
+    {
+        torrentParams.fileSnapshot.reserve(fileSnapshotNode.list_size());
+        for (int i = 0; i < fileSnapshotNode.list_size(); ++i)
+        {
+            const lt::bdecode_node fileNode = fileSnapshotNode.list_at(i);
+            if ((fileNode.type() != lt::bdecode_node::list_t) || (fileNode.list_size() != 3))
+            {
+                // a partial snapshot is useless
+                torrentParams.fileSnapshot.clear();
+                break;
+            }
+
+            FileSnapshot fileSnapshot;
+            fileSnapshot.size = fileNode.list_int_value_at(0, -1);
+            fileSnapshot.lastModified = fileNode.list_int_value_at(1);
+            fileSnapshot.inode = static_cast<quint64>(fileNode.list_int_value_at(2));
+            torrentParams.fileSnapshot.append(fileSnapshot);
+        }
+    }
+
     // TODO: The following code is deprecated. Replace with the commented one after several releases in 4.4.x.
     // === BEGIN DEPRECATED CODE === //
     const lt::bdecode_node contentLayoutNode = root.dict_find("qBt-contentLayout");
@@ -4445,6 +5101,7 @@ void Session::startUpTorrents()
 
     const QRegularExpression rx(QLatin1String("^([A-Fa-f0-9]{40})\\.fastresume$"));
 
+    int queueSize = 0; // the queued torrents come first
     if (isQueueingSystemEnabled())
     {
         QFile queueFile {resumeDataDir.absoluteFilePath(QLatin1String {"queue"})};
@@ -4463,11 +5120,14 @@ void Session::startUpTorrents()
 
         if (!queue.empty())
             fastresumes = queue + List::toSet(fastresumes).subtract(List::toSet(queue)).values();
+        queueSize = queue.size();
     }
 
+    const bool keepDormant = (dormantTorrentTimeout() > 0);
     int resumedTorrentsCount = 0;
-    for (const QString &fastresumeName : asConst(fastresumes))
+    for (int index = 0; index < fastresumes.size(); ++index)
     {
+        const QString &fastresumeName = fastresumes[index];
         const QRegularExpressionMatch rxMatch = rx.match(fastresumeName);
         if (!rxMatch.hasMatch()) continue;
 
@@ -4480,7 +5140,9 @@ void Session::startUpTorrents()
         if (readFile(fastresumePath, data) && loadTorrentResumeData(data, metadata, torrentParams))
         {
             qDebug() << "Starting up torrent" << hash << "...";
-            if (!loadTorrent(torrentParams))
+            if (keepDormant && torrentParams.paused && metadata.isValid())
+                loadDormantTorrent(torrentParams, ((index < queueSize) ? index : -1));
+            else if (!loadTorrent(torrentParams))
                 LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
                            .arg(hash), Log::CRITICAL);
 
@@ -4507,6 +5169,11 @@ quint64 Session::getAlltimeUL() const
     return m_statistics->getAlltimeUL();
 }
 
+const TransferHistory *Session::transferHistory() const
+{
+    return m_transferHistory;
+}
+
 void Session::enqueueRefresh()
 {
     Q_ASSERT(!m_refreshEnqueued);
@@ -4566,6 +5233,9 @@ void Session::setTorrentContentLayout(const TorrentContentLayout value)
 void Session::readAlerts()
 {
     const std::vector<lt::alert *> alerts = getPendingAlerts();
+    m_status.alertQueueDepth = alerts.size();
+    m_status.alertsProcessed += alerts.size();
+
     for (const lt::alert *a : alerts)
         handleAlert(a);
 }
@@ -4583,6 +5253,7 @@ void Session::handleAlert(const lt::alert *a)
         case lt::save_resume_data_failed_alert::alert_type:
         case lt::torrent_paused_alert::alert_type:
         case lt::torrent_resumed_alert::alert_type:
+        case lt::tracker_announce_alert::alert_type:
         case lt::tracker_error_alert::alert_type:
         case lt::tracker_reply_alert::alert_type:
         case lt::tracker_warning_alert::alert_type:
@@ -4681,6 +5352,7 @@ void Session::createTorrent(const lt::torrent_handle &nativeHandle)
 
     auto *const torrent = new TorrentImpl {this, m_nativeSession, nativeHandle, params};
     m_torrents.insert(torrent->hash(), torrent);
+    addToTrackerIndex(torrent->hash(), torrent->trackers());
 
     const bool hasMetadata = torrent->hasMetadata();
 
@@ -4739,6 +5411,20 @@ void Session::createTorrent(const lt::torrent_handle &nativeHandle)
         LogMsg(tr("Torrent errored. Torrent: \"%1\". Error: %2.").arg(torrent->name(), torrent->error()), Log::WARNING);
 }
 
+void Session::processDormantTorrents()
+{
+    const qint64 timeout = dormantTorrentTimeout() * 60 * 1000LL;
+    if (timeout <= 0) return;
+
+    for (TorrentImpl *const torrent : asConst(m_torrents))
+    {
+        if (torrent->canBecomeDormant() && (torrent->idleTime() >= timeout))
+            torrent->requestDetach();
+        else if (torrent->isDormant())
+            torrent->releaseMetadata();  // in case it was read back since
+    }
+}
+
 void Session::handleAddTorrentAlert(const lt::add_torrent_alert *p)
 {
     if (p->error)
@@ -4861,28 +5547,37 @@ void Session::handlePortmapAlert(const lt::portmap_alert *p)
 void Session::handlePeerBlockedAlert(const lt::peer_blocked_alert *p)
 {
     QString reason;
+    QString filter = QLatin1String("other");
     switch (p->reason)
     {
     case lt::peer_blocked_alert::ip_filter:
         reason = tr("IP filter", "this peer was blocked. Reason: IP filter.");
+        filter = QLatin1String("ip_filter");
         break;
     case lt::peer_blocked_alert::port_filter:
         reason = tr("port filter", "this peer was blocked. Reason: port filter.");
+        filter = QLatin1String("port_filter");
         break;
     case lt::peer_blocked_alert::i2p_mixed:
         reason = tr("%1 mixed mode restrictions", "this peer was blocked. Reason: I2P mixed mode restrictions.").arg("I2P"); // don't translate I2P
+        filter = QLatin1String("i2p_mixed");
         break;
     case lt::peer_blocked_alert::privileged_ports:
         reason = tr("use of privileged port", "this peer was blocked. Reason: use of privileged port.");
+        filter = QLatin1String("privileged_ports");
         break;
     case lt::peer_blocked_alert::utp_disabled:
         reason = tr("%1 is disabled", "this peer was blocked. Reason: uTP is disabled.").arg(QString::fromUtf8(C_UTP)); // don't translate μTP
+        filter = QLatin1String("utp_disabled");
         break;
     case lt::peer_blocked_alert::tcp_disabled:
         reason = tr("%1 is disabled", "this peer was blocked. Reason: TCP is disabled.").arg("TCP"); // don't translate TCP
+        filter = QLatin1String("tcp_disabled");
         break;
     }
 
+    ++m_blockedPeerCounts[filter];
+
     const QString ip {toString(p->endpoint.address())};
     if (!ip.isEmpty())
         Logger::instance()->addPeer(ip, true, reason);
@@ -4890,6 +5585,8 @@ void Session::handlePeerBlockedAlert(const lt::peer_blocked_alert *p)
 
 void Session::handlePeerBanAlert(const lt::peer_ban_alert *p)
 {
+    ++m_blockedPeerCounts[QLatin1String("banned")];
+
     const QString ip {toString(p->endpoint.address())};
     if (!ip.isEmpty())
         Logger::instance()->addPeer(ip, false);
@@ -4922,9 +5619,11 @@ void Session::handleListenSucceededAlert(const lt::listen_succeeded_alert *p)
               , "e.g: Successfully listening on IP: 192.168.0.1, port: TCP/6881")
             .arg(toString(p->address), proto, QString::number(p->port)), Log::INFO);
 
-    // Force reannounce on all torrents because some trackers blacklist some ports
-    for (const lt::torrent_handle &torrent : m_nativeSession->get_torrents())
-        torrent.force_reannounce();
+    // Force reannounce on all torrents because some trackers blacklist some ports.
+    // Announces are spread over time and skip trackers that are currently down.
+    m_announceCoordinator->reannounce(m_torrents.values().toVector(), m_trackerIndex);
+    for (const lt::torrent_handle &nativeHandle : asConst(m_downloadedMetadata))
+        nativeHandle.force_reannounce();
 }
 
 void Session::handleListenFailedAlert(const lt::listen_failed_alert *p)
@@ -4948,6 +5647,8 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
     m_statsLastTimestamp = p->timestamp();
 
     const auto stats = p->counters();
+    m_metricValues.resize(static_cast<int>(stats.size()));
+    std::copy(stats.begin(), stats.end(), m_metricValues.begin());
 
     m_status.hasIncomingConnections = static_cast<bool>(stats[m_metricIndices.net.hasIncomingConnections]);
 
@@ -5003,6 +5704,14 @@ void Session::handleSessionStatsAlert(const lt::session_stats_alert *p)
 #if (LIBTORRENT_VERSION_NUM < 20000)
     const int64_t numBlocksCacheHits = stats[m_metricIndices.disk.numBlocksCacheHits];
     m_cacheStatus.readRatio = static_cast<qreal>(numBlocksCacheHits) / std::max<int64_t>((numBlocksCacheHits + numBlocksRead), 1);
+#else
+    const DiskReadCacheStats readCacheStats = m_diskReadCache->stats();
+    m_cacheStatus.readCacheHits = readCacheStats.hits;
+    m_cacheStatus.readCacheMisses = readCacheStats.misses;
+    m_cacheStatus.readCacheEvictions = readCacheStats.evictions;
+    m_cacheStatus.readCacheBytesServed = readCacheStats.bytesServed;
+    m_cacheStatus.readCacheUsedBytes = readCacheStats.usedBytes;
+    m_cacheStatus.readRatio = static_cast<qreal>(readCacheStats.hits) / std::max<quint64>((readCacheStats.hits + readCacheStats.misses), 1);
 #endif
 
     const int64_t totalJobs = stats[m_metricIndices.disk.writeJobs] + stats[m_metricIndices.disk.readJobs]
@@ -5026,30 +5735,29 @@ void Session::handleAlertsDroppedAlert(const lt::alerts_dropped_alert *p) const
 
 void Session::handleStorageMovedAlert(const lt::storage_moved_alert *p)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
-
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == p->handle);
+    const InfoHash infoHash = p->handle.info_hash();
+    Q_ASSERT(m_activeMoveStorageJobs.contains(infoHash));
+    if (!m_activeMoveStorageJobs.contains(infoHash))
+        return;
 
     const QString newPath {p->storage_path()};
-    Q_ASSERT(newPath == currentJob.path);
+    Q_ASSERT(newPath == m_activeMoveStorageJobs[infoHash].path);
 
-    const InfoHash infoHash = currentJob.torrentHandle.info_hash();
     TorrentImpl *torrent = m_torrents.value(infoHash);
     const QString torrentName = (torrent ? torrent->name() : QString {infoHash});
     LogMsg(tr("\"%1\" is successfully moved to \"%2\".").arg(torrentName, newPath));
 
-    handleMoveTorrentStorageJobFinished();
+    handleMoveTorrentStorageJobFinished(infoHash);
 }
 
 void Session::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert *p)
 {
-    Q_ASSERT(!m_moveStorageQueue.isEmpty());
-
-    const MoveStorageJob &currentJob = m_moveStorageQueue.first();
-    Q_ASSERT(currentJob.torrentHandle == p->handle);
+    const InfoHash infoHash = p->handle.info_hash();
+    Q_ASSERT(m_activeMoveStorageJobs.contains(infoHash));
+    if (!m_activeMoveStorageJobs.contains(infoHash))
+        return;
 
-    const InfoHash infoHash = currentJob.torrentHandle.info_hash();
+    const MoveStorageJob &currentJob = m_activeMoveStorageJobs[infoHash];
     TorrentImpl *torrent = m_torrents.value(infoHash);
     const QString torrentName = (torrent ? torrent->name() : QString {infoHash});
     const QString currentLocation = QString::fromStdString(p->handle.status(lt::torrent_handle::query_save_path).save_path);
@@ -5057,7 +5765,7 @@ void Session::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert
     LogMsg(tr("Failed to move \"%1\" from \"%2\" to \"%3\". Reason: %4.")
            .arg(torrentName, currentLocation, currentJob.path, errorMessage), Log::CRITICAL);
 
-    handleMoveTorrentStorageJobFinished();
+    handleMoveTorrentStorageJobFinished(infoHash);
 }
 
 void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
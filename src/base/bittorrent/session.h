@@ -38,16 +38,21 @@
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/version.hpp>
 
+#include <QElapsedTimer>
 #include <QHash>
+#include <QMap>
 #include <QPointer>
 #include <QSet>
 #include <QtContainerFwd>
 #include <QVector>
 
+#include "base/metrics.h"
 #include "base/settingvalue.h"
 #include "base/types.h"
 #include "addtorrentparams.h"
 #include "cachestatus.h"
+#include "infohash.h"
+#include "resumedataverifier.h"
 #include "sessionstatus.h"
 #include "torrentinfo.h"
 
@@ -69,6 +74,7 @@ class QUrl;
 
 class BandwidthScheduler;
 class FileSearcher;
+class FileSizeCounter;
 class FilterParserThread;
 class ResumeDataSavingManager;
 class Statistics;
@@ -102,13 +108,16 @@ namespace Net
 
 namespace BitTorrent
 {
-    class InfoHash;
+    class DiskReadCache;
     class MagnetUri;
     class Torrent;
     class TorrentImpl;
     class Tracker;
+    class TrackerAnnounceCoordinator;
     class TrackerEntry;
+    class TransferHistory;
     struct LoadTorrentParams;
+    struct TrackerHealth;
 
     enum class MoveStorageMode;
 
@@ -162,6 +171,26 @@ namespace BitTorrent
 #endif
     }
 
+    struct MoveStorageJobStatus
+    {
+        InfoHash hash;
+        QString sourcePath;
+        QString destinationPath;
+        bool isActive = false;
+        qint64 totalSize = 0;
+        // sampled periodically from the files found at the destination
+        qint64 movedSize = 0;
+        qint64 speed = 0; // bytes per second, averaged since the job started
+    };
+
+    // libtorrent session counter or gauge, resolved once at startup
+    struct SessionMetric
+    {
+        QByteArray name; // dots replaced so it can be used as a metric name, e.g. "libtorrent_net_sent_bytes"
+        int index = -1;
+        bool isGauge = false;
+    };
+
     struct SessionMetricIndices
     {
         struct
@@ -241,6 +270,7 @@ namespace BitTorrent
         static bool isValidTag(const QString &tag);
         QSet<QString> tags() const;
         bool hasTag(const QString &tag) const;
+        QString internTag(const QString &tag) const;
         bool addTag(const QString &tag);
         bool removeTag(const QString &tag);
 
@@ -310,6 +340,12 @@ namespace BitTorrent
 
         int saveResumeDataInterval() const;
         void setSaveResumeDataInterval(int value);
+        int dormantTorrentTimeout() const;
+        void setDormantTorrentTimeout(int minutes);
+        bool isQuickRecheckEnabled() const;
+        void setQuickRecheckEnabled(bool enabled);
+        int quickRecheckSpotCheckCount() const;
+        void setQuickRecheckSpotCheckCount(int count);
         int port() const;
         void setPort(int port);
         bool useRandomPort() const;
@@ -358,6 +394,8 @@ namespace BitTorrent
         void setDiskCacheSize(int size);
         int diskCacheTTL() const;
         void setDiskCacheTTL(int ttl);
+        int readCacheSize() const;
+        void setReadCacheSize(int size);
         bool useOSCache() const;
         void setUseOSCache(bool use);
         bool isCoalesceReadWriteEnabled() const;
@@ -442,13 +480,24 @@ namespace BitTorrent
         void startUpTorrents();
         Torrent *findTorrent(const InfoHash &hash) const;
         QVector<Torrent *> torrents() const;
+        // <tracker url, torrent hashes>, maintained incrementally as trackers are added and removed
+        QHash<QString, QSet<InfoHash>> trackerIndex() const;
+        QVector<TrackerHealth> trackerHealth() const;
+        QVector<MoveStorageJobStatus> moveStorageJobs() const;
         bool hasActiveTorrents() const;
         bool hasUnfinishedTorrents() const;
         bool hasRunningSeed() const;
         const SessionStatus &status() const;
         const CacheStatus &cacheStatus() const;
+        const QVector<SessionMetric> &metrics() const;
+        // values of the metrics from the last stats update, indexed by SessionMetric::index
+        const QVector<qint64> &metricValues() const;
+        // blocked and banned peers, keyed by the filter responsible for it
+        QHash<QString, quint64> blockedPeerCounts() const;
+        Metrics::Histogram resumeDataSaveLatency() const;
         quint64 getAlltimeDL() const;
         quint64 getAlltimeUL() const;
+        const TransferHistory *transferHistory() const;
         bool isListening() const;
 
         MaxRatioAction maxRatioAction() const;
@@ -489,11 +538,22 @@ namespace BitTorrent
         void handleTorrentTrackersChanged(TorrentImpl *const torrent);
         void handleTorrentUrlSeedsAdded(TorrentImpl *const torrent, const QVector<QUrl> &newUrlSeeds);
         void handleTorrentUrlSeedsRemoved(TorrentImpl *const torrent, const QVector<QUrl> &urlSeeds);
-        void handleTorrentResumeDataReady(TorrentImpl *const torrent, const std::shared_ptr<lt::entry> &data);
-        void handleTorrentTrackerReply(TorrentImpl *const torrent, const QString &trackerUrl);
+        void handleTorrentResumeDataReady(TorrentImpl *const torrent, const std::shared_ptr<lt::entry> &data
+                                          , const QStringList &snapshotFilePaths);
+        void handleTorrentTrackerAnnounce(TorrentImpl *const torrent, const QString &trackerUrl);
+        void handleTorrentTrackerAnnounceFailed(TorrentImpl *const torrent, const QString &trackerUrl, const QString &endpoint, const QString &message);
+        void handleTorrentTrackerReply(TorrentImpl *const torrent, const QString &trackerUrl, const QString &endpoint);
         void handleTorrentTrackerWarning(TorrentImpl *const torrent, const QString &trackerUrl);
         void handleTorrentTrackerError(TorrentImpl *const torrent, const QString &trackerUrl);
 
+        lt::torrent_handle attachTorrent(const TorrentImpl *torrent, lt::add_torrent_params p);
+        void detachTorrent(const TorrentImpl *torrent);
+        bool hasTorrentMetadataFile(const InfoHash &hash) const;
+        TorrentInfo loadTorrentMetadata(const InfoHash &hash) const;
+        // Positions in the whole queue, which includes the dormant torrents. -1 if not queued.
+        int queuePositionOf(lt::queue_position_t nativePosition) const;
+        int dormantQueuePosition(const InfoHash &hash) const;
+
         bool addMoveTorrentStorageJob(TorrentImpl *torrent, const QString &newPath, MoveStorageMode mode);
 
         void findIncompleteFiles(const TorrentInfo &torrentInfo, const QString &savePath) const;
@@ -560,11 +620,16 @@ namespace BitTorrent
         void readAlerts();
         void enqueueRefresh();
         void processShareLimits();
-        void generateResumeData();
+        void generateResumeData(bool flushDiskCache);
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
+        void handleTrackerSuppressionChanged(const QString &url);
+        void processTrackerReschedules();
         void handleDownloadFinished(const Net::DownloadResult &result);
         void fileSearchFinished(const InfoHash &id, const QString &savePath, const QStringList &fileNames);
+        void fileSnapshotTaken(const InfoHash &id, const QVector<FileSnapshot> &snapshot);
+        void countMovedSizes();
+        void movedSizeCountFinished(const InfoHash &id, const QString &basePath, qint64 size);
 
         // Session reconfiguration triggers
         void networkOnlineStateChanged(bool online);
@@ -579,6 +644,14 @@ namespace BitTorrent
             lt::torrent_handle torrentHandle;
             QString path;
             MoveStorageMode mode;
+            QString sourcePath;
+            QString sourceDevice;
+            QString destinationDevice;
+            quint64 sequence = 0;
+            QElapsedTimer elapsedTimer;
+            qint64 totalSize = 0;
+            qint64 movedSize = 0;
+            bool isCountingMovedSize = false;
         };
 
         struct RemovingTorrentData
@@ -622,6 +695,8 @@ namespace BitTorrent
 
         bool loadTorrentResumeData(const QByteArray &data, const TorrentInfo &metadata, LoadTorrentParams &torrentParams);
         bool loadTorrent(LoadTorrentParams params);
+        void loadDormantTorrent(const LoadTorrentParams &params, int queuePosition);
+        int takeDormantQueuePosition(const InfoHash &hash);
         LoadTorrentParams initLoadTorrentParams(const AddTorrentParams &addTorrentParams);
         bool addTorrent_impl(const std::variant<MagnetUri, TorrentInfo> &source, const AddTorrentParams &addTorrentParams);
 
@@ -652,6 +727,11 @@ namespace BitTorrent
         void handleSocks5Alert(const lt::socks5_alert *p) const;
 
         void createTorrent(const lt::torrent_handle &nativeHandle);
+        void processDormantTorrents();
+
+        void addToTrackerIndex(const InfoHash &hash, const QVector<TrackerEntry> &trackers);
+        void removeFromTrackerIndex(const InfoHash &hash, const QVector<TrackerEntry> &trackers);
+        void enqueueTrackerReschedule(const InfoHash &hash, const QString &url);
 
         void saveResumeData();
         void saveTorrentsQueue();
@@ -661,11 +741,15 @@ namespace BitTorrent
 
         std::vector<lt::alert *> getPendingAlerts(lt::time_duration time = lt::time_duration::zero()) const;
 
-        void moveTorrentStorage(const MoveStorageJob &job) const;
-        void handleMoveTorrentStorageJobFinished();
+        QString storageDevice(const QString &path);
+        void processMoveStorageQueue();
+        void moveTorrentStorage(MoveStorageJob job);
+        void cancelMoveStorageJob(const InfoHash &hash);
+        void handleMoveTorrentStorageJobFinished(const InfoHash &hash);
 
         // BitTorrent
         lt::session *m_nativeSession = nullptr;
+        std::shared_ptr<DiskReadCache> m_diskReadCache;
 
         bool m_deferredConfigureScheduled = false;
         bool m_IPFilteringConfigured = false;
@@ -685,6 +769,7 @@ namespace BitTorrent
         CachedSettingValue<int> m_checkingMemUsage;
         CachedSettingValue<int> m_diskCacheSize;
         CachedSettingValue<int> m_diskCacheTTL;
+        CachedSettingValue<int> m_readCacheSize;
         CachedSettingValue<bool> m_useOSCache;
         CachedSettingValue<bool> m_coalesceReadWriteEnabled;
         CachedSettingValue<bool> m_usePieceExtentAffinity;
@@ -739,6 +824,9 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isAltGlobalSpeedLimitEnabled;
         CachedSettingValue<bool> m_isBandwidthSchedulerEnabled;
         CachedSettingValue<int> m_saveResumeDataInterval;
+        CachedSettingValue<int> m_dormantTorrentTimeout;
+        CachedSettingValue<bool> m_isQuickRecheckEnabled;
+        CachedSettingValue<int> m_quickRecheckSpotCheckCount;
         CachedSettingValue<int> m_port;
         CachedSettingValue<bool> m_useRandomPort;
         CachedSettingValue<QString> m_networkInterface;
@@ -786,7 +874,11 @@ namespace BitTorrent
         bool m_refreshEnqueued = false;
         QTimer *m_seedingLimitTimer = nullptr;
         QTimer *m_resumeDataTimer = nullptr;
+        QTimer *m_dormancyTimer = nullptr;
         Statistics *m_statistics = nullptr;
+        TransferHistory *m_transferHistory = nullptr;
+        TrackerAnnounceCoordinator *m_announceCoordinator = nullptr;
+        QTimer *m_trackerRescheduleTimer = nullptr;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
         QPointer<BandwidthScheduler> m_bwScheduler;
@@ -796,10 +888,17 @@ namespace BitTorrent
         QThread *m_ioThread = nullptr;
         ResumeDataSavingManager *m_resumeDataSavingManager = nullptr;
         FileSearcher *m_fileSearcher = nullptr;
+        FileSizeCounter *m_fileSizeCounter = nullptr;
 
-        QSet<InfoHash> m_downloadedMetadata;
+        QHash<InfoHash, lt::torrent_handle> m_downloadedMetadata;
 
         QHash<InfoHash, TorrentImpl *> m_torrents;
+        // Dormant torrents keep their place in the queue, libtorrent's one with them inserted
+        QMap<int, InfoHash> m_dormantQueue;
+        QHash<InfoHash, int> m_dormantQueuePositions;
+        QHash<QString, QSet<InfoHash>> m_trackerIndex;
+        // trackers whose next announce must follow a change of their backoff, per torrent
+        QHash<InfoHash, QSet<QString>> m_pendingTrackerReschedules;
         QHash<InfoHash, LoadTorrentParams> m_loadingTorrents;
         QHash<QString, AddTorrentParams> m_downloadedTorrents;
         QHash<InfoHash, RemovingTorrentData> m_removingTorrents;
@@ -811,6 +910,9 @@ namespace BitTorrent
         QTimer *m_recentErroredTorrentsTimer = nullptr;
 
         SessionMetricIndices m_metricIndices;
+        QVector<SessionMetric> m_metrics;
+        QVector<qint64> m_metricValues;
+        QHash<QString, quint64> m_blockedPeerCounts;
         lt::time_point m_statsLastTimestamp = lt::clock_type::now();
 
         SessionStatus m_status;
@@ -818,7 +920,18 @@ namespace BitTorrent
 
         QNetworkConfigurationManager *m_networkManager = nullptr;
 
-        QList<MoveStorageJob> m_moveStorageQueue;
+        // Move jobs are grouped by the storage devices they read from and write to.
+        // Pending jobs are started in the order they were enqueued as soon as
+        // their devices have a free slot, so moves on unrelated devices run in parallel.
+        QHash<InfoHash, MoveStorageJob> m_activeMoveStorageJobs;
+        QHash<InfoHash, MoveStorageJob> m_pendingMoveStorageJobs;
+        QMap<quint64, InfoHash> m_moveStorageQueue; // <sequence, torrent hash>
+        quint64 m_moveStorageJobSequence = 0;
+        QHash<QPair<QString, QString>, QMap<quint64, InfoHash>> m_pendingMoveStorageJobsPerDevices; // <<source device, destination device>, queue>
+        QHash<QString, int> m_activeMoveStorageJobsPerDevice;
+        QHash<QString, QString> m_storageDeviceCache; // <path, device>
+        QElapsedTimer m_storageDeviceCacheTimer;
+        QTimer *m_moveStorageProgressTimer = nullptr;
 
         static Session *m_instance;
     };
@@ -71,5 +71,9 @@ namespace BitTorrent
         quint64 diskWriteQueue = 0;
         quint64 dhtNodes = 0;
         quint64 peersCount = 0;
+
+        // alerts fetched by the last read and all of them since the start
+        quint64 alertQueueDepth = 0;
+        quint64 alertsProcessed = 0;
     };
 }
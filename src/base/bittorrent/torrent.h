@@ -89,6 +89,22 @@ namespace BitTorrent
         int numPeers = 0;
     };
 
+    // Estimated heap usage of a torrent, in bytes
+    struct TorrentMemoryUsage
+    {
+        qint64 metadata = 0;
+        qint64 resumeData = 0;
+        qint64 status = 0;
+        qint64 trackers = 0;
+        qint64 tags = 0;
+        qint64 other = 0;
+
+        qint64 total() const
+        {
+            return metadata + resumeData + status + trackers + tags + other;
+        }
+    };
+
     uint qHash(TorrentState key, uint seed);
 
     class Torrent : public AbstractFileStorage
@@ -220,6 +236,8 @@ namespace BitTorrent
         virtual qlonglong seedingTime() const = 0;
         virtual qlonglong eta() const = 0;
         virtual QVector<qreal> filesProgress() const = 0;
+        // progress of the given files only, in the same order
+        virtual QVector<qreal> filesProgress(const QVector<int> &fileIndexes) const = 0;
         virtual int seedsCount() const = 0;
         virtual int peersCount() const = 0;
         virtual int leechsCount() const = 0;
@@ -261,10 +279,16 @@ namespace BitTorrent
          * that can be downloaded right now. It varies between 0 to 1.
          */
         virtual QVector<qreal> availableFileFractions() const = 0;
+        virtual QVector<qreal> availableFileFractions(const QVector<int> &fileIndexes) const = 0;
+        virtual TorrentMemoryUsage memoryUsage() const = 0;
 
         virtual void setName(const QString &name) = 0;
         virtual void setSequentialDownload(bool enable) = 0;
         virtual void setFirstLastPiecePriority(bool enabled) = 0;
+        // Requests the first missing pieces of the range, up to a short read-ahead window,
+        // to be downloaded before any other, in order. The window of the previous call
+        // for the same reader is dropped, the windows of the other readers are kept.
+        virtual void setPieceDeadlines(const QString &readerId, int firstPiece, int lastPiece) = 0;
         virtual void pause() = 0;
         virtual void resume(TorrentOperatingMode mode = TorrentOperatingMode::AutoManaged) = 0;
         virtual void move(QString path) = 0;
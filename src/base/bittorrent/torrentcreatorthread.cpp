@@ -28,6 +28,7 @@
 
 #include "torrentcreatorthread.h"
 
+#include <algorithm>
 #include <fstream>
 
 #include <libtorrent/bencode.hpp>
@@ -35,10 +36,14 @@
 #include <libtorrent/file_storage.hpp>
 #include <libtorrent/torrent_info.hpp>
 
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+#include <libtorrent/settings_pack.hpp>
+#endif
+
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
-#include <QHash>
+#include <QVector>
 
 #include "base/exceptions.h"
 #include "base/global.h"
@@ -95,7 +100,13 @@ void TorrentCreatorThread::create(const TorrentCreatorParams &params)
 
 void TorrentCreatorThread::sendProgressSignal(int currentPieceIdx, int totalPieces)
 {
-    emit updateProgress(static_cast<int>((currentPieceIdx * 100.) / totalPieces));
+    // pieces are hashed far faster than the receiver can handle one signal per piece
+    const int progress = static_cast<int>((currentPieceIdx * 100.) / totalPieces);
+    if (progress == m_lastProgress)
+        return;
+
+    m_lastProgress = progress;
+    emit updateProgress(progress);
 }
 
 void TorrentCreatorThread::run()
@@ -116,40 +127,40 @@ void TorrentCreatorThread::run()
         }
         else
         {
-            // need to sort the file names by natural sort order
-            QStringList dirs = {m_params.inputPath};
-
-            QDirIterator dirIter(m_params.inputPath, (QDir::AllDirs | QDir::NoDotAndDotDot), QDirIterator::Subdirectories);
-            while (dirIter.hasNext())
+            // need to sort the file names by natural sort order:
+            // folders first, then files within each folder
+            struct FileEntry
             {
-                dirIter.next();
-                dirs += dirIter.filePath();
-            }
-            std::sort(dirs.begin(), dirs.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
-
-            QStringList fileNames;
-            QHash<QString, qint64> fileSizeMap;
-
-            for (const auto &dir : asConst(dirs))
+                QString dirPath;
+                QString fileName;
+                qint64 size;
+            };
+            QVector<FileEntry> files;
+
+            QDirIterator fileIter(m_params.inputPath, QDir::Files, QDirIterator::Subdirectories);
+            while (fileIter.hasNext())
             {
-                QStringList tmpNames;  // natural sort files within each dir
+                fileIter.next();
 
-                QDirIterator fileIter(dir, QDir::Files);
-                while (fileIter.hasNext())
-                {
-                    fileIter.next();
+                const QFileInfo fileInfo = fileIter.fileInfo();
+                files.append({fileInfo.path(), fileInfo.fileName(), fileInfo.size()});
 
-                    const QString relFilePath = fileIter.filePath().mid(parentPath.length());
-                    tmpNames += relFilePath;
-                    fileSizeMap[relFilePath] = fileIter.fileInfo().size();
-                }
-
-                std::sort(tmpNames.begin(), tmpNames.end(), Utils::String::naturalLessThan<Qt::CaseInsensitive>);
-                fileNames += tmpNames;
+                if (isInterruptionRequested()) return;
             }
 
-            for (const auto &fileName : asConst(fileNames))
-                fs.add_file(fileName.toStdString(), fileSizeMap[fileName]);
+            std::sort(files.begin(), files.end(), [](const FileEntry &left, const FileEntry &right)
+            {
+                const int dirCmp = Utils::String::naturalCompare(left.dirPath, right.dirPath, Qt::CaseInsensitive);
+                if (dirCmp != 0)
+                    return (dirCmp < 0);
+                return (Utils::String::naturalCompare(left.fileName, right.fileName, Qt::CaseInsensitive) < 0);
+            });
+
+            for (const FileEntry &file : asConst(files))
+            {
+                const QString relFilePath = (file.dirPath + '/' + file.fileName).mid(parentPath.length());
+                fs.add_file(relFilePath.toStdString(), file.size);
+            }
         }
 
         if (isInterruptionRequested()) return;
@@ -181,11 +192,24 @@ void TorrentCreatorThread::run()
         if (isInterruptionRequested()) return;
 
         // calculate the hash for all pieces
-        lt::set_piece_hashes(newTorrent, Utils::Fs::toNativePath(parentPath).toStdString()
-            , [this, &newTorrent](const lt::piece_index_t n)
+        m_lastProgress = 0;
+        const auto progressHandler = [this, &newTorrent](const lt::piece_index_t n)
         {
             sendProgressSignal(static_cast<LTUnderlyingType<lt::piece_index_t>>(n), newTorrent.num_pieces());
-        });
+        };
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+        // libtorrent reads ahead and hashes pieces in parallel (SHA-1 and/or SHA-256 depending on format)
+        // but only uses a single hashing thread unless told otherwise
+        lt::settings_pack settings;
+        settings.set_int(lt::settings_pack::hashing_threads, m_params.hashingThreads);
+        settings.set_int(lt::settings_pack::aio_threads, std::max(m_params.hashingThreads, 4));
+        lt::error_code ec;
+        lt::set_piece_hashes(newTorrent, Utils::Fs::toNativePath(parentPath).toStdString(), settings, progressHandler, ec);
+        if (ec)
+            throw RuntimeError(QString::fromStdString(ec.message()));
+#else
+        lt::set_piece_hashes(newTorrent, Utils::Fs::toNativePath(parentPath).toStdString(), progressHandler);
+#endif
         // Set qBittorrent as creator and add user comment to
         // torrent_info structure
         newTorrent.set_creator(creatorStr.toUtf8().constData());
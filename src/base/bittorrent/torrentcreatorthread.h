@@ -60,6 +60,9 @@ namespace BitTorrent
         QString source;
         QStringList trackers;
         QStringList urlSeeds;
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+        int hashingThreads = QThread::idealThreadCount();
+#endif
     };
 
     class TorrentCreatorThread final : public QThread
@@ -91,5 +94,6 @@ namespace BitTorrent
         void sendProgressSignal(int currentPieceIdx, int totalPieces);
 
         TorrentCreatorParams m_params;
+        int m_lastProgress = 0;
     };
 }
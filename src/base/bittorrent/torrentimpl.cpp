@@ -31,7 +31,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <numeric>
 #include <type_traits>
+#include <utility>
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
@@ -44,6 +46,7 @@
 #include <libtorrent/session.hpp>
 #include <libtorrent/storage_defs.hpp>
 #include <libtorrent/time.hpp>
+#include <libtorrent/torrent_info.hpp>
 #include <libtorrent/version.hpp>
 #include <libtorrent/write_resume_data.hpp>
 
@@ -68,11 +71,28 @@
 #include "peerinfo.h"
 #include "session.h"
 #include "trackerentry.h"
+#include "trackerregistry.h"
 
 using namespace BitTorrent;
 
 namespace
 {
+    // Pieces after the read position of a streamed file that get a deadline
+    const int READ_AHEAD_PIECES = 8;
+    // The window of a reader that hasn't read for this long is dropped
+    const qint64 DEADLINE_WINDOW_TIMEOUT = 30000; // ms
+    const int MAX_DEADLINE_WINDOWS = 8;
+
+    // The scrape counts of the trackers are re-read from libtorrent at most this often
+    const int TRACKER_REFRESH_INTERVAL = 5000; // ms
+    // A local endpoint that hasn't announced for this long is considered gone
+    const qint64 TRACKER_ENDPOINT_EXPIRY = 2 * 60 * 60 * 1000; // 2 h
+
+    QString endpointKey(const lt::tcp::endpoint &endpoint)
+    {
+        return QString::fromStdString(endpoint.address().to_string()) + QLatin1Char(':') + QString::number(endpoint.port());
+    }
+
     std::vector<lt::download_priority_t> toLTDownloadPriorities(const QVector<DownloadPriority> &priorities)
     {
         std::vector<lt::download_priority_t> out;
@@ -96,6 +116,74 @@ namespace
             entryList.emplace_back(setValue.toStdString());
         return entryList;
     }
+
+    // Memory usage estimation helpers. They account for the heap allocations only,
+    // the size of the objects themselves is added by the caller.
+
+    // Approximate cost of a node in hash/tree based containers
+    const qint64 HASH_NODE_OVERHEAD = 2 * sizeof(void *) + sizeof(uint);
+
+    qint64 stringMemoryUsage(const std::string &str)
+    {
+        // short strings are stored in place
+        return (str.capacity() > 15) ? static_cast<qint64>(str.capacity() + 1) : 0;
+    }
+
+    qint64 stringMemoryUsage(const QString &str)
+    {
+        return static_cast<qint64>(str.capacity()) * sizeof(QChar);
+    }
+
+    template <typename Bitfield>
+    qint64 bitfieldMemoryUsage(const Bitfield &bitfield)
+    {
+        return (bitfield.size() + 7) / 8;
+    }
+
+    template <typename T>
+    qint64 vectorMemoryUsage(const std::vector<T> &vector)
+    {
+        return static_cast<qint64>(vector.capacity()) * sizeof(T);
+    }
+
+    qint64 estimateMemoryUsage(const lt::torrent_info &info)
+    {
+        const lt::file_storage &fileStorage = info.files();
+
+        // The info dictionary is kept as is, file entries refer into it
+        qint64 usage = sizeof(lt::torrent_info) + info.metadata_size()
+            + static_cast<qint64>(fileStorage.num_files()) * (8 * sizeof(void *));
+        for (const lt::announce_entry &tracker : info.trackers())
+            usage += sizeof(lt::announce_entry) + stringMemoryUsage(tracker.url);
+        for (const lt::web_seed_entry &webSeed : info.web_seeds())
+            usage += sizeof(lt::web_seed_entry) + stringMemoryUsage(webSeed.url);
+
+        return usage;
+    }
+
+    qint64 estimateMemoryUsage(const lt::add_torrent_params &params)
+    {
+        qint64 usage = sizeof(lt::add_torrent_params)
+            + stringMemoryUsage(params.name) + stringMemoryUsage(params.save_path)
+            + bitfieldMemoryUsage(params.have_pieces) + bitfieldMemoryUsage(params.verified_pieces)
+            + vectorMemoryUsage(params.file_priorities) + vectorMemoryUsage(params.piece_priorities)
+            + vectorMemoryUsage(params.peers) + vectorMemoryUsage(params.banned_peers)
+            + vectorMemoryUsage(params.trackers) + vectorMemoryUsage(params.tracker_tiers)
+            + vectorMemoryUsage(params.url_seeds) + vectorMemoryUsage(params.http_seeds);
+
+        for (const std::string &tracker : params.trackers)
+            usage += stringMemoryUsage(tracker);
+        for (const std::string &urlSeed : params.url_seeds)
+            usage += stringMemoryUsage(urlSeed);
+        for (const std::string &httpSeed : params.http_seeds)
+            usage += stringMemoryUsage(httpSeed);
+        for (const auto &renamedFile : params.renamed_files)
+            usage += sizeof(renamedFile) + HASH_NODE_OVERHEAD + stringMemoryUsage(renamedFile.second);
+        for (const auto &unfinishedPiece : params.unfinished_pieces)
+            usage += sizeof(unfinishedPiece) + HASH_NODE_OVERHEAD + bitfieldMemoryUsage(unfinishedPiece.second);
+
+        return usage;
+    }
 }
 
 // TorrentImpl
@@ -109,7 +197,6 @@ TorrentImpl::TorrentImpl(Session *session, lt::session *nativeSession
     , m_name(params.name)
     , m_savePath(Utils::Fs::toNativePath(params.savePath))
     , m_category(params.category)
-    , m_tags(params.tags)
     , m_ratioLimit(params.ratioLimit)
     , m_seedingTimeLimit(params.seedingTimeLimit)
     , m_operatingMode(params.forced ? TorrentOperatingMode::Forced : TorrentOperatingMode::AutoManaged)
@@ -118,22 +205,40 @@ TorrentImpl::TorrentImpl(Session *session, lt::session *nativeSession
     , m_hasFirstLastPiecePriority(params.firstLastPiecePriority)
     , m_useAutoTMM(params.savePath.isEmpty())
     , m_isStopped(params.paused)
+    , m_fileSnapshot(params.fileSnapshot)
     , m_ltAddTorrentParams(params.ltAddTorrentParams)
 {
     if (m_useAutoTMM)
         m_savePath = Utils::Fs::toNativePath(m_session->categorySavePath(m_category));
 
-    m_hash = InfoHash {m_nativeHandle.info_hash()};
-    if (m_ltAddTorrentParams.ti)
+    for (const QString &tag : asConst(params.tags))
+        m_tags.insert(m_session->internTag(tag));
+
+    if (isDormant())
     {
-        // Initialize it only if torrent is added with metadata.
-        // Otherwise it should be initialized in "Metadata received" handler.
-        m_torrentInfo = TorrentInfo {m_nativeHandle.torrent_file()};
+        // Dormant torrents are always restored with metadata
+        m_hash = InfoHash {m_ltAddTorrentParams.ti->info_hash()};
+        m_torrentInfo = TorrentInfo {m_ltAddTorrentParams.ti};
     }
+    else
+    {
+        m_hash = InfoHash {m_nativeHandle.info_hash()};
+        if (m_ltAddTorrentParams.ti)
+        {
+            // Initialize it only if torrent is added with metadata.
+            // Otherwise it should be initialized in "Metadata received" handler.
+            m_torrentInfo = TorrentInfo {m_nativeHandle.torrent_file()};
+        }
+    }
+
+    // Either libtorrent or m_torrentInfo holds the metadata now, don't keep another reference to it
+    m_ltAddTorrentParams.ti.reset();
 
+    m_idleTimer.start();
     updateStatus();
+    refreshTrackerEntries();
 
-    if (hasMetadata())
+    if (hasMetadata() && !isDormant())
         applyFirstLastPiecePriority(m_hasFirstLastPiecePriority);
 
     // TODO: Remove the following upgrade code in v.4.4
@@ -159,6 +264,9 @@ TorrentImpl::TorrentImpl(Session *session, lt::session *nativeSession
         }
     }
     // == END UPGRADE CODE ==
+
+    if (isDormant())
+        releaseMetadata();
 }
 
 TorrentImpl::~TorrentImpl() {}
@@ -168,6 +276,180 @@ bool TorrentImpl::isValid() const
     return m_nativeHandle.is_valid();
 }
 
+bool TorrentImpl::isDormant() const
+{
+    return !m_nativeHandle.is_valid();
+}
+
+bool TorrentImpl::attach()
+{
+    m_idleTimer.start();
+    if (!isDormant()) return true;
+
+    lt::add_torrent_params p = m_ltAddTorrentParams;
+    p.ti = metadata().nativeInfo();
+
+    const lt::torrent_handle nativeHandle = m_session->attachTorrent(this, p);
+    if (!nativeHandle.is_valid()) return false;
+
+    m_nativeHandle = nativeHandle;
+    m_isMetadataReleased = false;
+    updateStatus();
+    refreshTrackerEntries();
+    return true;
+}
+
+bool TorrentImpl::canBecomeDormant() const
+{
+    return !isDormant() && hasMetadata() && m_isStopped && !isChecking() && !hasError()
+        && (m_nativeStatus.flags & lt::torrent_flags::paused)
+        && !(m_nativeStatus.flags & lt::torrent_flags::auto_managed)
+        && !isMoveInProgress() && (m_renameCount == 0) && m_moveFinishedTriggers.isEmpty()
+        && (m_maintenanceJob == MaintenanceJob::None) && !m_hasMissingFiles;
+}
+
+qint64 TorrentImpl::idleTime() const
+{
+    return m_idleTimer.elapsed();
+}
+
+void TorrentImpl::requestDetach()
+{
+    if (!canBecomeDormant()) return;
+
+    // Detach only once the resume data reflects the latest state,
+    // since it is all that is left to restore the torrent from
+    m_detachRequested = true;
+    saveResumeData();
+}
+
+void TorrentImpl::detach()
+{
+    m_detachRequested = false;
+    if (!canBecomeDormant()) return;
+
+    m_session->detachTorrent(this);
+    m_nativeHandle = {};
+    m_speedMonitor.reset();
+    updateStatus();
+    releaseMetadata();
+
+    qDebug("Torrent \"%s\" became dormant", qUtf8Printable(name()));
+}
+
+void TorrentImpl::releaseMetadata()
+{
+    if (!isDormant() || !m_torrentInfo.isValid()) return;
+    // it can only be read back from the resume folder
+    if (!m_session->hasTorrentMetadataFile(m_hash)) return;
+
+    m_metadataSummary = {m_torrentInfo.name(), m_torrentInfo.creationDate(), m_torrentInfo.creator()
+        , m_torrentInfo.comment(), m_torrentInfo.filePath(0), m_torrentInfo.totalSize()
+        , m_torrentInfo.pieceLength(), m_torrentInfo.piecesCount(), m_torrentInfo.filesCount()
+        , m_torrentInfo.isPrivate(), m_torrentInfo.hasRootFolder()};
+    m_torrentInfo = {};
+    m_isMetadataReleased = true;
+}
+
+const TorrentInfo &TorrentImpl::metadata() const
+{
+    if (m_isMetadataReleased && !m_torrentInfo.isValid())
+    {
+        m_torrentInfo = m_session->loadTorrentMetadata(m_hash);
+        // the file has the original names
+        if (m_torrentInfo.isValid())
+        {
+            for (const auto &renamedFile : m_ltAddTorrentParams.renamed_files)
+                m_torrentInfo.nativeInfo()->rename_file(renamedFile.first, renamedFile.second);
+        }
+    }
+
+    return m_torrentInfo;
+}
+
+void TorrentImpl::updateDormantStatus()
+{
+    const std::shared_ptr<lt::torrent_info> nativeInfo = metadata().nativeInfo();
+    if (!nativeInfo) return;
+
+    const lt::add_torrent_params &p = m_ltAddTorrentParams;
+    const lt::file_storage &fileStorage = nativeInfo->files();
+    const int pieceCount = fileStorage.num_pieces();
+    const int haveCount = std::min(p.have_pieces.size(), pieceCount);
+
+    const auto isWantedFile = [&p](const lt::file_index_t index)
+    {
+        const int i = static_cast<LTUnderlyingType<lt::file_index_t>>(index);
+        return (i >= static_cast<int>(p.file_priorities.size()))
+            || (p.file_priorities[i] != lt::dont_download);
+    };
+
+    qint64 totalWanted = 0;
+    for (const lt::file_index_t index : fileStorage.file_range())
+    {
+        if (isWantedFile(index))
+            totalWanted += fileStorage.file_size(index);
+    }
+
+    qint64 totalDone = 0;
+    qint64 totalWantedDone = 0;
+    int numPieces = 0;
+    for (int i = 0; i < haveCount; ++i)
+    {
+        const lt::piece_index_t pieceIndex {i};
+        if (!p.have_pieces[pieceIndex]) continue;
+
+        const int pieceSize = fileStorage.piece_size(pieceIndex);
+        ++numPieces;
+        totalDone += pieceSize;
+
+        if (totalWanted == fileStorage.total_size())
+        {
+            totalWantedDone += pieceSize;
+            continue;
+        }
+
+        for (const lt::file_slice &slice : fileStorage.map_block(pieceIndex, 0, pieceSize))
+        {
+            if (isWantedFile(slice.file_index))
+                totalWantedDone += slice.size;
+        }
+    }
+
+    lt::torrent_status status;
+    status.name = p.name;
+    status.save_path = p.save_path;
+    status.flags = p.flags;
+    status.has_metadata = true;
+    status.pieces = p.have_pieces;
+    status.pieces.resize(pieceCount, false);
+    status.num_pieces = numPieces;
+    status.total_done = totalDone;
+    status.total_wanted = totalWanted;
+    status.total_wanted_done = totalWantedDone;
+    status.is_finished = (totalWantedDone >= totalWanted);
+    status.is_seeding = (numPieces == pieceCount);
+    status.state = status.is_seeding ? lt::torrent_status::seeding
+        : (status.is_finished ? lt::torrent_status::finished : lt::torrent_status::downloading);
+    status.progress = (totalWanted > 0) ? (static_cast<float>(totalWantedDone) / totalWanted) : 1.f;
+    status.progress_ppm = static_cast<int>(status.progress * 1000000);
+    status.all_time_upload = p.total_uploaded;
+    status.all_time_download = p.total_downloaded;
+    status.active_duration = std::chrono::seconds {p.active_time};
+    status.finished_duration = std::chrono::seconds {p.finished_time};
+    status.seeding_duration = std::chrono::seconds {p.seeding_time};
+    status.added_time = p.added_time;
+    status.completed_time = p.completed_time;
+    status.last_seen_complete = p.last_seen_complete;
+    status.num_complete = p.num_complete;
+    status.num_incomplete = p.num_incomplete;
+    status.queue_position = lt::queue_position_t {-1};
+    status.need_save_resume = false;
+
+    m_nativeStatus = status;
+    updateState();
+}
+
 InfoHash TorrentImpl::hash() const
 {
     return m_hash;
@@ -178,6 +460,9 @@ QString TorrentImpl::name() const
     if (!m_name.isEmpty())
         return m_name;
 
+    if (m_isMetadataReleased)
+        return m_metadataSummary.name;
+
     if (hasMetadata())
         return m_torrentInfo.name();
 
@@ -190,27 +475,27 @@ QString TorrentImpl::name() const
 
 QDateTime TorrentImpl::creationDate() const
 {
-    return m_torrentInfo.creationDate();
+    return m_isMetadataReleased ? m_metadataSummary.creationDate : m_torrentInfo.creationDate();
 }
 
 QString TorrentImpl::creator() const
 {
-    return m_torrentInfo.creator();
+    return m_isMetadataReleased ? m_metadataSummary.creator : m_torrentInfo.creator();
 }
 
 QString TorrentImpl::comment() const
 {
-    return m_torrentInfo.comment();
+    return m_isMetadataReleased ? m_metadataSummary.comment : m_torrentInfo.comment();
 }
 
 bool TorrentImpl::isPrivate() const
 {
-    return m_torrentInfo.isPrivate();
+    return m_isMetadataReleased ? m_metadataSummary.isPrivate : m_torrentInfo.isPrivate();
 }
 
 qlonglong TorrentImpl::totalSize() const
 {
-    return m_torrentInfo.totalSize();
+    return m_isMetadataReleased ? m_metadataSummary.totalSize : m_torrentInfo.totalSize();
 }
 
 // size without the "don't download" files
@@ -226,7 +511,7 @@ qlonglong TorrentImpl::completedSize() const
 
 qlonglong TorrentImpl::pieceLength() const
 {
-    return m_torrentInfo.pieceLength();
+    return m_isMetadataReleased ? m_metadataSummary.pieceLength : m_torrentInfo.pieceLength();
 }
 
 qlonglong TorrentImpl::wastedSize() const
@@ -252,7 +537,7 @@ QString TorrentImpl::rootPath(bool actual) const
     if (!hasMetadata())
         return {};
 
-    const QString firstFilePath = filePath(0);
+    const QString firstFilePath = m_isMetadataReleased ? m_metadataSummary.firstFilePath : filePath(0);
     const int slashIndex = firstFilePath.indexOf('/');
     if (slashIndex >= 0)
         return QDir(savePath(actual)).absoluteFilePath(firstFilePath.left(slashIndex));
@@ -265,6 +550,13 @@ QString TorrentImpl::contentPath(const bool actual) const
     if (!hasMetadata())
         return {};
 
+    if (m_isMetadataReleased)
+    {
+        if (m_metadataSummary.filesCount == 1)
+            return QDir(savePath(actual)).absoluteFilePath(m_metadataSummary.firstFilePath);
+        return m_metadataSummary.hasRootFolder ? rootPath(actual) : savePath(actual);
+    }
+
     if (filesCount() == 1)
         return QDir(savePath(actual)).absoluteFilePath(filePath(0));
 
@@ -297,6 +589,8 @@ QString TorrentImpl::actualStorageLocation() const
 
 void TorrentImpl::setAutoManaged(const bool enable)
 {
+    if (isDormant()) return;
+
     if (enable)
         m_nativeHandle.set_flags(lt::torrent_flags::auto_managed);
     else
@@ -305,26 +599,143 @@ void TorrentImpl::setAutoManaged(const bool enable)
 
 QVector<TrackerEntry> TorrentImpl::trackers() const
 {
+    if (m_trackerEntriesOutdated
+        && (!m_trackerEntriesRefreshTimer.isValid() || m_trackerEntriesRefreshTimer.hasExpired(TRACKER_REFRESH_INTERVAL)))
+    {
+        refreshTrackerEntries();
+    }
+
+    return m_trackerEntries;
+}
+
+void TorrentImpl::refreshTrackerEntries() const
+{
+    if (isDormant())
+    {
+        const lt::add_torrent_params &p = m_ltAddTorrentParams;
+
+        m_trackerEntries.clear();
+        m_trackerEntries.reserve(static_cast<int>(p.trackers.size()));
+        for (std::size_t i = 0; i < p.trackers.size(); ++i)
+        {
+            TrackerEntry entry {QString::fromStdString(p.trackers[i])};
+            entry.setTier((i < p.tracker_tiers.size()) ? p.tracker_tiers[i] : 0);
+            m_trackerEntries << entry;
+        }
+
+        m_trackerEntriesOutdated = false;
+        return;
+    }
+
     const std::vector<lt::announce_entry> nativeTrackers = m_nativeHandle.trackers();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
 
-    QVector<TrackerEntry> entries;
-    entries.reserve(nativeTrackers.size());
+    m_trackerEntries.clear();
+    m_trackerEntries.reserve(static_cast<int>(nativeTrackers.size()));
 
+    QHash<TrackerID, TrackerEndpoints> trackerEndpoints;
     for (const lt::announce_entry &tracker : nativeTrackers)
-        entries << tracker;
+    {
+        m_trackerEntries << tracker;
 
-    return entries;
+        // libtorrent knows which endpoints are still in use, the alerts only tell which ones were
+        const TrackerID id = TrackerRegistry::id(QString::fromStdString(tracker.url));
+        const TrackerEndpoints oldEndpoints = m_trackerEndpoints.value(id);
+        TrackerEndpoints &endpoints = trackerEndpoints[id];
+        for (const lt::announce_endpoint &nativeEndpoint : tracker.endpoints)
+        {
+            const QString endpoint = endpointKey(nativeEndpoint.local_endpoint);
+            endpoints.lastSeen[endpoint] = now;
+            if (oldEndpoints.failed.contains(endpoint))
+                endpoints.failed.insert(endpoint);
+        }
+    }
+    m_trackerEndpoints = trackerEndpoints;
+
+    m_trackerEntriesOutdated = false;
+    m_trackerOrderOutdated = false;
+    m_trackerEntriesRefreshTimer.start();
+}
+
+TrackerEntry *TorrentImpl::findTrackerEntry(const QString &url)
+{
+    const auto iter = std::find_if(m_trackerEntries.begin(), m_trackerEntries.end(), [&url](const TrackerEntry &entry)
+    {
+        return (entry.url() == url);
+    });
+    return (iter != m_trackerEntries.end()) ? &*iter : nullptr;
+}
+
+bool TorrentImpl::updateTrackerEndpoint(const TrackerID id, const lt::tcp::endpoint &endpoint, const bool failed)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    TrackerEndpoints &endpoints = m_trackerEndpoints[id];
+
+    const QString key = endpointKey(endpoint);
+    endpoints.lastSeen[key] = now;
+    if (failed)
+        endpoints.failed.insert(key);
+    else
+        endpoints.failed.remove(key);
+
+    // Endpoints of interfaces that went away don't announce anymore and mustn't hide the failure of the others
+    for (auto iter = endpoints.lastSeen.begin(); iter != endpoints.lastSeen.end();)
+    {
+        if ((now - iter.value()) > TRACKER_ENDPOINT_EXPIRY)
+        {
+            endpoints.failed.remove(iter.key());
+            iter = endpoints.lastSeen.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    return (endpoints.failed.size() >= endpoints.lastSeen.size());
 }
 
 QHash<QString, TrackerInfo> TorrentImpl::trackerInfos() const
 {
-    return m_trackerInfos;
+    QHash<QString, TrackerInfo> trackerInfos;
+    trackerInfos.reserve(m_trackerInfos.size());
+    for (auto i = m_trackerInfos.cbegin(); i != m_trackerInfos.cend(); ++i)
+        trackerInfos.insert(TrackerRegistry::url(i.key()), i.value());
+
+    return trackerInfos;
+}
+
+int TorrentImpl::nativeTrackerIndex(const QString &url) const
+{
+    // libtorrent sorts the trackers it is given, only a fresh copy has their actual positions
+    if (m_trackerOrderOutdated && !isDormant())
+        refreshTrackerEntries();
+
+    for (int i = 0; i < m_trackerEntries.size(); ++i)
+    {
+        if (m_trackerEntries[i].url() == url)
+            return i;
+    }
+    return -1;
+}
+
+void TorrentImpl::rescheduleTrackerAnnounce(const QString &url, const int delay)
+{
+    if (isDormant())
+        return;
+
+    const int index = nativeTrackerIndex(url);
+    if (index >= 0)
+        m_nativeHandle.force_reannounce(delay, index, lt::torrent_handle::ignore_min_interval);
 }
 
 void TorrentImpl::addTrackers(const QVector<TrackerEntry> &trackers)
 {
+    if (!attach()) return;
+
     QSet<TrackerEntry> currentTrackers;
-    for (const lt::announce_entry &entry : m_nativeHandle.trackers())
+    currentTrackers.reserve(m_trackerEntries.size());
+    for (const TrackerEntry &entry : asConst(m_trackerEntries))
         currentTrackers << entry;
 
     QVector<TrackerEntry> newTrackers;
@@ -335,17 +746,27 @@ void TorrentImpl::addTrackers(const QVector<TrackerEntry> &trackers)
         if (!currentTrackers.contains(tracker))
         {
             m_nativeHandle.add_tracker(tracker.nativeEntry());
+            currentTrackers << tracker;
             newTrackers << tracker;
         }
     }
 
     if (!newTrackers.isEmpty())
+    {
+        // libtorrent keeps the list ordered by tier so the actual position
+        // of the new entries is only known after re-reading it
+        m_trackerEntries << newTrackers;
+        m_trackerEntriesOutdated = true;
+        m_trackerOrderOutdated = true;
         m_session->handleTorrentTrackersAdded(this, newTrackers);
+    }
 }
 
 void TorrentImpl::replaceTrackers(const QVector<TrackerEntry> &trackers)
 {
-    QVector<TrackerEntry> currentTrackers = this->trackers();
+    if (!attach()) return;
+
+    QVector<TrackerEntry> currentTrackers = m_trackerEntries;
 
     QVector<TrackerEntry> newTrackers;
     newTrackers.reserve(trackers.size());
@@ -362,6 +783,17 @@ void TorrentImpl::replaceTrackers(const QVector<TrackerEntry> &trackers)
     }
 
     m_nativeHandle.replace_trackers(nativeTrackers);
+    m_trackerEntries = trackers;
+    m_trackerEntriesOutdated = true;
+    m_trackerOrderOutdated = true;
+    m_trackerEndpoints.clear();
+    for (const TrackerEntry &tracker : asConst(currentTrackers))
+    {
+        const bool isKept = std::any_of(trackers.cbegin(), trackers.cend()
+            , [&tracker](const TrackerEntry &entry) { return (entry.url() == tracker.url()); });
+        if (!isKept)
+            m_trackerInfos.remove(TrackerRegistry::id(tracker.url()));
+    }
 
     if (newTrackers.isEmpty() && currentTrackers.isEmpty())
     {
@@ -385,7 +817,9 @@ void TorrentImpl::replaceTrackers(const QVector<TrackerEntry> &trackers)
 
 QVector<QUrl> TorrentImpl::urlSeeds() const
 {
-    const std::set<std::string> currentSeeds = m_nativeHandle.url_seeds();
+    const std::set<std::string> currentSeeds = isDormant()
+        ? std::set<std::string> {m_ltAddTorrentParams.url_seeds.cbegin(), m_ltAddTorrentParams.url_seeds.cend()}
+        : m_nativeHandle.url_seeds();
 
     QVector<QUrl> urlSeeds;
     urlSeeds.reserve(currentSeeds.size());
@@ -398,6 +832,8 @@ QVector<QUrl> TorrentImpl::urlSeeds() const
 
 void TorrentImpl::addUrlSeeds(const QVector<QUrl> &urlSeeds)
 {
+    if (!attach()) return;
+
     const std::set<std::string> currentSeeds = m_nativeHandle.url_seeds();
 
     QVector<QUrl> addedUrlSeeds;
@@ -419,6 +855,8 @@ void TorrentImpl::addUrlSeeds(const QVector<QUrl> &urlSeeds)
 
 void TorrentImpl::removeUrlSeeds(const QVector<QUrl> &urlSeeds)
 {
+    if (!attach()) return;
+
     const std::set<std::string> currentSeeds = m_nativeHandle.url_seeds();
 
     QVector<QUrl> removedUrlSeeds;
@@ -440,11 +878,15 @@ void TorrentImpl::removeUrlSeeds(const QVector<QUrl> &urlSeeds)
 
 void TorrentImpl::clearPeers()
 {
+    if (isDormant()) return;
+
     m_nativeHandle.clear_peers();
 }
 
 bool TorrentImpl::connectPeer(const PeerAddress &peerAddress)
 {
+    if (!attach()) return false;
+
     lt::error_code ec;
     const lt::address addr = lt::make_address(peerAddress.ip.toString().toStdString(), ec);
     if (ec) return false;
@@ -472,20 +914,37 @@ bool TorrentImpl::needSaveResumeData() const
     return m_nativeStatus.need_save_resume;
 }
 
-void TorrentImpl::saveResumeData()
+void TorrentImpl::saveResumeData(const bool flushDiskCache)
 {
-    m_nativeHandle.save_resume_data();
     m_session->handleTorrentSaveResumeDataRequested(this);
+
+    // Nothing can change in libtorrent while the torrent is dormant
+    // so the recent resume data only needs our own fields updated.
+    // The file snapshot taken along with the resume data must include
+    // everything it claims, so flush the cache first when it is used.
+    if (isDormant())
+    {
+        prepareResumeData();
+    }
+    else if (flushDiskCache && m_session->isQuickRecheckEnabled())
+    {
+        m_isResumeDataFlushRequested = true;
+        m_nativeHandle.save_resume_data(lt::torrent_handle::flush_disk_cache);
+    }
+    else
+    {
+        m_nativeHandle.save_resume_data();
+    }
 }
 
 int TorrentImpl::filesCount() const
 {
-    return m_torrentInfo.filesCount();
+    return m_isMetadataReleased ? m_metadataSummary.filesCount : m_torrentInfo.filesCount();
 }
 
 int TorrentImpl::piecesCount() const
 {
-    return m_torrentInfo.piecesCount();
+    return m_isMetadataReleased ? m_metadataSummary.piecesCount : m_torrentInfo.piecesCount();
 }
 
 int TorrentImpl::piecesHave() const
@@ -547,7 +1006,7 @@ bool TorrentImpl::addTag(const QString &tag)
         if (!m_session->hasTag(tag))
             if (!m_session->addTag(tag))
                 return false;
-        m_tags.insert(tag);
+        m_tags.insert(m_session->internTag(tag));
         m_session->handleTorrentTagAdded(this, tag);
         return true;
     }
@@ -587,7 +1046,7 @@ int TorrentImpl::seedingTimeLimit() const
 
 QString TorrentImpl::filePath(int index) const
 {
-    return m_torrentInfo.filePath(index);
+    return metadata().filePath(index);
 }
 
 QString TorrentImpl::fileName(int index) const
@@ -598,7 +1057,7 @@ QString TorrentImpl::fileName(int index) const
 
 qlonglong TorrentImpl::fileSize(int index) const
 {
-    return m_torrentInfo.fileSize(index);
+    return metadata().fileSize(index);
 }
 
 // Return a list of absolute paths corresponding
@@ -616,7 +1075,16 @@ QStringList TorrentImpl::absoluteFilePaths() const
 
 QVector<DownloadPriority> TorrentImpl::filePriorities() const
 {
-    const std::vector<lt::download_priority_t> fp = m_nativeHandle.get_file_priorities();
+    std::vector<lt::download_priority_t> fp;
+    if (isDormant())
+    {
+        fp = m_ltAddTorrentParams.file_priorities;
+        fp.resize(filesCount(), lt::default_priority);
+    }
+    else
+    {
+        fp = m_nativeHandle.get_file_priorities();
+    }
 
     QVector<DownloadPriority> ret;
     std::transform(fp.cbegin(), fp.cend(), std::back_inserter(ret), [](lt::download_priority_t priority)
@@ -628,7 +1096,7 @@ QVector<DownloadPriority> TorrentImpl::filePriorities() const
 
 TorrentInfo TorrentImpl::info() const
 {
-    return m_torrentInfo;
+    return metadata();
 }
 
 bool TorrentImpl::isPaused() const
@@ -647,7 +1115,8 @@ bool TorrentImpl::isQueued() const
 bool TorrentImpl::isChecking() const
 {
     return ((m_nativeStatus.state == lt::torrent_status::checking_files)
-            || (m_nativeStatus.state == lt::torrent_status::checking_resume_data));
+            || (m_nativeStatus.state == lt::torrent_status::checking_resume_data)
+            || (m_maintenanceJob == MaintenanceJob::VerifyFiles));
 }
 
 bool TorrentImpl::isDownloading() const
@@ -757,9 +1226,10 @@ void TorrentImpl::updateState()
         else
             m_state = TorrentState::DownloadingMetadata;
     }
-    else if ((m_nativeStatus.state == lt::torrent_status::checking_files)
-             && (!isPaused() || (m_nativeStatus.flags & lt::torrent_flags::auto_managed)
-                 || !(m_nativeStatus.flags & lt::torrent_flags::paused)))
+    else if ((m_maintenanceJob == MaintenanceJob::VerifyFiles)
+             || ((m_nativeStatus.state == lt::torrent_status::checking_files)
+                 && (!isPaused() || (m_nativeStatus.flags & lt::torrent_flags::auto_managed)
+                     || !(m_nativeStatus.flags & lt::torrent_flags::paused))))
     {
         // If the torrent is not just in the "checking" state, but is being actually checked
         m_state = m_hasSeedStatus ? TorrentState::CheckingUploading : TorrentState::CheckingDownloading;
@@ -796,7 +1266,7 @@ void TorrentImpl::updateState()
 
 bool TorrentImpl::hasMetadata() const
 {
-    return m_torrentInfo.isValid();
+    return m_isMetadataReleased || m_torrentInfo.isValid();
 }
 
 bool TorrentImpl::hasMissingFiles() const
@@ -811,7 +1281,9 @@ bool TorrentImpl::hasError() const
 
 bool TorrentImpl::hasFilteredPieces() const
 {
-    const std::vector<lt::download_priority_t> pp = m_nativeHandle.get_piece_priorities();
+    const std::vector<lt::download_priority_t> pp = isDormant()
+        ? std::vector<lt::download_priority_t> {m_ltAddTorrentParams.piece_priorities.cbegin(), m_ltAddTorrentParams.piece_priorities.cend()}
+        : m_nativeHandle.get_piece_priorities();
     return std::any_of(pp.cbegin(), pp.cend(), [](const lt::download_priority_t priority)
     {
         return (priority == lt::download_priority_t {0});
@@ -820,9 +1292,11 @@ bool TorrentImpl::hasFilteredPieces() const
 
 int TorrentImpl::queuePosition() const
 {
-    if (m_nativeStatus.queue_position < lt::queue_position_t {0}) return 0;
-
-    return static_cast<int>(m_nativeStatus.queue_position) + 1;
+    // Dormant torrents are counted in, they are put back at their place when attached
+    const int position = isDormant()
+        ? m_session->dormantQueuePosition(m_hash)
+        : m_session->queuePositionOf(m_nativeStatus.queue_position);
+    return position + 1;
 }
 
 QString TorrentImpl::error() const
@@ -902,7 +1376,29 @@ QVector<qreal> TorrentImpl::filesProgress() const
         return {};
 
     std::vector<int64_t> fp;
-    m_nativeHandle.file_progress(fp, lt::torrent_handle::piece_granularity);
+    if (isDormant())
+    {
+        const std::shared_ptr<lt::torrent_info> nativeInfo = metadata().nativeInfo();
+        if (!nativeInfo)
+            return {};
+
+        const lt::file_storage &fileStorage = nativeInfo->files();
+        const lt::typed_bitfield<lt::piece_index_t> &havePieces = m_ltAddTorrentParams.have_pieces;
+
+        fp.resize(fileStorage.num_files(), 0);
+        for (int i = 0; i < std::min(havePieces.size(), fileStorage.num_pieces()); ++i)
+        {
+            const lt::piece_index_t pieceIndex {i};
+            if (!havePieces[pieceIndex]) continue;
+
+            for (const lt::file_slice &slice : fileStorage.map_block(pieceIndex, 0, fileStorage.piece_size(pieceIndex)))
+                fp[static_cast<LTUnderlyingType<lt::file_index_t>>(slice.file_index)] += slice.size;
+        }
+    }
+    else
+    {
+        m_nativeHandle.file_progress(fp, lt::torrent_handle::piece_granularity);
+    }
 
     const int count = static_cast<int>(fp.size());
     QVector<qreal> result;
@@ -919,6 +1415,49 @@ QVector<qreal> TorrentImpl::filesProgress() const
     return result;
 }
 
+QVector<qreal> TorrentImpl::filesProgress(const QVector<int> &fileIndexes) const
+{
+    if (!hasMetadata())
+        return {};
+
+    const TorrentInfo info = this->info();
+    if (!info.isValid())
+        return QVector<qreal>(fileIndexes.size(), 0);
+
+    // Only the pieces of the requested files are looked at, unlike file_progress()
+    const lt::typed_bitfield<lt::piece_index_t> &havePieces = isDormant()
+        ? m_ltAddTorrentParams.have_pieces : m_nativeStatus.pieces;
+    // libtorrent doesn't report the pieces of seeding torrents
+    const bool haveAllPieces = havePieces.empty() && !isDormant() && m_nativeStatus.is_seeding;
+    const qlonglong pieceLength = info.pieceLength();
+
+    QVector<qreal> result;
+    result.reserve(fileIndexes.size());
+    for (const int index : fileIndexes)
+    {
+        const qlonglong size = fileSize(index);
+        const qlonglong fileBegin = info.fileOffset(index);
+        const qlonglong fileEnd = fileBegin + size;
+
+        qlonglong doneSize = 0;
+        for (const int piece : info.filePieces(index))
+        {
+            if (!haveAllPieces && ((piece >= havePieces.size()) || !havePieces[lt::piece_index_t {piece}]))
+                continue;
+
+            const qlonglong pieceBegin = piece * pieceLength;
+            const qlonglong pieceEnd = pieceBegin + info.pieceLength(piece);
+            doneSize += std::min(pieceEnd, fileEnd) - std::max(pieceBegin, fileBegin);
+        }
+
+        if ((size <= 0) || (doneSize == size))
+            result << 1;
+        else
+            result << (doneSize / static_cast<qreal>(size));
+    }
+    return result;
+}
+
 int TorrentImpl::seedsCount() const
 {
     return m_nativeStatus.num_seeds;
@@ -1003,12 +1542,12 @@ qlonglong TorrentImpl::timeSinceActivity() const
 
 int TorrentImpl::downloadLimit() const
 {
-    return m_nativeHandle.download_limit();
+    return isDormant() ? m_ltAddTorrentParams.download_limit : m_nativeHandle.download_limit();
 }
 
 int TorrentImpl::uploadLimit() const
 {
-    return m_nativeHandle.upload_limit();
+    return isDormant() ? m_ltAddTorrentParams.upload_limit : m_nativeHandle.upload_limit();
 }
 
 bool TorrentImpl::superSeeding() const
@@ -1033,6 +1572,9 @@ bool TorrentImpl::isLSDDisabled() const
 
 QVector<PeerInfo> TorrentImpl::peers() const
 {
+    if (isDormant())
+        return {};
+
     std::vector<lt::peer_info> nativePeers;
     m_nativeHandle.get_peer_info(nativePeers);
 
@@ -1057,6 +1599,8 @@ QBitArray TorrentImpl::pieces() const
 QBitArray TorrentImpl::downloadingPieces() const
 {
     QBitArray result(piecesCount());
+    if (isDormant())
+        return result;
 
     std::vector<lt::partial_piece_info> queue;
     m_nativeHandle.get_download_queue(queue);
@@ -1069,6 +1613,9 @@ QBitArray TorrentImpl::downloadingPieces() const
 
 QVector<int> TorrentImpl::pieceAvailability() const
 {
+    if (isDormant())
+        return {};
+
     std::vector<int> avail;
     m_nativeHandle.piece_availability(avail);
 
@@ -1199,6 +1746,7 @@ void TorrentImpl::move(QString path)
 void TorrentImpl::move_impl(QString path, const MoveStorageMode mode)
 {
     if (path == savePath()) return;
+    if (!attach()) return;
     path = Utils::Fs::toNativePath(path);
 
     if (!useTempPath())
@@ -1214,17 +1762,30 @@ void TorrentImpl::move_impl(QString path, const MoveStorageMode mode)
 
 void TorrentImpl::forceReannounce(int index)
 {
+    if (isDormant()) return;
+
     m_nativeHandle.force_reannounce(0, index);
 }
 
 void TorrentImpl::forceDHTAnnounce()
 {
+    if (isDormant()) return;
+
     m_nativeHandle.force_dht_announce();
 }
 
 void TorrentImpl::forceRecheck()
 {
     if (!hasMetadata()) return;
+    if (m_maintenanceJob == MaintenanceJob::VerifyFiles) return;
+    if (!attach()) return;
+
+    if (m_session->isQuickRecheckEnabled() && (m_fileSnapshot.size() == filesCount())
+        && ResumeDataVerifier::isSupported(*m_torrentInfo.nativeInfo()))
+    {
+        quickRecheck();
+        return;
+    }
 
     m_nativeHandle.force_recheck();
     m_hasMissingFiles = false;
@@ -1238,19 +1799,64 @@ void TorrentImpl::forceRecheck()
     }
 }
 
-void TorrentImpl::setSequentialDownload(const bool enable)
+void TorrentImpl::quickRecheck()
 {
-    if (enable)
-    {
-        m_nativeHandle.set_flags(lt::torrent_flags::sequential_download);
-        m_nativeStatus.flags |= lt::torrent_flags::sequential_download;  // prevent return cached value
-    }
-    else
+    lt::torrent_status status = m_nativeHandle.status(lt::torrent_handle::query_pieces);
+    if (status.is_seeding && status.pieces.empty())
+        status.pieces.resize(piecesCount(), true);
+
+    // Keep libtorrent off the files while they are being verified.
+    // The torrent is added back with the resulting piece state afterwards.
+    m_nativeHandle.unset_flags(lt::torrent_flags::auto_managed);
+    m_nativeHandle.pause();
+
+    m_maintenanceJob = MaintenanceJob::VerifyFiles;
+    m_resumeDataVerifier = new ResumeDataVerifier {*m_torrentInfo.nativeInfo(), actualStorageLocation()
+            , m_fileSnapshot, status.pieces, m_session->quickRecheckSpotCheckCount(), this};
+    connect(m_resumeDataVerifier, &QThread::finished, this, &TorrentImpl::handleQuickRecheckFinished);
+    m_resumeDataVerifier->start(QThread::LowPriority);
+
+    updateStatus();
+}
+
+void TorrentImpl::handleQuickRecheckFinished()
+{
+    ResumeDataVerifier *verifier = std::exchange(m_resumeDataVerifier, nullptr);
+    verifier->deleteLater();
+    m_maintenanceJob = MaintenanceJob::None;
+
+    if (!verifier->isSucceeded())
     {
-        m_nativeHandle.unset_flags(lt::torrent_flags::sequential_download);
-        m_nativeStatus.flags &= ~lt::torrent_flags::sequential_download;  // prevent return cached value
+        LogMsg(tr("Quick recheck of \"%1\" found corrupted data in unchanged files. Checking all files...").arg(name())
+            , Log::WARNING);
+        m_fileSnapshot.clear();
+        if (!m_isStopped)
+        {
+            setAutoManaged(m_operatingMode == TorrentOperatingMode::AutoManaged);
+            if (m_operatingMode == TorrentOperatingMode::Forced)
+                m_nativeHandle.resume();
+        }
+        forceRecheck();
+        return;
     }
 
+    LogMsg(tr("Quick recheck of \"%1\" finished. Hashed pieces: %2 of %3.")
+        .arg(name(), QString::number(verifier->hashedPiecesCount()), QString::number(piecesCount())));
+
+    m_ltAddTorrentParams.have_pieces = verifier->verifiedPieces();
+    m_ltAddTorrentParams.verified_pieces = {};
+    m_ltAddTorrentParams.unfinished_pieces.clear();
+    m_hasMissingFiles = false;
+    m_unchecked = false;
+
+    reload();
+    updateStatus();
+    saveResumeData();
+}
+
+void TorrentImpl::setSequentialDownload(const bool enable)
+{
+    setNativeFlag(lt::torrent_flags::sequential_download, enable);
     saveResumeData();
 }
 
@@ -1261,7 +1867,10 @@ void TorrentImpl::setFirstLastPiecePriority(const bool enabled)
 
     m_hasFirstLastPiecePriority = enabled;
     if (hasMetadata())
+    {
+        if (!attach()) return;
         applyFirstLastPiecePriority(enabled);
+    }
 
     LogMsg(tr("Download first and last piece first: %1, torrent: '%2'")
         .arg((enabled ? tr("On") : tr("Off")), name()));
@@ -1269,6 +1878,85 @@ void TorrentImpl::setFirstLastPiecePriority(const bool enabled)
     saveResumeData();
 }
 
+void TorrentImpl::setPieceDeadlines(const QString &readerId, const int firstPiece, const int lastPiece)
+{
+    if (!hasMetadata())
+        return;
+
+    if (!attach()) return;
+
+    const lt::typed_bitfield<lt::piece_index_t> &havePieces = m_nativeStatus.pieces;
+    const auto isMissing = [&havePieces](const int index)
+    {
+        return havePieces.empty() || !havePieces[lt::piece_index_t {index}];
+    };
+
+    int first = qMax(0, firstPiece);
+    const int end = qMin(lastPiece, (piecesCount() - 1));
+    while ((first <= end) && !isMissing(first))
+        ++first;
+    const int last = qMin(end, (first + READ_AHEAD_PIECES - 1));
+
+    // Forget the readers that went away, and the least recently active one
+    // when there are too many of them
+    QVector<QPair<int, int>> droppedWindows;
+    for (auto iter = m_deadlineWindows.begin(); iter != m_deadlineWindows.end();)
+    {
+        if ((iter.key() != readerId) && iter->idleTimer.hasExpired(DEADLINE_WINDOW_TIMEOUT))
+        {
+            droppedWindows.append({iter->first, iter->last});
+            iter = m_deadlineWindows.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    if (!m_deadlineWindows.contains(readerId) && (m_deadlineWindows.size() >= MAX_DEADLINE_WINDOWS))
+    {
+        const auto oldestIter = std::max_element(m_deadlineWindows.begin(), m_deadlineWindows.end()
+            , [](const PieceDeadlineWindow &left, const PieceDeadlineWindow &right)
+        {
+            return left.idleTimer.elapsed() < right.idleTimer.elapsed();
+        });
+        droppedWindows.append({oldestIter->first, oldestIter->last});
+        m_deadlineWindows.erase(oldestIter);
+    }
+
+    PieceDeadlineWindow &window = m_deadlineWindows[readerId];
+    droppedWindows.append({window.first, window.last});
+    window.first = first;
+    window.last = last;
+    window.idleTimer.start();
+
+    // Drop the deadlines that no reader needs anymore,
+    // they would hold back the pieces that are now needed
+    const auto isInWindow = [this](const int index)
+    {
+        return std::any_of(m_deadlineWindows.cbegin(), m_deadlineWindows.cend()
+            , [index](const PieceDeadlineWindow &readerWindow)
+        {
+            return (index >= readerWindow.first) && (index <= readerWindow.last);
+        });
+    };
+    for (const QPair<int, int> &droppedWindow : asConst(droppedWindows))
+    {
+        for (int i = droppedWindow.first; i <= droppedWindow.second; ++i)
+        {
+            if (!isInWindow(i))
+                m_nativeHandle.reset_piece_deadline(lt::piece_index_t {i});
+        }
+    }
+
+    // Give each following piece a bit more time, so that they arrive in order
+    const int deadlineStep = 100;  // milliseconds
+    for (int i = first; i <= last; ++i)
+    {
+        if (isMissing(i))
+            m_nativeHandle.set_piece_deadline(lt::piece_index_t {i}, ((i - first) * deadlineStep));
+    }
+}
+
 void TorrentImpl::applyFirstLastPiecePriority(const bool enabled, const QVector<DownloadPriority> &updatedFilePrio)
 {
     Q_ASSERT(hasMetadata());
@@ -1308,6 +1996,12 @@ void TorrentImpl::fileSearchFinished(const QString &savePath, const QStringList
     endReceivedMetadataHandling(savePath, fileNames);
 }
 
+void TorrentImpl::handleFileSnapshotTaken(const QVector<FileSnapshot> &snapshot)
+{
+    if (m_session->isQuickRecheckEnabled())
+        m_fileSnapshot = snapshot;
+}
+
 void TorrentImpl::endReceivedMetadataHandling(const QString &savePath, const QStringList &fileNames)
 {
     lt::add_torrent_params &p = m_ltAddTorrentParams;
@@ -1332,11 +2026,32 @@ void TorrentImpl::endReceivedMetadataHandling(const QString &savePath, const QSt
 
 void TorrentImpl::reload()
 {
-    const auto queuePos = m_nativeHandle.queue_position();
+    if (hasMetadata() && m_ltAddTorrentParams.have_pieces.empty()
+        && (m_maintenanceJob != MaintenanceJob::HandleMetadata))
+    {
+        // Piece bitfields are dropped from the cached resume data once it is written.
+        // Rather than blocking on libtorrent to get them, reload the torrent once
+        // fresh resume data arrives, so that the files aren't rechecked.
+        m_reloadRequested = true;
+        saveResumeData();
+        return;
+    }
 
-    m_nativeSession->remove_torrent(m_nativeHandle, lt::session::delete_partfile);
+    reload_impl();
+}
+
+void TorrentImpl::reload_impl()
+{
+    // Cached position is kept current by state updates and queue snapshots,
+    // so there is no need to block on the libtorrent thread to get it
+    const lt::queue_position_t queuePos = m_nativeStatus.queue_position;
 
     lt::add_torrent_params p = m_ltAddTorrentParams;
+    if (!p.ti)
+        p.ti = std::const_pointer_cast<lt::torrent_info>(m_nativeHandle.torrent_file());
+
+    m_nativeSession->remove_torrent(m_nativeHandle, lt::session::delete_partfile);
+
     p.flags |= lt::torrent_flags::update_subscribe
             | lt::torrent_flags::override_trackers
             | lt::torrent_flags::override_web_seeds;
@@ -1357,12 +2072,19 @@ void TorrentImpl::reload()
 
     m_nativeHandle = m_nativeSession->add_torrent(p);
     m_nativeHandle.queue_position_set(queuePos);
+    m_trackerEntriesOutdated = true;
+    m_trackerOrderOutdated = true;
 
     m_torrentInfo = TorrentInfo {m_nativeHandle.torrent_file()};
 }
 
 void TorrentImpl::pause()
 {
+    // Dormant torrents are always stopped
+    if (isDormant()) return;
+
+    m_idleTimer.start();
+
     if (!m_isStopped)
     {
         m_isStopped = true;
@@ -1380,6 +2102,8 @@ void TorrentImpl::pause()
 
 void TorrentImpl::resume(const TorrentOperatingMode mode)
 {
+    if (!attach()) return;
+
     if (hasError())
         m_nativeHandle.clear_error();
 
@@ -1423,6 +2147,8 @@ void TorrentImpl::moveStorage(const QString &newPath, const MoveStorageMode mode
 
 void TorrentImpl::renameFile(const int index, const QString &path)
 {
+    if (!attach()) return;
+
     const QString oldPath = filePath(index);
     m_oldPath[lt::file_index_t {index}].push_back(oldPath);
     ++m_renameCount;
@@ -1434,6 +2160,11 @@ void TorrentImpl::handleStateUpdate(const lt::torrent_status &nativeStatus)
     updateStatus(nativeStatus);
 }
 
+void TorrentImpl::handleQueuePositionUpdate(const lt::queue_position_t position)
+{
+    m_nativeStatus.queue_position = position;
+}
+
 void TorrentImpl::handleMoveStorageJobFinished(const bool hasOutstandingJob)
 {
     m_storageIsMoving = hasOutstandingJob;
@@ -1452,14 +2183,34 @@ void TorrentImpl::handleMoveStorageJobFinished(const bool hasOutstandingJob)
         m_moveFinishedTriggers.takeFirst()();
 }
 
+void TorrentImpl::handleTrackerAnnounceAlert(const lt::tracker_announce_alert *p)
+{
+    const QString trackerUrl = p->tracker_url();
+    updateTrackerEndpoint(TrackerRegistry::id(trackerUrl), p->local_endpoint, false);
+
+    TrackerEntry *entry = findTrackerEntry(trackerUrl);
+    if (entry && (entry->status() != TrackerEntry::Working))
+        entry->setStatus(TrackerEntry::Updating);
+
+    m_session->handleTorrentTrackerAnnounce(this, trackerUrl);
+}
+
 void TorrentImpl::handleTrackerReplyAlert(const lt::tracker_reply_alert *p)
 {
     const QString trackerUrl(p->tracker_url());
     qDebug("Received a tracker reply from %s (Num_peers = %d)", qUtf8Printable(trackerUrl), p->num_peers);
     // Connection was successful now. Remove possible old errors
-    m_trackerInfos[trackerUrl] = {{}, p->num_peers};
+    m_trackerInfos[TrackerRegistry::id(trackerUrl)] = {{}, p->num_peers};
+
+    updateTrackerEndpoint(TrackerRegistry::id(trackerUrl), p->local_endpoint, false);
 
-    m_session->handleTorrentTrackerReply(this, trackerUrl);
+    TrackerEntry *entry = findTrackerEntry(trackerUrl);
+    if (entry)
+        entry->setStatus(TrackerEntry::Working);
+    // the reply changes the scrape counts too, which only libtorrent has
+    m_trackerEntriesOutdated = true;
+
+    m_session->handleTorrentTrackerReply(this, trackerUrl, endpointKey(p->local_endpoint));
 }
 
 void TorrentImpl::handleTrackerWarningAlert(const lt::tracker_warning_alert *p)
@@ -1468,7 +2219,11 @@ void TorrentImpl::handleTrackerWarningAlert(const lt::tracker_warning_alert *p)
     const QString message = p->warning_message();
 
     // Connection was successful now but there is a warning message
-    m_trackerInfos[trackerUrl].lastMessage = message; // Store warning message
+    m_trackerInfos[TrackerRegistry::id(trackerUrl)].lastMessage = message; // Store warning message
+
+    TrackerEntry *entry = findTrackerEntry(trackerUrl);
+    if (entry)
+        entry->setStatus(TrackerEntry::Working);
 
     m_session->handleTorrentTrackerWarning(this, trackerUrl);
 }
@@ -1478,18 +2233,22 @@ void TorrentImpl::handleTrackerErrorAlert(const lt::tracker_error_alert *p)
     const QString trackerUrl = p->tracker_url();
     const QString message = p->error_message();
 
-    m_trackerInfos[trackerUrl].lastMessage = message;
+    m_trackerInfos[TrackerRegistry::id(trackerUrl)].lastMessage = message;
+
+    m_session->handleTorrentTrackerAnnounceFailed(this, trackerUrl, endpointKey(p->local_endpoint), message);
 
     // Starting with libtorrent 1.2.x each tracker has multiple local endpoints from which
     // an announce is attempted. Some endpoints might succeed while others might fail.
     // Emit the signal only if all endpoints have failed.
-    const QVector<TrackerEntry> trackerList = trackers();
-    const auto iter = std::find_if(trackerList.cbegin(), trackerList.cend(), [&trackerUrl](const TrackerEntry &entry)
+    if (!updateTrackerEndpoint(TrackerRegistry::id(trackerUrl), p->local_endpoint, true))
+        return;
+
+    TrackerEntry *entry = findTrackerEntry(trackerUrl);
+    if (entry)
     {
-        return (entry.url() == trackerUrl);
-    });
-    if ((iter != trackerList.cend()) && (iter->status() == TrackerEntry::NotWorking))
+        entry->setStatus(TrackerEntry::NotWorking);
         m_session->handleTorrentTrackerError(this, trackerUrl);
+    }
 }
 
 void TorrentImpl::handleTorrentCheckedAlert(const lt::torrent_checked_alert *p)
@@ -1573,6 +2332,34 @@ void TorrentImpl::handleSaveResumeDataAlert(const lt::save_resume_data_alert *p)
         m_ltAddTorrentParams = p->params;
     }
 
+    if (m_reloadRequested)
+    {
+        m_reloadRequested = false;
+        m_ltAddTorrentParams.have_pieces = p->params.have_pieces;
+        m_ltAddTorrentParams.verified_pieces = p->params.verified_pieces;
+        reload_impl();
+        updateStatus();
+    }
+
+    if (m_maintenanceJob == MaintenanceJob::HandleMetadata)
+    {
+        m_ltAddTorrentParams.have_pieces.clear();
+        m_ltAddTorrentParams.verified_pieces.clear();
+
+        TorrentInfo metadata = TorrentInfo {m_nativeHandle.torrent_file()};
+        metadata.setContentLayout(m_contentLayout);
+
+        m_session->findIncompleteFiles(metadata, m_savePath);
+    }
+
+    prepareResumeData();
+
+    if (m_detachRequested)
+        detach();
+}
+
+void TorrentImpl::prepareResumeData()
+{
     if (m_isStopped)
     {
         m_ltAddTorrentParams.flags |= lt::torrent_flags::paused;
@@ -1594,21 +2381,15 @@ void TorrentImpl::handleSaveResumeDataAlert(const lt::save_resume_data_alert *p)
     }
 
     m_ltAddTorrentParams.added_time = addedTime().toSecsSinceEpoch();
-    m_ltAddTorrentParams.save_path = Profile::instance()->toPortablePath(
-                QString::fromStdString(m_ltAddTorrentParams.save_path)).toStdString();
-
-    if (m_maintenanceJob == MaintenanceJob::HandleMetadata)
-    {
-        m_ltAddTorrentParams.have_pieces.clear();
-        m_ltAddTorrentParams.verified_pieces.clear();
-
-        TorrentInfo metadata = TorrentInfo {m_nativeHandle.torrent_file()};
-        metadata.setContentLayout(m_contentLayout);
-
-        m_session->findIncompleteFiles(metadata, m_savePath);
-    }
 
+    // The params are also used to add the torrent back to the session, so keep
+    // the native save path in memory. The metadata is stored in its own file.
+    const std::string nativeSavePath = m_ltAddTorrentParams.save_path;
+    m_ltAddTorrentParams.ti.reset();
+    m_ltAddTorrentParams.save_path = Profile::instance()->toPortablePath(
+                QString::fromStdString(nativeSavePath)).toStdString();
     auto resumeDataPtr = std::make_shared<lt::entry>(lt::write_resume_data(m_ltAddTorrentParams));
+    m_ltAddTorrentParams.save_path = nativeSavePath;
     lt::entry &resumeData = *resumeDataPtr;
 
     // TODO: The following code is deprecated. Remove after several releases in 4.3.x.
@@ -1638,7 +2419,45 @@ void TorrentImpl::handleSaveResumeDataAlert(const lt::save_resume_data_alert *p)
     resumeData["qBt-contentLayout"] = Utils::String::fromEnum(m_contentLayout).toStdString();
     resumeData["qBt-firstLastPiecePriority"] = m_hasFirstLastPiecePriority;
 
-    m_session->handleTorrentResumeDataReady(this, resumeDataPtr);
+    // The snapshot is only stored along with the resume data saved after flushing
+    // the disk cache, so it can't claim data that isn't written yet. It is taken
+    // by the thread that writes the resume data. Dormant torrents keep the snapshot
+    // from the time they were detached, and the files can't be trusted while
+    // they are being checked.
+    const bool isFlushed = std::exchange(m_isResumeDataFlushRequested, false);
+    QStringList snapshotFilePaths;
+    if (!m_session->isQuickRecheckEnabled())
+    {
+        m_fileSnapshot.clear();
+    }
+    else if (isFlushed && hasMetadata() && !isChecking() && !hasMissingFiles())
+    {
+        const QDir saveDir {actualStorageLocation()};
+        snapshotFilePaths.reserve(filesCount());
+        for (int i = 0; i < filesCount(); ++i)
+            snapshotFilePaths << saveDir.absoluteFilePath(filePath(i));
+    }
+    else if ((isFlushed || isDormant()) && !m_fileSnapshot.isEmpty())
+    {
+        resumeData["qBt-fileSnapshot"] = fileSnapshotToEntry(m_fileSnapshot);
+    }
+
+    m_session->handleTorrentResumeDataReady(this, resumeDataPtr, snapshotFilePaths);
+
+    // Dormant torrents are restored from the cached params, so keep them complete
+    if (!isDormant() && !m_detachRequested && !m_hasMissingFiles)
+        compactResumeData();
+}
+
+void TorrentImpl::compactResumeData()
+{
+    // The piece state is owned by libtorrent while the torrent is in the session
+    // and it is written out with every resume data, so don't keep it in memory
+    lt::add_torrent_params &p = m_ltAddTorrentParams;
+    p.have_pieces = {};
+    p.verified_pieces = {};
+    p.peers = {};
+    p.banned_peers = {};
 }
 
 void TorrentImpl::handleSaveResumeDataFailedAlert(const lt::save_resume_data_failed_alert *p)
@@ -1804,6 +2623,9 @@ void TorrentImpl::handleAlert(const lt::alert *a)
     case lt::torrent_resumed_alert::alert_type:
         handleTorrentResumedAlert(static_cast<const lt::torrent_resumed_alert*>(a));
         break;
+    case lt::tracker_announce_alert::alert_type:
+        handleTrackerAnnounceAlert(static_cast<const lt::tracker_announce_alert*>(a));
+        break;
     case lt::tracker_error_alert::alert_type:
         handleTrackerErrorAlert(static_cast<const lt::tracker_error_alert*>(a));
         break;
@@ -1915,7 +2737,10 @@ bool TorrentImpl::useTempPath() const
 
 void TorrentImpl::updateStatus()
 {
-    updateStatus(m_nativeHandle.status());
+    if (isDormant())
+        updateDormantStatus();
+    else
+        updateStatus(m_nativeHandle.status());
 }
 
 void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
@@ -1970,7 +2795,11 @@ void TorrentImpl::setUploadLimit(const int limit)
     if (limit == uploadLimit())
         return;
 
-    m_nativeHandle.set_upload_limit(limit);
+    // Dormant torrents get it from their resume data once attached
+    if (isDormant())
+        m_ltAddTorrentParams.upload_limit = limit;
+    else
+        m_nativeHandle.set_upload_limit(limit);
     saveResumeData();
 }
 
@@ -1979,7 +2808,11 @@ void TorrentImpl::setDownloadLimit(const int limit)
     if (limit == downloadLimit())
         return;
 
-    m_nativeHandle.set_download_limit(limit);
+    // Dormant torrents get it from their resume data once attached
+    if (isDormant())
+        m_ltAddTorrentParams.download_limit = limit;
+    else
+        m_nativeHandle.set_download_limit(limit);
     saveResumeData();
 }
 
@@ -1988,10 +2821,7 @@ void TorrentImpl::setSuperSeeding(const bool enable)
     if (enable == superSeeding())
         return;
 
-    if (enable)
-        m_nativeHandle.set_flags(lt::torrent_flags::super_seeding);
-    else
-        m_nativeHandle.unset_flags(lt::torrent_flags::super_seeding);
+    setNativeFlag(lt::torrent_flags::super_seeding, enable);
     saveResumeData();
 }
 
@@ -2000,10 +2830,7 @@ void TorrentImpl::setDHTDisabled(const bool disable)
     if (disable == isDHTDisabled())
         return;
 
-    if (disable)
-        m_nativeHandle.set_flags(lt::torrent_flags::disable_dht);
-    else
-        m_nativeHandle.unset_flags(lt::torrent_flags::disable_dht);
+    setNativeFlag(lt::torrent_flags::disable_dht, disable);
     saveResumeData();
 }
 
@@ -2012,10 +2839,7 @@ void TorrentImpl::setPEXDisabled(const bool disable)
     if (disable == isPEXDisabled())
         return;
 
-    if (disable)
-        m_nativeHandle.set_flags(lt::torrent_flags::disable_pex);
-    else
-        m_nativeHandle.unset_flags(lt::torrent_flags::disable_pex);
+    setNativeFlag(lt::torrent_flags::disable_pex, disable);
     saveResumeData();
 }
 
@@ -2024,20 +2848,50 @@ void TorrentImpl::setLSDDisabled(const bool disable)
     if (disable == isLSDDisabled())
         return;
 
-    if (disable)
-        m_nativeHandle.set_flags(lt::torrent_flags::disable_lsd);
-    else
-        m_nativeHandle.unset_flags(lt::torrent_flags::disable_lsd);
+    setNativeFlag(lt::torrent_flags::disable_lsd, disable);
     saveResumeData();
 }
 
+void TorrentImpl::setNativeFlag(const lt::torrent_flags_t flag, const bool enable)
+{
+    // Dormant torrents get it from their resume data once attached
+    if (isDormant())
+    {
+        if (enable)
+            m_ltAddTorrentParams.flags |= flag;
+        else
+            m_ltAddTorrentParams.flags &= ~flag;
+    }
+    else
+    {
+        if (enable)
+            m_nativeHandle.set_flags(flag);
+        else
+            m_nativeHandle.unset_flags(flag);
+    }
+
+    // prevent return cached value
+    if (enable)
+        m_nativeStatus.flags |= flag;
+    else
+        m_nativeStatus.flags &= ~flag;
+}
+
 void TorrentImpl::flushCache() const
 {
+    if (isDormant()) return;
+
     m_nativeHandle.flush_cache();
 }
 
 QString TorrentImpl::createMagnetURI() const
 {
+    if (isDormant())
+    {
+        const std::shared_ptr<lt::torrent_info> nativeInfo = metadata().nativeInfo();
+        return nativeInfo ? QString::fromStdString(lt::make_magnet_uri(*nativeInfo)) : QString {};
+    }
+
     return QString::fromStdString(lt::make_magnet_uri(m_nativeHandle));
 }
 
@@ -2046,6 +2900,8 @@ void TorrentImpl::prioritizeFiles(const QVector<DownloadPriority> &priorities)
     if (!hasMetadata()) return;
     if (priorities.size() != filesCount()) return;
 
+    if (!attach()) return;
+
     // Reset 'm_hasSeedStatus' if needed in order to react again to
     // 'torrent_finished_alert' and eg show tray notifications
     const QVector<qreal> progress = filesProgress();
@@ -2069,19 +2925,62 @@ void TorrentImpl::prioritizeFiles(const QVector<DownloadPriority> &priorities)
         applyFirstLastPiecePriority(true, priorities);
 }
 
+TorrentMemoryUsage TorrentImpl::memoryUsage() const
+{
+    TorrentMemoryUsage usage;
+
+    const std::shared_ptr<lt::torrent_info> nativeInfo = m_torrentInfo.nativeInfo();
+    if (nativeInfo)
+        usage.metadata = estimateMemoryUsage(*nativeInfo);
+
+    usage.resumeData = estimateMemoryUsage(m_ltAddTorrentParams);
+
+    usage.status = sizeof(m_nativeStatus) + bitfieldMemoryUsage(m_nativeStatus.pieces)
+        + bitfieldMemoryUsage(m_nativeStatus.verified_pieces) + stringMemoryUsage(m_nativeStatus.save_path)
+        + stringMemoryUsage(m_nativeStatus.name) + stringMemoryUsage(m_nativeStatus.current_tracker);
+
+    // Tracker URLs are interned by TrackerRegistry
+    usage.trackers = static_cast<qint64>(m_trackerEntries.capacity()) * sizeof(TrackerEntry);
+    for (const TrackerInfo &trackerInfo : asConst(m_trackerInfos))
+    {
+        usage.trackers += sizeof(TrackerID) + sizeof(TrackerInfo) + HASH_NODE_OVERHEAD
+            + stringMemoryUsage(trackerInfo.lastMessage);
+    }
+
+    // Tag strings are shared with the session
+    usage.tags = m_tags.size() * (sizeof(QString) + HASH_NODE_OVERHEAD);
+
+    usage.other = sizeof(TorrentImpl) + stringMemoryUsage(m_name) + stringMemoryUsage(m_savePath)
+        + stringMemoryUsage(m_category);
+    for (const QVector<QString> &oldPaths : asConst(m_oldPath))
+    {
+        usage.other += sizeof(lt::file_index_t) + sizeof(QVector<QString>) + HASH_NODE_OVERHEAD;
+        for (const QString &oldPath : oldPaths)
+            usage.other += sizeof(QString) + stringMemoryUsage(oldPath);
+    }
+
+    return usage;
+}
+
 QVector<qreal> TorrentImpl::availableFileFractions() const
 {
-    const int filesCount = this->filesCount();
-    if (filesCount <= 0) return {};
+    QVector<int> fileIndexes(filesCount());
+    std::iota(fileIndexes.begin(), fileIndexes.end(), 0);
+    return availableFileFractions(fileIndexes);
+}
+
+QVector<qreal> TorrentImpl::availableFileFractions(const QVector<int> &fileIndexes) const
+{
+    if (filesCount() <= 0) return {};
 
     const QVector<int> piecesAvailability = pieceAvailability();
     // libtorrent returns empty array for seeding only torrents
-    if (piecesAvailability.empty()) return QVector<qreal>(filesCount, -1);
+    if (piecesAvailability.empty()) return QVector<qreal>(fileIndexes.size(), -1);
 
     QVector<qreal> res;
-    res.reserve(filesCount);
+    res.reserve(fileIndexes.size());
     const TorrentInfo info = this->info();
-    for (int i = 0; i < filesCount; ++i)
+    for (const int i : fileIndexes)
     {
         const TorrentInfo::PieceRange filePieces = info.filePieces(i);
 
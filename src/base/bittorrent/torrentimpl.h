@@ -37,17 +37,22 @@
 #include <libtorrent/torrent_status.hpp>
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QPair>
 #include <QQueue>
 #include <QSet>
 #include <QString>
 #include <QVector>
 
 #include "infohash.h"
+#include "resumedataverifier.h"
 #include "speedmonitor.h"
 #include "torrent.h"
 #include "torrentinfo.h"
+#include "trackerentry.h"
+#include "trackerregistry.h"
 
 namespace BitTorrent
 {
@@ -67,7 +72,7 @@ namespace BitTorrent
         bool hasSeedStatus = false;
         bool forced = false;
         bool paused = false;
-
+        QVector<FileSnapshot> fileSnapshot;
 
         qreal ratioLimit = Torrent::USE_GLOBAL_RATIO;
         int seedingTimeLimit = Torrent::USE_GLOBAL_SEEDING_TIME;
@@ -84,7 +89,8 @@ namespace BitTorrent
     enum class MaintenanceJob
     {
         None,
-        HandleMetadata
+        HandleMetadata,
+        VerifyFiles
     };
 
     class TorrentImpl final : public QObject, public Torrent
@@ -99,6 +105,17 @@ namespace BitTorrent
 
         bool isValid() const;
 
+        // A dormant torrent is a stopped torrent that is not loaded in libtorrent.
+        // It is served from its resume data and attached again on demand,
+        // which fails if libtorrent doesn't accept it back. Its metadata is
+        // released too and read back from the resume folder when needed.
+        bool isDormant() const;
+        bool attach();
+        bool canBecomeDormant() const;
+        qint64 idleTime() const;
+        void requestDetach();
+        void releaseMetadata();
+
         InfoHash hash() const override;
         QString name() const override;
         QDateTime creationDate() const override;
@@ -175,6 +192,7 @@ namespace BitTorrent
         qlonglong seedingTime() const override;
         qlonglong eta() const override;
         QVector<qreal> filesProgress() const override;
+        QVector<qreal> filesProgress(const QVector<int> &fileIndexes) const override;
         int seedsCount() const override;
         int peersCount() const override;
         int leechsCount() const override;
@@ -210,10 +228,13 @@ namespace BitTorrent
         int connectionsLimit() const override;
         qlonglong nextAnnounce() const override;
         QVector<qreal> availableFileFractions() const override;
+        QVector<qreal> availableFileFractions(const QVector<int> &fileIndexes) const override;
+        TorrentMemoryUsage memoryUsage() const override;
 
         void setName(const QString &name) override;
         void setSequentialDownload(bool enable) override;
         void setFirstLastPiecePriority(bool enabled) override;
+        void setPieceDeadlines(const QString &readerId, int firstPiece, int lastPiece) override;
         void pause() override;
         void resume(TorrentOperatingMode mode = TorrentOperatingMode::AutoManaged) override;
         void move(QString path) override;
@@ -247,12 +268,19 @@ namespace BitTorrent
 
         void handleAlert(const lt::alert *a);
         void handleStateUpdate(const lt::torrent_status &nativeStatus);
+        void handleQueuePositionUpdate(lt::queue_position_t position);
         void handleTempPathChanged();
         void handleCategorySavePathChanged();
         void handleAppendExtensionToggled();
-        void saveResumeData();
+        // The periodic saves don't flush the disk cache, so they don't update the file snapshot
+        void saveResumeData(bool flushDiskCache = true);
         void handleMoveStorageJobFinished(bool hasOutstandingJob);
         void fileSearchFinished(const QString &savePath, const QStringList &fileNames);
+        void handleFileSnapshotTaken(const QVector<FileSnapshot> &snapshot);
+        // Position of the tracker in the native list, -1 if the torrent doesn't have it
+        int nativeTrackerIndex(const QString &url) const;
+        // Makes the next announce to the tracker happen in 'delay' seconds
+        void rescheduleTrackerAnnounce(const QString &url, int delay);
 
         QString actualStorageLocation() const;
 
@@ -261,7 +289,10 @@ namespace BitTorrent
 
         void updateStatus();
         void updateStatus(const lt::torrent_status &nativeStatus);
+        void updateDormantStatus();
         void updateState();
+        const TorrentInfo &metadata() const;
+        void setNativeFlag(lt::torrent_flags_t flag, bool enable);
 
         void handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p);
         void handleFileCompletedAlert(const lt::file_completed_alert *p);
@@ -275,6 +306,7 @@ namespace BitTorrent
         void handleTorrentFinishedAlert(const lt::torrent_finished_alert *p);
         void handleTorrentPausedAlert(const lt::torrent_paused_alert *p);
         void handleTorrentResumedAlert(const lt::torrent_resumed_alert *p);
+        void handleTrackerAnnounceAlert(const lt::tracker_announce_alert *p);
         void handleTrackerErrorAlert(const lt::tracker_error_alert *p);
         void handleTrackerReplyAlert(const lt::tracker_reply_alert *p);
         void handleTrackerWarningAlert(const lt::tracker_warning_alert *p);
@@ -283,6 +315,12 @@ namespace BitTorrent
 
         void setAutoManaged(bool enable);
 
+        void refreshTrackerEntries() const;
+        TrackerEntry *findTrackerEntry(const QString &url);
+        // Records an announce from the endpoint and returns whether every endpoint
+        // still announcing to the tracker has failed
+        bool updateTrackerEndpoint(TrackerID id, const lt::tcp::endpoint &endpoint, bool failed);
+
         void adjustActualSavePath();
         void adjustActualSavePath_impl();
         void move_impl(QString path, MoveStorageMode mode);
@@ -292,21 +330,53 @@ namespace BitTorrent
 
         void endReceivedMetadataHandling(const QString &savePath, const QStringList &fileNames);
         void reload();
+        void reload_impl();
+        void detach();
+        void prepareResumeData();
+        void quickRecheck();
+        void handleQuickRecheckFinished();
+        void compactResumeData();
 
         Session *const m_session;
         lt::session *m_nativeSession;
         lt::torrent_handle m_nativeHandle;
         lt::torrent_status m_nativeStatus;
         TorrentState m_state = TorrentState::Unknown;
-        TorrentInfo m_torrentInfo;
+        mutable TorrentInfo m_torrentInfo;
         SpeedMonitor m_speedMonitor;
 
+        // What the getters need from the metadata while it is released
+        struct MetadataSummary
+        {
+            QString name;
+            QDateTime creationDate;
+            QString creator;
+            QString comment;
+            QString firstFilePath;
+            qlonglong totalSize = 0;
+            int pieceLength = 0;
+            int piecesCount = 0;
+            int filesCount = 0;
+            bool isPrivate = false;
+            bool hasRootFolder = false;
+        };
+        MetadataSummary m_metadataSummary;
+        bool m_isMetadataReleased = false;
+
         InfoHash m_hash;
 
         // m_moveFinishedTriggers is activated only when the following conditions are met:
         // all file rename jobs complete, all file move jobs complete
         QQueue<EventTrigger> m_moveFinishedTriggers;
         int m_renameCount = 0;
+        // Pieces that were given a deadline by setPieceDeadlines(), per reader
+        struct PieceDeadlineWindow
+        {
+            int first = 0;
+            int last = -1;
+            QElapsedTimer idleTimer;
+        };
+        QHash<QString, PieceDeadlineWindow> m_deadlineWindows;
         bool m_storageIsMoving = false;
 
         MaintenanceJob m_maintenanceJob = MaintenanceJob::None;
@@ -315,7 +385,24 @@ namespace BitTorrent
         // we will rely on this workaround to remove empty leftover folders
         QHash<lt::file_index_t, QVector<QString>> m_oldPath;
 
-        QHash<QString, TrackerInfo> m_trackerInfos;
+        QHash<TrackerID, TrackerInfo> m_trackerInfos;
+
+        // Local endpoints each tracker is announced from, to tell from the alerts alone
+        // when all of them have failed. Endpoints that stop being reported are forgotten.
+        struct TrackerEndpoints
+        {
+            QHash<QString, qint64> lastSeen; // <endpoint, msecs since epoch>
+            QSet<QString> failed;
+        };
+        mutable QHash<TrackerID, TrackerEndpoints> m_trackerEndpoints;
+
+        // Mirror of the native tracker list. The URLs are kept current by addTrackers()/replaceTrackers()
+        // and the status by the tracker alerts. Only the scrape counts, which the alerts don't carry,
+        // are re-read from libtorrent, lazily and at most every few seconds.
+        mutable QVector<TrackerEntry> m_trackerEntries;
+        mutable bool m_trackerEntriesOutdated = false;
+        mutable bool m_trackerOrderOutdated = false;
+        mutable QElapsedTimer m_trackerEntriesRefreshTimer;
 
         // Persistent data
         QString m_name;
@@ -335,6 +422,16 @@ namespace BitTorrent
 
         bool m_unchecked = false;
 
+        // State of the files when the resume data was last saved
+        QVector<FileSnapshot> m_fileSnapshot;
+        bool m_isResumeDataFlushRequested = false;
+        ResumeDataVerifier *m_resumeDataVerifier = nullptr;
+
+        QElapsedTimer m_idleTimer;
+        bool m_detachRequested = false;
+        // reload() waits for resume data with the piece bitfields
+        bool m_reloadRequested = false;
+
         lt::add_torrent_params m_ltAddTorrentParams;
     };
 }
@@ -0,0 +1,293 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "trackerannouncecoordinator.h"
+
+#include <algorithm>
+
+#include <libtorrent/torrent_handle.hpp>
+
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QUrl>
+
+#include "base/algorithm.h"
+#include "base/global.h"
+#include "torrentimpl.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    // Number of failures in a row, from any torrent, after which a local endpoint
+    // considers the tracker down. It is down once it is for all of them.
+    const int FAILURES_BEFORE_BACKOFF = 5;
+    // Endpoints that didn't announce for this long are gone, e.g. the interface went down
+    const qint64 ENDPOINT_EXPIRY = 2 * 60 * 60 * 1000; // 2 h
+    const qint64 MIN_BACKOFF = 5 * 60 * 1000; // 5 min
+    const qint64 MAX_BACKOFF = 6 * 60 * 60 * 1000; // 6 h
+    // Session-wide re-announces are spread so that each host gets at most this many per second
+    const int MAX_ANNOUNCES_PER_HOST_PER_SEC = 20;
+    // Announces without a result after this long are not used for latency
+    const qint64 ANNOUNCE_TIMEOUT = 5 * 60 * 1000; // 5 min
+    const int PURGE_INTERVAL = 60 * 1000; // 1 min
+
+    bool isSuppressedAt(const qint64 suppressedUntil, const qint64 now)
+    {
+        return (suppressedUntil > now);
+    }
+
+    QDateTime toDateTime(const qint64 msecs)
+    {
+        return (msecs > 0) ? QDateTime::fromMSecsSinceEpoch(msecs) : QDateTime {};
+    }
+}
+
+TrackerAnnounceCoordinator::TrackerAnnounceCoordinator(QObject *parent)
+    : QObject(parent)
+    , m_purgeTimer(new QTimer(this))
+{
+    connect(m_purgeTimer, &QTimer::timeout, this, &TrackerAnnounceCoordinator::purgeStaleAnnounces);
+    m_purgeTimer->start(PURGE_INTERVAL);
+}
+
+void TrackerAnnounceCoordinator::handleAnnounce(const InfoHash &hash, const QString &url)
+{
+    const TrackerID id = TrackerRegistry::id(url);
+    ++m_stats[id].announces;
+    m_pendingAnnounces.insert({hash, id}, QDateTime::currentMSecsSinceEpoch());
+}
+
+void TrackerAnnounceCoordinator::handleReply(const InfoHash &hash, const QString &url, const QString &endpoint)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const TrackerID id = TrackerRegistry::id(url);
+    Stats &stats = m_stats[id];
+
+    const bool wasSuppressed = isSuppressedAt(stats.suppressedUntil, now);
+
+    ++stats.replies;
+    stats.consecutiveFailures = 0;
+    stats.backoffCount = 0;
+    stats.suppressedUntil = 0;
+    stats.lastReplyTime = now;
+    stats.endpoints[endpoint] = {0, now};
+
+    const qint64 announceTime = m_pendingAnnounces.take({hash, id});
+    if (announceTime > 0)
+    {
+        stats.lastLatency = now - announceTime;
+        stats.averageLatency = (stats.averageLatency < 0)
+            ? stats.lastLatency
+            : ((stats.averageLatency * 7) + stats.lastLatency) / 8;
+    }
+
+    // the other torrents don't need to wait for the end of the backoff
+    if (wasSuppressed)
+        emit suppressionChanged(url);
+}
+
+void TrackerAnnounceCoordinator::handleFailure(const InfoHash &hash, const QString &url, const QString &endpoint
+    , const QString &message)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const TrackerID id = TrackerRegistry::id(url);
+    Stats &stats = m_stats[id];
+
+    ++stats.failures;
+    ++stats.consecutiveFailures;
+    stats.lastError = message;
+    stats.lastFailureTime = now;
+    m_pendingAnnounces.remove({hash, id});
+
+    QPair<int, qint64> &endpointStats = stats.endpoints[endpoint];
+    ++endpointStats.first;
+    endpointStats.second = now;
+
+    if (isSuppressedAt(stats.suppressedUntil, now))
+        return;
+
+    // A tracker that only fails from some of the endpoints still works for everyone
+    bool isDown = true;
+    for (auto iter = stats.endpoints.begin(); iter != stats.endpoints.end();)
+    {
+        if ((now - iter->second) > ENDPOINT_EXPIRY)
+        {
+            iter = stats.endpoints.erase(iter);
+            continue;
+        }
+
+        // Once a tracker is down, a single failure after the backoff expired is enough
+        // to put it back, each time for twice as long
+        if ((iter->first < FAILURES_BEFORE_BACKOFF) && (stats.backoffCount == 0))
+            isDown = false;
+        ++iter;
+    }
+
+    if (!isDown)
+        return;
+
+    const qint64 backoff = std::min((MIN_BACKOFF << std::min(stats.backoffCount, 10)), MAX_BACKOFF);
+    stats.suppressedUntil = now + backoff;
+    ++stats.backoffCount;
+    emit suppressionChanged(url);
+}
+
+bool TrackerAnnounceCoordinator::isSuppressed(const QString &url) const
+{
+    const auto iter = m_stats.constFind(TrackerRegistry::id(url));
+    return (iter != m_stats.cend())
+        && isSuppressedAt(iter->suppressedUntil, QDateTime::currentMSecsSinceEpoch());
+}
+
+int TrackerAnnounceCoordinator::remainingBackoff(const QString &url) const
+{
+    const auto iter = m_stats.constFind(TrackerRegistry::id(url));
+    if (iter == m_stats.cend())
+        return 0;
+
+    const qint64 remaining = iter->suppressedUntil - QDateTime::currentMSecsSinceEpoch();
+    return (remaining > 0) ? static_cast<int>((remaining + 999) / 1000) : 0;
+}
+
+int TrackerAnnounceCoordinator::takeAnnounceSlot(const QString &url)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 &nextSlot = m_nextHostSlots[host(TrackerRegistry::id(url))];
+    const qint64 slot = std::max(now, nextSlot);
+    nextSlot = slot + (1000 / MAX_ANNOUNCES_PER_HOST_PER_SEC);
+    return static_cast<int>((slot - now) / 1000);
+}
+
+QVector<TrackerHealth> TrackerAnnounceCoordinator::health() const
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QVector<TrackerHealth> result;
+    result.reserve(m_stats.size());
+    for (auto i = m_stats.cbegin(); i != m_stats.cend(); ++i)
+    {
+        const Stats &stats = i.value();
+        result.append({TrackerRegistry::url(i.key()), stats.announces, stats.replies, stats.failures
+            , stats.consecutiveFailures, stats.averageLatency, stats.lastLatency, stats.lastError
+            , toDateTime(stats.lastReplyTime), toDateTime(stats.lastFailureTime)
+            , (isSuppressedAt(stats.suppressedUntil, now) ? toDateTime(stats.suppressedUntil) : QDateTime {})});
+    }
+
+    return result;
+}
+
+void TrackerAnnounceCoordinator::reannounce(const QVector<TorrentImpl *> &torrents
+    , const QHash<QString, QSet<InfoHash>> &trackerIndex)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // Only the hosts of the trackers that aren't suppressed are needed to spread the load
+    QSet<InfoHash> torrentsWithTrackers;
+    QHash<InfoHash, QSet<QString>> torrentHosts;
+    QHash<InfoHash, QStringList> suppressedTrackers;
+    for (auto i = trackerIndex.cbegin(); i != trackerIndex.cend(); ++i)
+    {
+        torrentsWithTrackers.unite(i.value());
+
+        const TrackerID id = TrackerRegistry::id(i.key());
+        const auto iter = m_stats.constFind(id);
+        if ((iter != m_stats.cend()) && isSuppressedAt(iter->suppressedUntil, now))
+        {
+            for (const InfoHash &hash : i.value())
+                suppressedTrackers[hash].append(i.key());
+            continue;
+        }
+
+        const QString trackerHost = host(id);
+        for (const InfoHash &hash : i.value())
+            torrentHosts[hash].insert(trackerHost);
+    }
+
+    QHash<QString, int> hostLoad; // <host, announces scheduled so far>
+
+    for (TorrentImpl *torrent : torrents)
+    {
+        // dormant torrents have nothing to announce
+        if (torrent->isDormant())
+            continue;
+
+        const auto hostsIter = torrentHosts.constFind(torrent->hash());
+        if (hostsIter == torrentHosts.cend())
+        {
+            // every tracker of the torrent is down
+            if (torrentsWithTrackers.contains(torrent->hash()))
+                continue;
+
+            torrent->nativeHandle().force_reannounce();
+            continue;
+        }
+
+        // Delay the torrent until every host it announces to has a free slot
+        int delay = 0;
+        for (const QString &trackerHost : hostsIter.value())
+            delay = std::max(delay, (hostLoad.value(trackerHost) / MAX_ANNOUNCES_PER_HOST_PER_SEC));
+        for (const QString &trackerHost : hostsIter.value())
+            ++hostLoad[trackerHost];
+
+        torrent->nativeHandle().force_reannounce(delay);
+
+        // The re-announce above covers every tracker, put the suppressed ones back to the end of their backoff
+        for (const QString &url : asConst(suppressedTrackers.value(torrent->hash())))
+            torrent->rescheduleTrackerAnnounce(url, remainingBackoff(url));
+    }
+}
+
+QString TrackerAnnounceCoordinator::host(const TrackerID id)
+{
+    auto iter = m_hosts.find(id);
+    if (iter == m_hosts.end())
+        iter = m_hosts.insert(id, QUrl(TrackerRegistry::url(id)).host());
+    return iter.value();
+}
+
+void TrackerAnnounceCoordinator::purgeStaleAnnounces()
+{
+    const qint64 expiryTime = QDateTime::currentMSecsSinceEpoch() - ANNOUNCE_TIMEOUT;
+    for (auto i = m_pendingAnnounces.begin(); i != m_pendingAnnounces.end();)
+    {
+        if (i.value() < expiryTime)
+            i = m_pendingAnnounces.erase(i);
+        else
+            ++i;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    Algorithm::removeIf(m_nextHostSlots, [now](const QString &, const qint64 slot) { return (slot < now); });
+
+    // Trackers no torrent uses anymore leave the registry, their statistics go with them
+    TrackerRegistry::releaseUnused();
+    Algorithm::removeIf(m_stats, [](const TrackerID id, const Stats &) { return !TrackerRegistry::contains(id); });
+    Algorithm::removeIf(m_hosts, [](const TrackerID id, const QString &) { return !TrackerRegistry::contains(id); });
+}
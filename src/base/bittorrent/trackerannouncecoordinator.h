@@ -0,0 +1,123 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "infohash.h"
+#include "trackerregistry.h"
+
+class QTimer;
+
+namespace BitTorrent
+{
+    class TorrentImpl;
+
+    struct TrackerHealth
+    {
+        QString url;
+        int announces = 0;
+        int replies = 0;
+        int failures = 0;
+        int consecutiveFailures = 0;
+        qint64 averageLatency = -1; // msecs
+        qint64 lastLatency = -1; // msecs
+        QString lastError;
+        QDateTime lastReplyTime;
+        QDateTime lastFailureTime;
+        QDateTime suppressedUntil; // invalid unless announces are suppressed
+    };
+
+    // Collects announce results for every tracker across all torrents. A tracker
+    // that keeps failing from every local endpoint is put in an exponential backoff,
+    // until which the torrents using it postpone their announces to it. Session-wide
+    // re-announces are spread over time so that torrents sharing a host do not hit it
+    // all at once.
+    class TrackerAnnounceCoordinator final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TrackerAnnounceCoordinator)
+
+    public:
+        explicit TrackerAnnounceCoordinator(QObject *parent = nullptr);
+
+        void handleAnnounce(const InfoHash &hash, const QString &url);
+        // 'endpoint' is the local endpoint the announce was made from
+        void handleReply(const InfoHash &hash, const QString &url, const QString &endpoint);
+        void handleFailure(const InfoHash &hash, const QString &url, const QString &endpoint, const QString &message);
+
+        bool isSuppressed(const QString &url) const;
+        // Seconds until the backoff of the tracker ends, 0 if it isn't suppressed
+        int remainingBackoff(const QString &url) const;
+        // Seconds from now of the next free announce slot of the tracker's host. The slot is taken.
+        int takeAnnounceSlot(const QString &url);
+        QVector<TrackerHealth> health() const;
+
+        void reannounce(const QVector<TorrentImpl *> &torrents, const QHash<QString, QSet<InfoHash>> &trackerIndex);
+
+    signals:
+        // The tracker was put in backoff or got out of it before the backoff ended
+        void suppressionChanged(const QString &url);
+
+    private:
+        struct Stats
+        {
+            int announces = 0;
+            int replies = 0;
+            int failures = 0;
+            int consecutiveFailures = 0;
+            int backoffCount = 0;
+            qint64 averageLatency = -1;
+            qint64 lastLatency = -1;
+            QString lastError;
+            qint64 lastReplyTime = 0;
+            qint64 lastFailureTime = 0;
+            qint64 suppressedUntil = 0;
+            // consecutive failures of each local endpoint and when it last announced
+            QHash<QString, QPair<int, qint64>> endpoints;
+        };
+
+        using AnnounceKey = QPair<InfoHash, TrackerID>;
+
+        QString host(TrackerID id);
+        void purgeStaleAnnounces();
+
+        QHash<TrackerID, Stats> m_stats;
+        QHash<TrackerID, QString> m_hosts;
+        QHash<QString, qint64> m_nextHostSlots; // <host, msecs since epoch>
+        QHash<AnnounceKey, qint64> m_pendingAnnounces; // <torrent/tracker, announce time>
+        QTimer *m_purgeTimer;
+    };
+}
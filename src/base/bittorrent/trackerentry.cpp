@@ -32,132 +32,138 @@
 
 #include <libtorrent/version.hpp>
 
-#include <QString>
 #include <QUrl>
 
+#include "trackerregistry.h"
+
 using namespace BitTorrent;
 
+namespace
+{
+    TrackerEntry::Status nativeStatus(const lt::announce_entry &nativeEntry)
+    {
+        const auto &endpoints = nativeEntry.endpoints;
+
+        const bool allFailed = !endpoints.empty() && std::all_of(endpoints.begin(), endpoints.end()
+            , [](const lt::announce_endpoint &endpoint)
+        {
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+            return std::all_of(endpoint.info_hashes.begin(), endpoint.info_hashes.end()
+                , [](const lt::announce_infohash &infohash)
+                {
+                    return (infohash.fails > 0);
+                });
+#else
+            return (endpoint.fails > 0);
+#endif
+        });
+        if (allFailed)
+            return TrackerEntry::NotWorking;
+
+        const bool isUpdating = std::any_of(endpoints.begin(), endpoints.end()
+            , [](const lt::announce_endpoint &endpoint)
+        {
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+            return std::any_of(endpoint.info_hashes.begin(), endpoint.info_hashes.end()
+                , [](const lt::announce_infohash &infohash)
+                {
+                    return infohash.updating;
+                });
+#else
+            return endpoint.updating;
+#endif
+        });
+        if (isUpdating)
+            return TrackerEntry::Updating;
+
+        if (!nativeEntry.verified)
+            return TrackerEntry::NotContacted;
+
+        return TrackerEntry::Working;
+    }
+}
+
 TrackerEntry::TrackerEntry(const QString &url)
-    : m_nativeEntry(url.toStdString())
+    : m_url(TrackerRegistry::intern(url))
 {
 }
 
 TrackerEntry::TrackerEntry(const lt::announce_entry &nativeEntry)
-    : m_nativeEntry(nativeEntry)
+    : m_url(TrackerRegistry::intern(QString::fromStdString(nativeEntry.url)))
+    , m_tier(nativeEntry.tier)
+    , m_status(nativeStatus(nativeEntry))
 {
+    for (const lt::announce_endpoint &endpoint : nativeEntry.endpoints)
+    {
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+        for (const lt::announce_infohash &infoHash : endpoint.info_hashes)
+        {
+            m_numSeeds = std::max(m_numSeeds, infoHash.scrape_complete);
+            m_numLeeches = std::max(m_numLeeches, infoHash.scrape_incomplete);
+            m_numDownloaded = std::max(m_numDownloaded, infoHash.scrape_downloaded);
+        }
+#else
+        m_numSeeds = std::max(m_numSeeds, endpoint.scrape_complete);
+        m_numLeeches = std::max(m_numLeeches, endpoint.scrape_incomplete);
+        m_numDownloaded = std::max(m_numDownloaded, endpoint.scrape_downloaded);
+#endif
+    }
 }
 
 QString TrackerEntry::url() const
 {
-    return QString::fromStdString(nativeEntry().url);
+    return m_url;
 }
 
 int TrackerEntry::tier() const
 {
-    return nativeEntry().tier;
+    return m_tier;
 }
 
 TrackerEntry::Status TrackerEntry::status() const
 {
-    const auto &endpoints = nativeEntry().endpoints;
-
-    const bool allFailed = !endpoints.empty() && std::all_of(endpoints.begin(), endpoints.end()
-        , [](const lt::announce_endpoint &endpoint)
-    {
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-        return std::all_of(endpoint.info_hashes.begin(), endpoint.info_hashes.end()
-            , [](const lt::announce_infohash &infohash)
-            {
-                return (infohash.fails > 0);
-            });
-#else
-        return (endpoint.fails > 0);
-#endif
-    });
-    if (allFailed)
-        return NotWorking;
-
-    const bool isUpdating = std::any_of(endpoints.begin(), endpoints.end()
-        , [](const lt::announce_endpoint &endpoint)
-    {
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-        return std::any_of(endpoint.info_hashes.begin(), endpoint.info_hashes.end()
-            , [](const lt::announce_infohash &infohash)
-            {
-                return infohash.updating;
-            });
-#else
-        return endpoint.updating;
-#endif
-    });
-    if (isUpdating)
-        return Updating;
-
-    if (!nativeEntry().verified)
-        return NotContacted;
+    return m_status;
+}
 
-    return Working;
+void TrackerEntry::setStatus(const Status value)
+{
+    m_status = value;
 }
 
 void TrackerEntry::setTier(const int value)
 {
-    m_nativeEntry.tier = value;
+    m_tier = value;
 }
 
 int TrackerEntry::numSeeds() const
 {
-    int value = -1;
-    for (const lt::announce_endpoint &endpoint : nativeEntry().endpoints)
-    {
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-        for (const lt::announce_infohash &infoHash : endpoint.info_hashes)
-            value = std::max(value, infoHash.scrape_complete);
-#else
-        value = std::max(value, endpoint.scrape_complete);
-#endif
-    }
-    return value;
+    return m_numSeeds;
 }
 
 int TrackerEntry::numLeeches() const
 {
-    int value = -1;
-    for (const lt::announce_endpoint &endpoint : nativeEntry().endpoints)
-    {
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-        for (const lt::announce_infohash &infoHash : endpoint.info_hashes)
-            value = std::max(value, infoHash.scrape_incomplete);
-#else
-        value = std::max(value, endpoint.scrape_incomplete);
-#endif
-    }
-    return value;
+    return m_numLeeches;
 }
 
 int TrackerEntry::numDownloaded() const
 {
-    int value = -1;
-    for (const lt::announce_endpoint &endpoint : nativeEntry().endpoints)
-    {
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-        for (const lt::announce_infohash &infoHash : endpoint.info_hashes)
-            value = std::max(value, infoHash.scrape_downloaded);
-#else
-        value = std::max(value, endpoint.scrape_downloaded);
-#endif
-    }
-    return value;
+    return m_numDownloaded;
 }
 
-const lt::announce_entry &TrackerEntry::nativeEntry() const
+lt::announce_entry TrackerEntry::nativeEntry() const
 {
-    return m_nativeEntry;
+    lt::announce_entry nativeEntry {m_url.toStdString()};
+    nativeEntry.tier = static_cast<std::uint8_t>(m_tier);
+    return nativeEntry;
 }
 
 bool BitTorrent::operator==(const TrackerEntry &left, const TrackerEntry &right)
 {
-    return ((left.tier() == right.tier())
-        && QUrl(left.url()) == QUrl(right.url()));
+    if (left.tier() != right.tier())
+        return false;
+
+    // Interned URLs usually share their data, so try the cheap comparison first
+    return ((left.url() == right.url()) || (QUrl(left.url()) == QUrl(right.url())));
 }
 
 uint BitTorrent::qHash(const TrackerEntry &key, const uint seed)
@@ -30,12 +30,13 @@
 
 #include <libtorrent/announce_entry.hpp>
 
-#include <QtGlobal>
-
-class QString;
+#include <QString>
 
 namespace BitTorrent
 {
+    // Compact snapshot of a tracker. The URL is interned in TrackerRegistry
+    // and the announce state is reduced to a few integers, so a copy of the
+    // tracker list can be held for every torrent.
     class TrackerEntry
     {
     public:
@@ -55,6 +56,7 @@ namespace BitTorrent
 
         QString url() const;
         Status status() const;
+        void setStatus(Status value);
 
         int tier() const;
         void setTier(int value);
@@ -63,10 +65,15 @@ namespace BitTorrent
         int numLeeches() const;
         int numDownloaded() const;
 
-        const lt::announce_entry &nativeEntry() const;
+        lt::announce_entry nativeEntry() const;
 
     private:
-        lt::announce_entry m_nativeEntry;
+        QString m_url;
+        int m_tier = 0;
+        Status m_status = NotContacted;
+        int m_numSeeds = -1;
+        int m_numLeeches = -1;
+        int m_numDownloaded = -1;
     };
 
     bool operator==(const TrackerEntry &left, const TrackerEntry &right);
@@ -0,0 +1,190 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "trackerregistry.h"
+
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QWriteLocker>
+
+using namespace BitTorrent;
+
+namespace
+{
+    struct Entry
+    {
+        QString url;
+        int references = 0;
+    };
+
+    struct Registry
+    {
+        QReadWriteLock lock;
+        QHash<QString, TrackerID> ids;
+        QHash<TrackerID, Entry> entries;
+        TrackerID nextID = 0;
+    };
+
+    Registry &registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    // Expects the write lock to be held
+    TrackerID registerURL(Registry &reg, const QString &url)
+    {
+        const auto iter = reg.ids.constFind(url);
+        if (iter != reg.ids.cend())
+            return iter.value();
+
+        const TrackerID id = reg.nextID++;
+        reg.entries.insert(id, {url, 0});
+        reg.ids.insert(url, id);
+        return id;
+    }
+
+    // Expects the write lock to be held
+    void removeEntry(Registry &reg, const TrackerID id)
+    {
+        reg.ids.remove(reg.entries.take(id).url);
+    }
+
+    qint64 stringBytes(const QString &str)
+    {
+        return (str.capacity() * static_cast<qint64>(sizeof(QChar)));
+    }
+}
+
+TrackerID TrackerRegistry::id(const QString &url)
+{
+    Registry &reg = registry();
+    {
+        const QReadLocker locker {&reg.lock};
+        const auto iter = reg.ids.constFind(url);
+        if (iter != reg.ids.cend())
+            return iter.value();
+    }
+
+    const QWriteLocker locker {&reg.lock};
+    return registerURL(reg, url);
+}
+
+QString TrackerRegistry::url(const TrackerID id)
+{
+    Registry &reg = registry();
+    const QReadLocker locker {&reg.lock};
+    return reg.entries.value(id).url;
+}
+
+bool TrackerRegistry::contains(const TrackerID id)
+{
+    Registry &reg = registry();
+    const QReadLocker locker {&reg.lock};
+    return reg.entries.contains(id);
+}
+
+QString TrackerRegistry::intern(const QString &url)
+{
+    if (url.isEmpty())
+        return {};
+
+    Registry &reg = registry();
+    {
+        const QReadLocker locker {&reg.lock};
+        const auto iter = reg.ids.constFind(url);
+        if (iter != reg.ids.cend())
+            return reg.entries.value(iter.value()).url;
+    }
+
+    const QWriteLocker locker {&reg.lock};
+    return reg.entries[registerURL(reg, url)].url;
+}
+
+void TrackerRegistry::addReference(const QString &url)
+{
+    if (url.isEmpty())
+        return;
+
+    Registry &reg = registry();
+    const QWriteLocker locker {&reg.lock};
+    ++reg.entries[registerURL(reg, url)].references;
+}
+
+void TrackerRegistry::releaseReference(const QString &url)
+{
+    Registry &reg = registry();
+    const QWriteLocker locker {&reg.lock};
+
+    const auto idIter = reg.ids.constFind(url);
+    if (idIter == reg.ids.cend())
+        return;
+
+    const TrackerID id = idIter.value();
+    Entry &entry = reg.entries[id];
+    if (--entry.references <= 0)
+        removeEntry(reg, id);
+}
+
+void TrackerRegistry::releaseUnused()
+{
+    Registry &reg = registry();
+    const QWriteLocker locker {&reg.lock};
+
+    for (auto iter = reg.entries.begin(); iter != reg.entries.end();)
+    {
+        if (iter->references <= 0)
+        {
+            reg.ids.remove(iter->url);
+            iter = reg.entries.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+TrackerRegistry::Statistics TrackerRegistry::statistics()
+{
+    Registry &reg = registry();
+    const QReadLocker locker {&reg.lock};
+
+    Statistics stats;
+    stats.urlCount = reg.entries.size();
+    for (const Entry &entry : reg.entries)
+    {
+        const qint64 bytes = stringBytes(entry.url);
+        stats.references += entry.references;
+        stats.urlBytes += bytes;
+        if (entry.references > 1)
+            stats.savedBytes += (entry.references - 1) * bytes;
+    }
+    return stats;
+}
@@ -0,0 +1,69 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+namespace BitTorrent
+{
+    using TrackerID = int;
+
+    // Process-wide table of tracker URLs. Every URL is stored once and identified
+    // by a small integer, so the same tracker added to thousands of torrents
+    // shares a single string. Ids are never reused. The torrents hold a reference
+    // on the trackers they use, unreferenced entries are dropped by releaseUnused().
+    // Thread-safe.
+    class TrackerRegistry
+    {
+    public:
+        struct Statistics
+        {
+            int urlCount = 0;
+            qint64 references = 0;
+            qint64 urlBytes = 0; // the strings held by the registry
+            qint64 savedBytes = 0; // what the references would take as separate copies
+        };
+
+        TrackerRegistry() = delete;
+
+        static TrackerID id(const QString &url);
+        static QString url(TrackerID id);
+        static bool contains(TrackerID id);
+        // Returns the shared copy of `url`, registering it if needed
+        static QString intern(const QString &url);
+
+        static void addReference(const QString &url);
+        static void releaseReference(const QString &url);
+        // Drops the entries that no torrent references, e.g. those of URLs that were only looked up
+        static void releaseUnused();
+
+        static Statistics statistics();
+    };
+}
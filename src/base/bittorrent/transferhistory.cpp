@@ -0,0 +1,526 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "transferhistory.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QMetaObject>
+#include <QPair>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+#include "session.h"
+#include "sessionstatus.h"
+#include "torrent.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    const int SAMPLE_INTERVAL = 1000; // ms
+    const qint64 SAVE_INTERVAL = 15 * 60; // s
+    const int BLOCK_SIZE = 256;
+
+    const char HISTORY_FILENAME[] = "transferhistory.dat";
+    const quint32 HISTORY_FILE_MAGIC = 0x71425448;
+    // version 2 adds the averages in progress
+    const qint32 HISTORY_FILE_VERSION = 2;
+
+    struct TierInfo
+    {
+        int resolution; // s
+        qint64 retention; // s
+    };
+
+    const TierInfo TIERS[] =
+    {
+        {1, 60 * 60},
+        {60, 24 * 60 * 60},
+        {15 * 60, 30 * 24 * 60 * 60}
+    };
+    const int TIER_COUNT = static_cast<int>(std::size(TIERS));
+    const int TORRENT_FIRST_TIER = 1;
+
+    QString historyFilePath()
+    {
+        return specialFolderLocation(SpecialFolder::Data) + QLatin1String(HISTORY_FILENAME);
+    }
+
+    // Zigzag encoded varint, the deltas between consecutive rates mostly fit in a byte or two
+    void appendVarint(QByteArray &data, const qint64 value)
+    {
+        quint64 encoded = (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+        while (encoded >= 0x80)
+        {
+            data.append(static_cast<char>((encoded & 0x7F) | 0x80));
+            encoded >>= 7;
+        }
+        data.append(static_cast<char>(encoded));
+    }
+
+    qint64 readVarint(const QByteArray &data, int &pos)
+    {
+        quint64 encoded = 0;
+        for (int shift = 0; (pos < data.size()) && (shift < 64); shift += 7)
+        {
+            const auto byte = static_cast<quint8>(data[pos++]);
+            encoded |= (static_cast<quint64>(byte & 0x7F) << shift);
+            if (!(byte & 0x80))
+                break;
+        }
+        return static_cast<qint64>(encoded >> 1) ^ -static_cast<qint64>(encoded & 1);
+    }
+}
+
+TransferHistory::TransferHistory(Session *session)
+    : QObject(session)
+    , m_session(session)
+    , m_ioThread(new QThread(this))
+    , m_writer(new QObject)
+{
+    load();
+
+    m_writer->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    m_ioThread->start();
+
+    connect(m_session, &Session::torrentAboutToBeRemoved, this, &TransferHistory::handleTorrentAboutToBeRemoved);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &TransferHistory::sample);
+    m_sampleTimer.start(SAMPLE_INTERVAL);
+
+    m_lastSave = QDateTime::currentSecsSinceEpoch();
+}
+
+TransferHistory::~TransferHistory()
+{
+    // a save still pending is superseded by the last one
+    m_ioThread->quit();
+    m_ioThread->wait();
+
+    save();
+}
+
+QString TransferHistory::globalSeries()
+{
+    return QLatin1String("global");
+}
+
+QString TransferHistory::categorySeries(const QString &category)
+{
+    return (QLatin1String("category:") + category);
+}
+
+QString TransferHistory::torrentSeries(const InfoHash &hash)
+{
+    return (QLatin1String("torrent:") + QString(hash));
+}
+
+QVector<TransferRatePoint> TransferHistory::points(const QString &series, const qint64 from, const qint64 to
+    , const int resolution, int *actualResolution) const
+{
+    const auto seriesIter = m_series.constFind(series);
+    if (seriesIter == m_series.cend())
+    {
+        if (actualResolution)
+            *actualResolution = resolution;
+        return {};
+    }
+
+    // The finest tier that goes back to 'from'. If none does, the one that goes back the furthest,
+    // the finest of them in case of a tie. Then a coarser one as long as it isn't coarser than requested.
+    int tier = seriesIter->firstTier;
+    qint64 oldestStart = std::numeric_limits<qint64>::max();
+    for (int i = seriesIter->firstTier; i < TIER_COUNT; ++i)
+    {
+        const QVector<Block> &blocks = seriesIter->tiers[i];
+        if (blocks.isEmpty() || (blocks.first().start >= oldestStart))
+            continue;
+
+        tier = i;
+        oldestStart = blocks.first().start;
+        if (oldestStart <= from)
+            break;
+    }
+    while (((tier + 1) < TIER_COUNT) && (TIERS[tier + 1].resolution <= resolution))
+        ++tier;
+
+    const int tierResolution = TIERS[tier].resolution;
+    const int step = std::max(resolution, tierResolution);
+    if (actualResolution)
+        *actualResolution = step;
+
+    QVector<TransferRatePoint> result;
+    Accumulator accumulator;
+    const auto flush = [&result, &accumulator]()
+    {
+        if (accumulator.count > 0)
+        {
+            result.append({accumulator.interval, (accumulator.downloadSum / accumulator.count)
+                , (accumulator.uploadSum / accumulator.count)});
+        }
+    };
+
+    for (const Block &block : seriesIter->tiers[tier])
+    {
+        if (((block.start + (block.count * tierResolution)) <= from) || (block.start >= to))
+            continue;
+
+        int downloadPos = 0;
+        int uploadPos = 0;
+        qint64 downloadRate = 0;
+        qint64 uploadRate = 0;
+        for (int i = 0; i < block.count; ++i)
+        {
+            downloadRate += readVarint(block.downloadRates, downloadPos);
+            uploadRate += readVarint(block.uploadRates, uploadPos);
+
+            const qint64 time = block.start + (i * tierResolution);
+            if (time < from)
+                continue;
+            if (time >= to)
+                break;
+
+            const qint64 interval = time - (time % step);
+            if (interval != accumulator.interval)
+            {
+                flush();
+                accumulator = {};
+                accumulator.interval = interval;
+            }
+            accumulator.downloadSum += downloadRate;
+            accumulator.uploadSum += uploadRate;
+            ++accumulator.count;
+        }
+    }
+    flush();
+
+    return result;
+}
+
+void TransferHistory::sample()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    QHash<QString, QPair<qint64, qint64>> rates;
+
+    const SessionStatus &status = m_session->status();
+    rates[globalSeries()] = {static_cast<qint64>(status.payloadDownloadRate), static_cast<qint64>(status.payloadUploadRate)};
+
+    for (const Torrent *torrent : asConst(m_session->torrents()))
+    {
+        const qint64 downloadRate = torrent->downloadPayloadRate();
+        const qint64 uploadRate = torrent->uploadPayloadRate();
+        if ((downloadRate == 0) && (uploadRate == 0))
+            continue;
+
+        rates[torrentSeries(torrent->hash())] = {downloadRate, uploadRate};
+
+        const QString category = torrent->category();
+        if (!category.isEmpty())
+        {
+            QPair<qint64, qint64> &categoryRates = rates[categorySeries(category)];
+            categoryRates.first += downloadRate;
+            categoryRates.second += uploadRate;
+        }
+    }
+
+    // Idle series keep getting zeros until the averages they are part of are complete,
+    // then they only age until nothing is left of them
+    for (auto iter = m_series.begin(); iter != m_series.end();)
+    {
+        const bool isEmpty = removeExpired(*iter, now);
+        if (!rates.contains(iter.key()))
+        {
+            const bool hasPendingTransfer = std::any_of(iter->accumulators.cbegin(), iter->accumulators.cend()
+                , [](const Accumulator &accumulator)
+            {
+                return (accumulator.downloadSum > 0) || (accumulator.uploadSum > 0);
+            });
+
+            if (hasPendingTransfer)
+            {
+                addSample(*iter, now, 0, 0);
+            }
+            else if (isEmpty)
+            {
+                iter = m_series.erase(iter);
+                continue;
+            }
+        }
+
+        ++iter;
+    }
+
+    for (auto iter = rates.cbegin(); iter != rates.cend(); ++iter)
+    {
+        auto seriesIter = m_series.find(iter.key());
+        if (seriesIter == m_series.end())
+        {
+            Series series;
+            series.firstTier = iter.key().startsWith(QLatin1String("torrent:")) ? TORRENT_FIRST_TIER : 0;
+            series.tiers.resize(TIER_COUNT);
+            series.accumulators.resize(TIER_COUNT);
+            seriesIter = m_series.insert(iter.key(), series);
+        }
+
+        addSample(*seriesIter, now, iter->first, iter->second);
+    }
+
+    if ((now - m_lastSave) >= SAVE_INTERVAL)
+        save();
+}
+
+void TransferHistory::addSample(Series &series, const qint64 time, const qint64 downloadRate, const qint64 uploadRate)
+{
+    for (int i = series.firstTier; i < TIER_COUNT; ++i)
+    {
+        Accumulator &accumulator = series.accumulators[i];
+        const qint64 interval = time - (time % TIERS[i].resolution);
+        if (interval != accumulator.interval)
+        {
+            if (accumulator.count > 0)
+            {
+                appendPoint(series.tiers[i], i, accumulator.interval
+                    , (accumulator.downloadSum / accumulator.count), (accumulator.uploadSum / accumulator.count));
+            }
+
+            accumulator = {};
+            accumulator.interval = interval;
+        }
+
+        accumulator.downloadSum += downloadRate;
+        accumulator.uploadSum += uploadRate;
+        ++accumulator.count;
+    }
+}
+
+void TransferHistory::appendPoint(QVector<Block> &blocks, const int tier, const qint64 time
+    , const qint64 downloadRate, const qint64 uploadRate)
+{
+    const int resolution = TIERS[tier].resolution;
+
+    if (!blocks.isEmpty())
+    {
+        const Block &lastBlock = blocks.last();
+        const qint64 nextTime = lastBlock.start + (lastBlock.count * resolution);
+        // the clock went back
+        if (time < nextTime)
+            return;
+
+        if ((time > nextTime) || (lastBlock.count >= BLOCK_SIZE))
+            blocks.append({time});
+    }
+    else
+    {
+        blocks.append({time});
+    }
+
+    Block &block = blocks.last();
+    appendVarint(block.downloadRates, (downloadRate - block.lastDownloadRate));
+    appendVarint(block.uploadRates, (uploadRate - block.lastUploadRate));
+    block.lastDownloadRate = downloadRate;
+    block.lastUploadRate = uploadRate;
+    ++block.count;
+
+    removeExpired(blocks, tier, time);
+}
+
+void TransferHistory::removeExpired(QVector<Block> &blocks, const int tier, const qint64 now)
+{
+    const int resolution = TIERS[tier].resolution;
+    const qint64 oldestTime = now - TIERS[tier].retention;
+    while (!blocks.isEmpty() && ((blocks.first().start + (blocks.first().count * resolution)) <= oldestTime))
+        blocks.removeFirst();
+}
+
+// Returns whether nothing is left of the series
+bool TransferHistory::removeExpired(Series &series, const qint64 now)
+{
+    bool isEmpty = true;
+    for (int i = 0; i < TIER_COUNT; ++i)
+    {
+        removeExpired(series.tiers[i], i, now);
+        isEmpty = isEmpty && series.tiers[i].isEmpty();
+    }
+    return isEmpty;
+}
+
+void TransferHistory::handleTorrentAboutToBeRemoved(const Torrent *torrent)
+{
+    m_series.remove(torrentSeries(torrent->hash()));
+}
+
+void TransferHistory::load()
+{
+    QFile file {historyFilePath()};
+    if (!file.exists())
+        return;
+
+    if (!file.open(QFile::ReadOnly))
+    {
+        LogMsg(tr("Couldn't load the transfer history. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), file.errorString()), Log::WARNING);
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 tierCount = 0;
+    qint32 seriesCount = 0;
+    in >> magic >> version >> tierCount >> seriesCount;
+    if ((magic != HISTORY_FILE_MAGIC) || (version < 1) || (version > HISTORY_FILE_VERSION) || (tierCount != TIER_COUNT))
+    {
+        LogMsg(tr("Couldn't load the transfer history. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), tr("Unsupported format")), Log::WARNING);
+        return;
+    }
+
+    for (int s = 0; (s < seriesCount) && (in.status() == QDataStream::Ok); ++s)
+    {
+        QString id;
+        qint32 firstTier = 0;
+        in >> id >> firstTier;
+
+        Series series;
+        series.firstTier = std::clamp(firstTier, 0, (TIER_COUNT - 1));
+        series.tiers.resize(TIER_COUNT);
+        series.accumulators.resize(TIER_COUNT);
+
+        for (QVector<Block> &blocks : series.tiers)
+        {
+            qint32 blockCount = 0;
+            in >> blockCount;
+            for (int b = 0; (b < blockCount) && (in.status() == QDataStream::Ok); ++b)
+            {
+                Block block;
+                qint32 count = 0;
+                in >> block.start >> count >> block.lastDownloadRate >> block.lastUploadRate
+                    >> block.downloadRates >> block.uploadRates;
+                block.count = count;
+                blocks.append(block);
+            }
+        }
+
+        if (version >= 2)
+        {
+            for (Accumulator &accumulator : series.accumulators)
+            {
+                qint32 count = 0;
+                in >> accumulator.interval >> accumulator.downloadSum >> accumulator.uploadSum >> count;
+                accumulator.count = count;
+            }
+        }
+
+        m_series.insert(id, series);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        m_series.clear();
+        LogMsg(tr("Couldn't load the transfer history. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), tr("Corrupted data")), Log::WARNING);
+    }
+}
+
+void TransferHistory::save()
+{
+    m_lastSave = QDateTime::currentSecsSinceEpoch();
+
+    // series that expired while idle aren't worth keeping across a restart
+    for (auto iter = m_series.begin(); iter != m_series.end();)
+    {
+        const bool hasPendingTransfer = std::any_of(iter->accumulators.cbegin(), iter->accumulators.cend()
+            , [](const Accumulator &accumulator) { return (accumulator.count > 0); });
+        if (removeExpired(*iter, m_lastSave) && !hasPendingTransfer)
+            iter = m_series.erase(iter);
+        else
+            ++iter;
+    }
+
+    if (!m_ioThread->isRunning())
+    {
+        write(m_series);
+        return;
+    }
+
+    // the copy is implicitly shared, the sampling only detaches what it changes
+    const QHash<QString, Series> seriesByID = m_series;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 10, 0))
+    QMetaObject::invokeMethod(m_writer, [seriesByID]() { write(seriesByID); }, Qt::QueuedConnection);
+#else
+    QTimer::singleShot(0, m_writer, [seriesByID]() { write(seriesByID); });
+#endif
+}
+
+void TransferHistory::write(const QHash<QString, Series> &seriesByID)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+
+    out << HISTORY_FILE_MAGIC << HISTORY_FILE_VERSION << static_cast<qint32>(TIER_COUNT)
+        << static_cast<qint32>(seriesByID.size());
+    for (auto iter = seriesByID.cbegin(); iter != seriesByID.cend(); ++iter)
+    {
+        out << iter.key() << static_cast<qint32>(iter->firstTier);
+        for (const QVector<Block> &blocks : iter->tiers)
+        {
+            out << static_cast<qint32>(blocks.size());
+            for (const Block &block : blocks)
+            {
+                out << block.start << static_cast<qint32>(block.count) << block.lastDownloadRate << block.lastUploadRate
+                    << block.downloadRates << block.uploadRates;
+            }
+        }
+        for (const Accumulator &accumulator : iter->accumulators)
+        {
+            out << accumulator.interval << accumulator.downloadSum << accumulator.uploadSum
+                << static_cast<qint32>(accumulator.count);
+        }
+    }
+
+    QSaveFile file {historyFilePath()};
+    if (!file.open(QFile::WriteOnly) || (file.write(data) == -1) || !file.commit())
+    {
+        LogMsg(tr("Couldn't save the transfer history. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), file.errorString()), Log::WARNING);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include "infohash.h"
+
+class QThread;
+
+namespace BitTorrent
+{
+    class Session;
+    class Torrent;
+
+    struct TransferRatePoint
+    {
+        qint64 timestamp = 0; // start of the interval, seconds since epoch
+        qint64 downloadRate = 0;
+        qint64 uploadRate = 0;
+    };
+
+    // Keeps the history of the payload transfer rates of the session, of each category
+    // and of each torrent. Recent samples are kept at full resolution, older ones only as
+    // averages over longer intervals. The samples are stored delta encoded in blocks,
+    // one column per rate, and the history is saved on disk to survive restarts.
+    // The periodic saves serialize and write a copy of the history in a thread of their own.
+    class TransferHistory final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(TransferHistory)
+
+    public:
+        explicit TransferHistory(Session *session);
+        ~TransferHistory() override;
+
+        static QString globalSeries();
+        static QString categorySeries(const QString &category);
+        static QString torrentSeries(const InfoHash &hash);
+
+        // Points of the series in [from, to) averaged over 'resolution' seconds at least.
+        // The resolution actually used is coarser if the requested one isn't kept that far back.
+        QVector<TransferRatePoint> points(const QString &series, qint64 from, qint64 to
+            , int resolution, int *actualResolution = nullptr) const;
+
+    private:
+        struct Block
+        {
+            qint64 start = 0;
+            int count = 0;
+            qint64 lastDownloadRate = 0;
+            qint64 lastUploadRate = 0;
+            QByteArray downloadRates;
+            QByteArray uploadRates;
+        };
+
+        struct Accumulator
+        {
+            qint64 interval = -1;
+            qint64 downloadSum = 0;
+            qint64 uploadSum = 0;
+            int count = 0;
+        };
+
+        struct Series
+        {
+            // torrents aren't kept at the finest resolution
+            int firstTier = 0;
+            QVector<QVector<Block>> tiers;
+            QVector<Accumulator> accumulators;
+        };
+
+        void sample();
+        void addSample(Series &series, qint64 time, qint64 downloadRate, qint64 uploadRate);
+        void appendPoint(QVector<Block> &blocks, int tier, qint64 time, qint64 downloadRate, qint64 uploadRate);
+        static void removeExpired(QVector<Block> &blocks, int tier, qint64 now);
+        static bool removeExpired(Series &series, qint64 now);
+        void handleTorrentAboutToBeRemoved(const Torrent *torrent);
+        void load();
+        void save();
+        static void write(const QHash<QString, Series> &seriesByID);
+
+        Session *m_session = nullptr;
+        QHash<QString, Series> m_series;
+        QTimer m_sampleTimer;
+        qint64 m_lastSave = 0;
+        QThread *m_ioThread = nullptr;
+        // lives in m_ioThread, the saves are run in its context
+        QObject *m_writer = nullptr;
+    };
+}
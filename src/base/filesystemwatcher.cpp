@@ -28,6 +28,8 @@
 
 #include "filesystemwatcher.h"
 
+#include <algorithm>
+
 #include <QtGlobal>
 
 #if defined(Q_OS_MACOS) || defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD)
@@ -36,8 +38,20 @@
 #include <sys/param.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#endif
+
 #include "base/algorithm.h"
-#include "base/bittorrent/torrentinfo.h"
 #include "base/global.h"
 #include "base/logger.h"
 #include "base/utils/fs.h"
@@ -46,6 +60,55 @@ namespace
 {
     const int WATCH_INTERVAL = 10000; // 10 sec
     const int MAX_PARTIAL_RETRIES = 5;
+    const int PENDING_FILES_DELAY = 500; // 0.5 sec
+    const int MAX_LOADER_THREADS = 4;
+
+    const int WatchedTorrentFileVectorTypeId = qRegisterMetaType<QVector<WatchedTorrentFile>>();
+
+#ifdef Q_OS_LINUX
+    bool isWatchedFileName(const QString &fileName)
+    {
+        return (fileName.endsWith(QLatin1String(".torrent"), Qt::CaseInsensitive)
+                || fileName.endsWith(QLatin1String(".magnet"), Qt::CaseInsensitive));
+    }
+#endif
+}
+
+void WatchedTorrentFileLoader::load(const QStringList &paths)
+{
+    QVector<WatchedTorrentFile> files;
+    files.reserve(paths.size());
+
+    for (const QString &path : paths)
+    {
+        WatchedTorrentFile file;
+        file.path = path;
+
+        if (path.endsWith(QLatin1String(".magnet"), Qt::CaseInsensitive))
+        {
+            QFile magnetFile {path};
+            if (magnetFile.open(QIODevice::ReadOnly | QIODevice::Text))
+            {
+                QTextStream str {&magnetFile};
+                while (!str.atEnd())
+                    file.magnetURIs << str.readLine();
+                file.isValid = true;
+            }
+            else
+            {
+                qDebug("Failed to open magnet file: %s", qUtf8Printable(magnetFile.errorString()));
+            }
+        }
+        else
+        {
+            file.torrentInfo = BitTorrent::TorrentInfo::loadFromFile(path);
+            file.isValid = file.torrentInfo.isValid();
+        }
+
+        files << file;
+    }
+
+    emit loaded(files);
 }
 
 FileSystemWatcher::FileSystemWatcher(QObject *parent)
@@ -57,11 +120,59 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent)
     connect(&m_partialTorrentTimer, &QTimer::timeout, this, &FileSystemWatcher::processPartialTorrents);
 
     connect(&m_watchTimer, &QTimer::timeout, this, &FileSystemWatcher::scanNetworkFolders);
+
+    m_pendingFilesTimer.setSingleShot(true);
+    m_pendingFilesTimer.setInterval(PENDING_FILES_DELAY);
+    connect(&m_pendingFilesTimer, &QTimer::timeout, this, &FileSystemWatcher::processPendingFiles);
+
+    const int loaderCount = std::min(std::max(QThread::idealThreadCount(), 1), MAX_LOADER_THREADS);
+    for (int i = 0; i < loaderCount; ++i)
+    {
+        auto *thread = new QThread(this);
+        auto *loader = new WatchedTorrentFileLoader;
+        loader->moveToThread(thread);
+        connect(thread, &QThread::finished, loader, &QObject::deleteLater);
+        connect(loader, &WatchedTorrentFileLoader::loaded, this, &FileSystemWatcher::handleFilesLoaded);
+        thread->start();
+
+        m_loaderThreads << thread;
+        m_loaders << loader;
+    }
+
+#ifdef Q_OS_LINUX
+    m_inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFD >= 0)
+    {
+        m_inotifyNotifier = new QSocketNotifier(m_inotifyFD, QSocketNotifier::Read, this);
+        connect(m_inotifyNotifier, &QSocketNotifier::activated, this, &FileSystemWatcher::readInotifyEvents);
+    }
+#endif
+}
+
+FileSystemWatcher::~FileSystemWatcher()
+{
+    for (QThread *thread : asConst(m_loaderThreads))
+    {
+        thread->quit();
+        thread->wait();
+    }
+
+#ifdef Q_OS_LINUX
+    if (m_inotifyFD >= 0)
+    {
+        delete m_inotifyNotifier;
+        ::close(m_inotifyFD);
+    }
+#endif
 }
 
 QStringList FileSystemWatcher::directories() const
 {
     QStringList dirs = QFileSystemWatcher::directories();
+#ifdef Q_OS_LINUX
+    for (const QString &path : asConst(m_inotifyWatches))
+        dirs << path;
+#endif
     for (const QDir &dir : asConst(m_watchedFolders))
         dirs << dir.canonicalPath();
     return dirs;
@@ -89,6 +200,13 @@ void FileSystemWatcher::addPath(const QString &path)
 
     // Normal mode
     LogMsg(tr("Watching local folder: \"%1\"").arg(Utils::Fs::toNativePath(path)));
+#ifdef Q_OS_LINUX
+    if (addInotifyWatch(path))
+    {
+        processTorrentsInDir(path);
+        return;
+    }
+#endif
     QFileSystemWatcher::addPath(path);
     scanLocalFolder(path);
 }
@@ -102,6 +220,16 @@ void FileSystemWatcher::removePath(const QString &path)
         return;
     }
 
+#ifdef Q_OS_LINUX
+    const int wd = m_inotifyWatches.key(path, -1);
+    if (wd >= 0)
+    {
+        inotify_rm_watch(m_inotifyFD, wd);
+        m_inotifyWatches.remove(wd);
+        return;
+    }
+#endif
+
     // Normal mode
     QFileSystemWatcher::removePath(path);
 }
@@ -119,65 +247,181 @@ void FileSystemWatcher::scanNetworkFolders()
 
 void FileSystemWatcher::processPartialTorrents()
 {
-    QStringList noLongerPartial;
-
     // Check which torrents are still partial
-    Algorithm::removeIf(m_partialTorrents, [&noLongerPartial](const QString &torrentPath, int &value)
+    QStringList partialTorrents;
+    for (auto i = m_partialTorrents.cbegin(); i != m_partialTorrents.cend(); ++i)
+    {
+        if (!m_loadingFiles.contains(i.key()))
+            partialTorrents << i.key();
+    }
+
+    loadFiles(partialTorrents);
+}
+
+void FileSystemWatcher::processPendingFiles()
+{
+    const QStringList files = m_pendingFiles.values();
+    m_pendingFiles.clear();
+
+    QStringList newFiles;
+    for (const QString &file : files)
+    {
+        if (!m_loadingFiles.contains(file) && !m_partialTorrents.contains(file))
+            newFiles << file;
+    }
+
+    loadFiles(newFiles);
+}
+
+void FileSystemWatcher::loadFiles(const QStringList &paths)
+{
+    if (paths.isEmpty())
+        return;
+
+    for (const QString &path : paths)
+        m_loadingFiles.insert(path);
+
+    // spread the work evenly across loaders
+    const int loaderCount = m_loaders.size();
+    const int batchSize = (paths.size() + loaderCount - 1) / loaderCount;
+    for (int i = 0; i < paths.size(); i += batchSize)
+    {
+        const QStringList batch = paths.mid(i, batchSize);
+        WatchedTorrentFileLoader *loader = m_loaders[m_nextLoader];
+        m_nextLoader = (m_nextLoader + 1) % loaderCount;
+
+        QMetaObject::invokeMethod(loader, "load", Qt::QueuedConnection, Q_ARG(QStringList, batch));
+    }
+}
+
+void FileSystemWatcher::handleFilesLoaded(const QVector<WatchedTorrentFile> &files)
+{
+    QVector<WatchedTorrentFile> torrents;
+    torrents.reserve(files.size());
+
+    for (const WatchedTorrentFile &file : files)
     {
-        if (!QFile::exists(torrentPath))
-            return true;
+        m_loadingFiles.remove(file.path);
 
-        if (BitTorrent::TorrentInfo::loadFromFile(torrentPath).isValid())
+        if (file.isValid)
         {
-            noLongerPartial << torrentPath;
-            return true;
+            m_partialTorrents.remove(file.path);
+            torrents << file;
+            continue;
         }
 
-        if (value >= MAX_PARTIAL_RETRIES)
+        if (!QFile::exists(file.path))
         {
-            QFile::rename(torrentPath, torrentPath + ".qbt_rejected");
-            return true;
+            m_partialTorrents.remove(file.path);
+            continue;
         }
 
-        ++value;
-        return false;
-    });
+        const auto partialIter = m_partialTorrents.find(file.path);
+        if (partialIter == m_partialTorrents.end())
+        {
+            m_partialTorrents[file.path] = 0;
+        }
+        else if (partialIter.value() >= MAX_PARTIAL_RETRIES)
+        {
+            m_partialTorrents.erase(partialIter);
+            QFile::rename(file.path, file.path + ".qbt_rejected");
+        }
+        else
+        {
+            ++partialIter.value();
+        }
+    }
 
-    // Stop the partial timer if necessary
+    // Restart or stop the partial timer if necessary
     if (m_partialTorrents.empty())
     {
         m_partialTorrentTimer.stop();
-        qDebug("No longer any partial torrent.");
     }
-    else
+    else if (!m_partialTorrentTimer.isActive())
     {
         qDebug("Still %d partial torrents after delayed processing.", m_partialTorrents.count());
         m_partialTorrentTimer.start(WATCH_INTERVAL);
     }
 
     // Notify of new torrents
-    if (!noLongerPartial.isEmpty())
-        emit torrentsAdded(noLongerPartial);
+    if (!torrents.isEmpty())
+        emit torrentsAdded(torrents);
 }
 
 void FileSystemWatcher::processTorrentsInDir(const QDir &dir)
 {
-    QStringList torrents;
     const QStringList files = dir.entryList({"*.torrent", "*.magnet"}, QDir::Files);
     for (const QString &file : files)
+        m_pendingFiles.insert(dir.absoluteFilePath(file));
+
+    processPendingFiles();
+}
+
+#ifdef Q_OS_LINUX
+bool FileSystemWatcher::addInotifyWatch(const QString &path)
+{
+    if (m_inotifyFD < 0)
+        return false;
+
+    // only react once a file is completely written or atomically moved in place
+    const int wd = inotify_add_watch(m_inotifyFD, QFile::encodeName(path).constData()
+        , (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR));
+    if (wd < 0)
+        return false;
+
+    m_inotifyWatches[wd] = path;
+    return true;
+}
+
+void FileSystemWatcher::readInotifyEvents()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true)
     {
-        const QString fileAbsPath = dir.absoluteFilePath(file);
-        if (file.endsWith(".magnet", Qt::CaseInsensitive))
-            torrents << fileAbsPath;
-        else if (BitTorrent::TorrentInfo::loadFromFile(fileAbsPath).isValid())
-            torrents << fileAbsPath;
-        else if (!m_partialTorrents.contains(fileAbsPath))
-            m_partialTorrents[fileAbsPath] = 0;
-    }
+        const ssize_t len = ::read(m_inotifyFD, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
 
-    if (!torrents.empty())
-        emit torrentsAdded(torrents);
+        for (const char *ptr = buffer; ptr < (buffer + len);)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
 
-    if (!m_partialTorrents.empty() && !m_partialTorrentTimer.isActive())
-        m_partialTorrentTimer.start(WATCH_INTERVAL);
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // some events were lost, fall back to scanning everything
+                for (const QString &path : asConst(m_inotifyWatches))
+                {
+                    const QDir dir {path};
+                    for (const QString &file : asConst(dir.entryList({"*.torrent", "*.magnet"}, QDir::Files)))
+                        m_pendingFiles.insert(dir.absoluteFilePath(file));
+                }
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED)
+            {
+                // watched folder was deleted or unmounted
+                m_inotifyWatches.remove(event->wd);
+                continue;
+            }
+
+            if (event->len == 0)
+                continue;
+
+            const auto watchIter = m_inotifyWatches.constFind(event->wd);
+            if (watchIter == m_inotifyWatches.cend())
+                continue;
+
+            const QString fileName = QFile::decodeName(event->name);
+            if (isWatchedFileName(fileName))
+                m_pendingFiles.insert(QDir(watchIter.value()).absoluteFilePath(fileName));
+        }
+    }
+
+    // batch the files of a burst together
+    if (!m_pendingFiles.isEmpty() && !m_pendingFilesTimer.isActive())
+        m_pendingFilesTimer.start();
 }
+#endif
@@ -31,13 +31,48 @@
 #include <QDir>
 #include <QFileSystemWatcher>
 #include <QHash>
+#include <QMetaType>
+#include <QSet>
 #include <QtContainerFwd>
 #include <QTimer>
 #include <QVector>
 
+#include "base/bittorrent/torrentinfo.h"
+
+class QSocketNotifier;
+class QThread;
+
+struct WatchedTorrentFile
+{
+    QString path;
+    BitTorrent::TorrentInfo torrentInfo;  // valid for .torrent files only
+    QStringList magnetURIs;  // filled for .magnet files only
+    bool isValid = false;  // false if file was missing, unreadable or not fully written yet
+};
+
+Q_DECLARE_METATYPE(QVector<WatchedTorrentFile>)
+
+// Validates and decodes watched files in a worker thread
+class WatchedTorrentFileLoader final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WatchedTorrentFileLoader)
+
+public:
+    WatchedTorrentFileLoader() = default;
+
+public slots:
+    void load(const QStringList &paths);
+
+signals:
+    void loaded(const QVector<WatchedTorrentFile> &files);
+};
+
 /*
  * Subclassing QFileSystemWatcher in order to support Network File
  * System watching (NFS, CIFS) on Linux and Mac OS.
+ * On Linux local folders are watched with inotify and files are picked
+ * up as soon as they are closed after writing.
  */
 class FileSystemWatcher : public QFileSystemWatcher
 {
@@ -45,21 +80,31 @@ class FileSystemWatcher : public QFileSystemWatcher
 
 public:
     explicit FileSystemWatcher(QObject *parent = nullptr);
+    ~FileSystemWatcher() override;
 
     QStringList directories() const;
     void addPath(const QString &path);
     void removePath(const QString &path);
 
 signals:
-    void torrentsAdded(const QStringList &pathList);
+    void torrentsAdded(const QVector<WatchedTorrentFile> &files);
 
 protected slots:
     void scanLocalFolder(const QString &path);
     void processPartialTorrents();
     void scanNetworkFolders();
 
+private slots:
+    void processPendingFiles();
+    void handleFilesLoaded(const QVector<WatchedTorrentFile> &files);
+
 private:
     void processTorrentsInDir(const QDir &dir);
+    void loadFiles(const QStringList &paths);
+#ifdef Q_OS_LINUX
+    bool addInotifyWatch(const QString &path);
+    void readInotifyEvents();
+#endif
 
     // Partial torrents
     QHash<QString, int> m_partialTorrents;
@@ -67,4 +112,21 @@ private:
 
     QVector<QDir> m_watchedFolders;
     QTimer m_watchTimer;
+
+    // Files reported by change notifications, loaded in batches once things calm down
+    QSet<QString> m_pendingFiles;
+    QTimer m_pendingFilesTimer;
+
+    // Files currently being loaded by the workers
+    QSet<QString> m_loadingFiles;
+
+    QVector<QThread *> m_loaderThreads;
+    QVector<WatchedTorrentFileLoader *> m_loaders;
+    int m_nextLoader = 0;
+
+#ifdef Q_OS_LINUX
+    int m_inotifyFD = -1;
+    QSocketNotifier *m_inotifyNotifier = nullptr;
+    QHash<int, QString> m_inotifyWatches;  // <watch descriptor, path>
+#endif
 };
@@ -30,110 +30,282 @@
 
 #include "connection.h"
 
-#include <QTcpSocket>
+#include <QFile>
+#include <QSslSocket>
+#include <QTimer>
 
 #include "base/logger.h"
-#include "irequesthandler.h"
+#include "eventstream.h"
 #include "requestparser.h"
 #include "responsegenerator.h"
 
 using namespace Http;
 
-Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
-    : QObject(parent)
-    , m_socket(socket)
-    , m_requestHandler(requestHandler)
+namespace
+{
+    const int KEEP_ALIVE_DURATION = 7 * 1000;  // milliseconds
+    const int IDLE_CHECK_INTERVAL = 2 * 1000;  // milliseconds
+    // stop handing events over while this much is still waiting to be sent
+    const qint64 MAX_UNSENT_EVENT_DATA = 256 * 1024;
+    // file content is read in chunks as the socket drains
+    const qint64 FILE_CONTENT_CHUNK_SIZE = 256 * 1024;
+}
+
+Connection::Connection(const qintptr socketDescriptor, const QList<QSslCertificate> &certificates, const QSslKey &key)
+    : m_socketDescriptor(socketDescriptor)
+    , m_certificates(certificates)
+    , m_key(key)
 {
-    m_socket->setParent(this);
-    m_idleTimer.start();
-    connect(m_socket, &QTcpSocket::readyRead, this, &Connection::read);
 }
 
 Connection::~Connection()
 {
-    m_socket->close();
+    // the stream lives in the thread of its producer
+    if (m_eventStream)
+        QMetaObject::invokeMethod(m_eventStream.data(), "close", Qt::QueuedConnection);
+    if (m_socket)
+        m_socket->close();
+}
+
+// Called in the connection thread, so that the socket belongs to it
+void Connection::start()
+{
+    const bool https = !m_certificates.isEmpty();
+    m_socket = https ? new QSslSocket(this) : new QTcpSocket(this);
+    connect(m_socket, &QAbstractSocket::disconnected, this, &Connection::closed);
+
+    if (!m_socket->setSocketDescriptor(m_socketDescriptor))
+    {
+        emit closed();
+        return;
+    }
+
+    if (https)
+    {
+        auto *sslSocket = static_cast<QSslSocket *>(m_socket);
+        sslSocket->setProtocol(QSsl::SecureProtocols);
+        sslSocket->setPrivateKey(m_key);
+        sslSocket->setLocalCertificateChain(m_certificates);
+        sslSocket->setPeerVerifyMode(QSslSocket::VerifyNone);
+        sslSocket->startServerEncryption();
+    }
+
+    m_idleTimer.start();
+    connect(m_socket, &QTcpSocket::readyRead, this, &Connection::read);
+    connect(m_socket, &QIODevice::bytesWritten, this, &Connection::writeFileContent);
+
+    m_idleCheckTimer = new QTimer(this);
+    connect(m_idleCheckTimer, &QTimer::timeout, this, &Connection::closeIfExpired);
+    m_idleCheckTimer->start(IDLE_CHECK_INTERVAL);
 }
 
 void Connection::read()
 {
     m_idleTimer.restart();
-    m_receivedData.append(m_socket->readAll());
 
-    while (!m_receivedData.isEmpty())
+    // the connection only sends events once it carries an event stream
+    if (m_eventStream)
     {
-        const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
+        m_socket->readAll();
+        return;
+    }
 
-        switch (result.status)
-        {
-        case RequestParser::ParseStatus::Incomplete:
-        {
-                const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
-                if (m_receivedData.size() > bufferLimit)
-                {
-                    Logger::instance()->addMessage(tr("Http request size exceeds limitation, closing socket. Limit: %1, IP: %2")
-                        .arg(bufferLimit).arg(m_socket->peerAddress().toString()), Log::WARNING);
-
-                    Response resp(413, "Payload Too Large");
-                    resp.headers[HEADER_CONNECTION] = "close";
-
-                    sendResponse(resp);
-                    m_socket->close();
-                }
-            }
-            return;
+    m_receivedData.append(m_socket->readAll());
+    processReceivedData();
+}
 
-        case RequestParser::ParseStatus::BadRequest:
-        {
-                Logger::instance()->addMessage(tr("Bad Http request, closing socket. IP: %1")
-                    .arg(m_socket->peerAddress().toString()), Log::WARNING);
+void Connection::processReceivedData()
+{
+    // requests are answered in order, the next one waits for the response to the current one
+    if (m_isAwaitingResponse || m_receivedData.isEmpty())
+        return;
+
+    const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
+
+    switch (result.status)
+    {
+    case RequestParser::ParseStatus::Incomplete:
+    {
+            const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
+            if (m_receivedData.size() > bufferLimit)
+            {
+                Logger::instance()->addMessage(tr("Http request size exceeds limitation, closing socket. Limit: %1, IP: %2")
+                    .arg(bufferLimit).arg(m_socket->peerAddress().toString()), Log::WARNING);
 
-                Response resp(400, "Bad Request");
+                Response resp(413, "Payload Too Large");
                 resp.headers[HEADER_CONNECTION] = "close";
 
-                sendResponse(resp);
+                write(resp);
                 m_socket->close();
             }
-            return;
+        }
+        return;
+
+    case RequestParser::ParseStatus::BadRequest:
+    {
+            Logger::instance()->addMessage(tr("Bad Http request, closing socket. IP: %1")
+                .arg(m_socket->peerAddress().toString()), Log::WARNING);
+
+            Response resp(400, "Bad Request");
+            resp.headers[HEADER_CONNECTION] = "close";
+
+            write(resp);
+            m_socket->close();
+        }
+        return;
+
+    case RequestParser::ParseStatus::OK:
+    {
+            const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
+
+            m_pendingContentEncoding = preferredContentEncoding(result.request.headers["accept-encoding"]);
+            m_receivedData = m_receivedData.mid(result.frameSize);
+            m_isAwaitingResponse = true;
 
-        case RequestParser::ParseStatus::OK:
+            emit requestReceived(result.request, env);
+        }
+        return;
+
+    default:
+        Q_ASSERT(false);
+        return;
+    }
+}
+
+void Connection::sendResponse(const Response &response)
+{
+    m_isAwaitingResponse = false;
+    m_idleTimer.restart();
+
+    Response resp = response;
+    resp.headers[HEADER_CONNECTION] = "keep-alive";
+
+    if (resp.eventStream)
+    {
+        write(resp);
+        m_receivedData.clear();
+        startEventStream(resp.eventStream);
+        return;
+    }
+
+    if (!resp.fileContent.path.isEmpty())
+    {
+        // keep the next requests waiting until the file has been sent
+        m_isAwaitingResponse = startFileContent(resp.fileContent);
+        if (!m_isAwaitingResponse)
         {
-                const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
+            Response errorResp(500, "Internal Server Error");
+            errorResp.headers[HEADER_CONNECTION] = "keep-alive";
+            write(errorResp);
+            processReceivedData();
+            return;
+        }
 
-                Response resp = m_requestHandler->processRequest(result.request, env);
+        write(resp);
+        writeFileContent();
+        return;
+    }
 
-                if (acceptsGzipEncoding(result.request.headers["accept-encoding"]))
-                    resp.headers[HEADER_CONTENT_ENCODING] = "gzip";
+    if (!m_pendingContentEncoding.isEmpty())
+        resp.headers[HEADER_CONTENT_ENCODING] = m_pendingContentEncoding;
 
-                resp.headers[HEADER_CONNECTION] = "keep-alive";
+    write(resp);
+    processReceivedData();
+}
 
-                sendResponse(resp);
-                m_receivedData = m_receivedData.mid(result.frameSize);
-            }
-            break;
+bool Connection::startFileContent(const FileContent &fileContent)
+{
+    auto *file = new QFile(fileContent.path, this);
+    if (!file->open(QIODevice::ReadOnly) || !file->seek(fileContent.offset))
+    {
+        delete file;
+        return false;
+    }
+
+    m_contentFile = file;
+    m_contentBytesLeft = fileContent.size;
+    return true;
+}
+
+// The file is read in this thread, a chunk at a time, instead of being loaded by the request handler
+void Connection::writeFileContent()
+{
+    if (!m_contentFile)
+        return;
 
-        default:
-            Q_ASSERT(false);
+    while ((m_contentBytesLeft > 0) && (m_socket->bytesToWrite() < FILE_CONTENT_CHUNK_SIZE))
+    {
+        const QByteArray chunk = m_contentFile->read(qMin(m_contentBytesLeft, FILE_CONTENT_CHUNK_SIZE));
+        if (chunk.isEmpty())
+        {
+            // the length was already sent, the client can only be told by closing the connection
+            m_socket->close();
             return;
         }
+
+        m_socket->write(chunk);
+        m_contentBytesLeft -= chunk.size();
+        m_idleTimer.restart();
     }
+
+    if (m_contentBytesLeft > 0)
+        return;
+
+    delete m_contentFile;
+    m_contentFile = nullptr;
+    m_isAwaitingResponse = false;
+    processReceivedData();
 }
 
-void Connection::sendResponse(const Response &response) const
+void Connection::write(const Response &response)
 {
+    // compression happens here, in the connection thread
     m_socket->write(toByteArray(response));
 }
 
-bool Connection::hasExpired(const qint64 timeout) const
+void Connection::startEventStream(const QSharedPointer<EventStream> &eventStream)
 {
-    return m_idleTimer.hasExpired(timeout);
+    m_eventStream = eventStream;
+    connect(m_eventStream.data(), &EventStream::dataPending, this, &Connection::writeEventData);
+    connect(m_eventStream.data(), &EventStream::closed, m_socket, &QAbstractSocket::disconnectFromHost);
+    connect(m_socket, &QIODevice::bytesWritten, this, &Connection::writeEventData);
+
+    writeEventData();
+}
+
+void Connection::writeEventData()
+{
+    // a slow client gets its events coalesced by the producers instead of buffered here
+    const bool isClientBusy = (m_socket->bytesToWrite() > MAX_UNSENT_EVENT_DATA);
+    m_eventStream->setClientBusy(isClientBusy);
+    if (isClientBusy)
+        return;
+
+    const QByteArray data = m_eventStream->takePendingData();
+    if (!data.isEmpty())
+    {
+        m_socket->write(data);
+        m_idleTimer.restart();
+    }
 }
 
-bool Connection::isClosed() const
+void Connection::closeIfExpired()
 {
-    return (m_socket->state() == QAbstractSocket::UnconnectedState);
+    // event streams stay open until either side closes them
+    if (m_eventStream && !m_eventStream->isClosed())
+        return;
+    // a file being sent keeps the idle timer running as long as the client reads it
+    if (m_isAwaitingResponse && !m_contentFile)
+        return;
+
+    if (m_idleTimer.hasExpired(KEEP_ALIVE_DURATION))
+    {
+        m_idleCheckTimer->stop();
+        emit closed();
+    }
 }
 
-bool Connection::acceptsGzipEncoding(QString codings)
+QString Connection::preferredContentEncoding(QString codings)
 {
     // [rfc7231] 5.3.4. Accept-Encoding
 
@@ -163,15 +335,17 @@ bool Connection::acceptsGzipEncoding(QString codings)
 
     const QVector<QStringRef> list = codings.remove(' ').remove('\t').splitRef(',', QString::SkipEmptyParts);
     if (list.isEmpty())
-        return false;
+        return {};
+
+    // gzip is preferred since some legacy clients mishandle raw "deflate"
+    if (isCodingAvailable(list, QLatin1String("gzip")))
+        return QLatin1String("gzip");
 
-    const bool canGzip = isCodingAvailable(list, QLatin1String("gzip"));
-    if (canGzip)
-        return true;
+    if (isCodingAvailable(list, QLatin1String("deflate")))
+        return QLatin1String("deflate");
 
-    const bool canAny = isCodingAvailable(list, QLatin1String("*"));
-    if (canAny)
-        return true;
+    if (isCodingAvailable(list, QLatin1String("*")))
+        return QLatin1String("gzip");
 
-    return false;
+    return {};
 }
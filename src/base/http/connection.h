@@ -31,37 +31,66 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QList>
 #include <QObject>
+#include <QSharedPointer>
+#include <QSslCertificate>
+#include <QSslKey>
 
+#include "types.h"
+
+class QFile;
 class QTcpSocket;
+class QTimer;
 
 namespace Http
 {
-    class IRequestHandler;
-    struct Response;
+    class EventStream;
 
+    // Lives in one of the connection threads of the Server. Socket I/O, TLS,
+    // request parsing and response encoding happen there, while the requests
+    // are handled by the Server in its own thread.
     class Connection : public QObject
     {
         Q_OBJECT
         Q_DISABLE_COPY(Connection)
 
     public:
-        Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent = nullptr);
+        Connection(qintptr socketDescriptor, const QList<QSslCertificate> &certificates, const QSslKey &key);
         ~Connection();
 
-        bool hasExpired(qint64 timeout) const;
-        bool isClosed() const;
+    public slots:
+        void start();
+        void sendResponse(const Http::Response &response);
+
+    signals:
+        void requestReceived(const Http::Request &request, const Http::Environment &env);
+        void closed();
 
     private slots:
         void read();
+        void writeEventData();
+        void writeFileContent();
+        void closeIfExpired();
 
     private:
-        static bool acceptsGzipEncoding(QString codings);
-        void sendResponse(const Response &response) const;
+        static QString preferredContentEncoding(QString codings);
+        void processReceivedData();
+        void write(const Response &response);
+        bool startFileContent(const FileContent &fileContent);
+        void startEventStream(const QSharedPointer<EventStream> &eventStream);
 
-        QTcpSocket *m_socket;
-        IRequestHandler *m_requestHandler;
+        const qintptr m_socketDescriptor;
+        const QList<QSslCertificate> m_certificates;
+        const QSslKey m_key;
+        QTcpSocket *m_socket = nullptr;
+        QTimer *m_idleCheckTimer = nullptr;
         QByteArray m_receivedData;
+        QString m_pendingContentEncoding;
+        bool m_isAwaitingResponse = false;
         QElapsedTimer m_idleTimer;
+        QSharedPointer<EventStream> m_eventStream;
+        QFile *m_contentFile = nullptr;
+        qint64 m_contentBytesLeft = 0;
     };
 }
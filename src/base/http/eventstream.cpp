@@ -0,0 +1,127 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "eventstream.h"
+
+#include <QList>
+
+#include "base/global.h"
+
+namespace
+{
+    const int KEEP_ALIVE_INTERVAL = 15 * 1000;  // milliseconds
+    // the client is too far behind to catch up, it needs to reconnect and resync
+    const int MAX_PENDING_DATA_SIZE = 4 * 1024 * 1024;
+}
+
+using namespace Http;
+
+EventStream::EventStream(QObject *parent)
+    : QObject(parent)
+{
+    // keeps the connection from being dropped by proxies while nothing happens
+    m_keepAliveTimer.setInterval(KEEP_ALIVE_INTERVAL);
+    connect(&m_keepAliveTimer, &QTimer::timeout, this, &EventStream::sendKeepAlive);
+    m_keepAliveTimer.start();
+}
+
+bool EventStream::isReady() const
+{
+    return (!m_isClosed && !m_isClientBusy);
+}
+
+bool EventStream::isClosed() const
+{
+    return m_isClosed;
+}
+
+void EventStream::sendEvent(const QString &type, const QByteArray &data)
+{
+    if (m_isClosed)
+        return;
+
+    // [HTML] 9.2.6 Interpreting an event stream
+    QByteArray event = "id: " + QByteArray::number(++m_lastEventID) + '\n';
+    event += "event: " + type.toUtf8() + '\n';
+    for (const QByteArray &line : asConst(data.split('\n')))
+        event += "data: " + line + '\n';
+    event += '\n';
+
+    bool isOverflowed = false;
+    {
+        const QMutexLocker locker(&m_pendingDataMutex);
+        m_pendingData += event;
+        isOverflowed = (m_pendingData.size() > MAX_PENDING_DATA_SIZE);
+    }
+
+    if (isOverflowed)
+    {
+        close();
+        return;
+    }
+
+    m_keepAliveTimer.start();
+    emit dataPending();
+}
+
+void EventStream::close()
+{
+    if (m_isClosed)
+        return;
+
+    m_isClosed = true;
+    m_keepAliveTimer.stop();
+    {
+        const QMutexLocker locker(&m_pendingDataMutex);
+        m_pendingData.clear();
+    }
+    emit closed();
+}
+
+QByteArray EventStream::takePendingData()
+{
+    QByteArray data;
+    const QMutexLocker locker(&m_pendingDataMutex);
+    m_pendingData.swap(data);
+    return data;
+}
+
+void EventStream::setClientBusy(const bool busy)
+{
+    m_isClientBusy = busy;
+}
+
+void EventStream::sendKeepAlive()
+{
+    // lines starting with a colon are comments and are ignored by the clients
+    {
+        const QMutexLocker locker(&m_pendingDataMutex);
+        m_pendingData += ":\n\n";
+    }
+    emit dataPending();
+}
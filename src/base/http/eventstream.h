@@ -0,0 +1,81 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QMetaType>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QTimer>
+
+namespace Http
+{
+    // Server-Sent Events channel. A connection keeps it open once the response
+    // carrying it was sent and writes the queued events when the client can take them.
+    // Events are sent from the thread of the stream, the connection takes them from its own thread.
+    class EventStream final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY(EventStream)
+
+    public:
+        explicit EventStream(QObject *parent = nullptr);
+
+        // The client has consumed the previously sent events. Producers are expected
+        // to hold back (and coalesce) their data while it isn't.
+        bool isReady() const;
+        bool isClosed() const;
+
+        void sendEvent(const QString &type, const QByteArray &data);
+
+        QByteArray takePendingData();
+        void setClientBusy(bool busy);
+
+    public slots:
+        void close();
+
+    signals:
+        void dataPending();
+        void closed();
+
+    private:
+        void sendKeepAlive();
+
+        mutable QMutex m_pendingDataMutex;
+        QByteArray m_pendingData;
+        QTimer m_keepAliveTimer;
+        quint64 m_lastEventID = 0;
+        std::atomic_bool m_isClientBusy {false};
+        std::atomic_bool m_isClosed {false};
+    };
+}
+
+Q_DECLARE_METATYPE(QSharedPointer<Http::EventStream>)
@@ -50,6 +50,27 @@ void ResponseBuilder::print(const QByteArray &data, const QString &type)
     print_impl(data, type);
 }
 
+void ResponseBuilder::print(const QJsonDocument &document)
+{
+    if (!m_response.headers.contains(HEADER_CONTENT_TYPE))
+        m_response.headers[HEADER_CONTENT_TYPE] = CONTENT_TYPE_JSON;
+
+    m_response.jsonContent = document;
+}
+
+void ResponseBuilder::openEventStream(const QSharedPointer<EventStream> &eventStream)
+{
+    m_response.headers[HEADER_CONTENT_TYPE] = CONTENT_TYPE_EVENT_STREAM;
+    m_response.headers[HEADER_CACHE_CONTROL] = QLatin1String("no-cache");
+    m_response.content.clear();
+    m_response.eventStream = eventStream;
+}
+
+void ResponseBuilder::setResponse(const Response &response)
+{
+    m_response = response;
+}
+
 void ResponseBuilder::clear()
 {
     m_response = Response();
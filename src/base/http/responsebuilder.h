@@ -39,6 +39,9 @@ namespace Http
         void setHeader(const Header &header);
         void print(const QString &text, const QString &type = CONTENT_TYPE_HTML);
         void print(const QByteArray &data, const QString &type = CONTENT_TYPE_HTML);
+        void print(const QJsonDocument &document);
+        void openEventStream(const QSharedPointer<EventStream> &eventStream);
+        void setResponse(const Response &response);
         void clear();
 
         Response response() const;
@@ -29,16 +29,98 @@
 
 #include "responsegenerator.h"
 
+#include <atomic>
+
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "base/http/types.h"
 #include "base/utils/gzip.h"
 
-QByteArray Http::toByteArray(Response response)
+namespace
 {
-    compressContent(response);
+    std::atomic<quint64> compressedResponses {0};
+    std::atomic<quint64> compressedBytesIn {0};
+    std::atomic<quint64> compressedBytesOut {0};
+    std::atomic<quint64> compressionCpuTimeNs {0};
+
+    // observed by several connection threads at once
+    QMutex jsonSerializationLatencyMutex;
+    Metrics::Histogram jsonSerializationLatencyHistogram;
+
+    // exponentially weighted average of the compressor cost, in nanoseconds per KiB of input
+    std::atomic<quint64> recentCostPerKiB {0};
+
+    int pickCompressionLevel(const int contentSize)
+    {
+        // large payloads (e.g. full sync/maindata) are dominated by CPU time, favor speed
+        int level = 6;
+        if (contentSize > (1024 * 1024))  // 1 MiB
+            level = 1;
+        else if (contentSize > (128 * 1024))  // 128 KiB
+            level = 4;
+
+        // back off further when the compressor has recently been expensive
+        // level 6 runs at roughly 20-40 MiB/s on commodity hardware, i.e. 25-50 us per KiB
+        const quint64 cost = recentCostPerKiB.load(std::memory_order_relaxed);
+        if (cost > 100000)
+            level = 1;
+        else if ((cost > 50000) && (level > 3))
+            level = 3;
+
+        return level;
+    }
+
+    // every attempt costs CPU time, even if its result is thrown away
+    void updateCompressionCost(const int bytesIn, const qint64 elapsedNs)
+    {
+        compressionCpuTimeNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+
+        const quint64 costPerKiB = (static_cast<quint64>(elapsedNs) * 1024) / static_cast<quint64>(bytesIn);
+        // responses are compressed by several connection threads at once
+        quint64 oldCost = recentCostPerKiB.load(std::memory_order_relaxed);
+        while (!recentCostPerKiB.compare_exchange_weak(oldCost, (((oldCost * 7) + costPerKiB) / 8)
+            , std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void updateCompressedResponses(const int bytesIn, const int bytesOut)
+    {
+        compressedResponses.fetch_add(1, std::memory_order_relaxed);
+        compressedBytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+        compressedBytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+    }
+
+    void serializeJsonContent(Http::Response &response)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        response.content = response.jsonContent.toJson(QJsonDocument::Compact);
+        response.jsonContent = {};
+        const double elapsed = timer.nsecsElapsed() / 1e9;
+
+        const QMutexLocker locker {&jsonSerializationLatencyMutex};
+        jsonSerializationLatencyHistogram.observe(elapsed);
+    }
+}
 
-    response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+QByteArray Http::toByteArray(Response response)
+{
+    if (!response.fileContent.path.isEmpty())
+    {
+        // the file is sent by the connection, after the headers
+        response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.fileContent.size);
+    }
+    else if (!response.eventStream)  // event streams have no length, their content follows as it is produced
+    {
+        if (!response.jsonContent.isNull())
+            serializeJsonContent(response);
+        compressContent(response);
+        response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+    }
     response.headers[HEADER_DATE] = httpDate();
 
     QByteArray buf;
@@ -76,7 +158,13 @@ QString Http::httpDate()
 
 void Http::compressContent(Response &response)
 {
-    if (response.headers.value(HEADER_CONTENT_ENCODING) != QLatin1String("gzip"))
+    const QString encoding = response.headers.value(HEADER_CONTENT_ENCODING);
+    Utils::Gzip::Format format;
+    if (encoding == QLatin1String("gzip"))
+        format = Utils::Gzip::Format::Gzip;
+    else if (encoding == QLatin1String("deflate"))
+        format = Utils::Gzip::Format::Zlib;
+    else
         return;
 
     response.headers.remove(HEADER_CONTENT_ENCODING);
@@ -92,15 +180,38 @@ void Http::compressContent(Response &response)
         return;
 
     // try compressing
+    QElapsedTimer timer;
+    timer.start();
+
     bool ok = false;
-    const QByteArray compressedData = Utils::Gzip::compress(response.content, 6, &ok);
+    const QByteArray compressedData = Utils::Gzip::compress(response.content, format, pickCompressionLevel(contentSize), &ok);
     if (!ok)
         return;
 
-    // "Content-Encoding: gzip\r\n" is 24 bytes long
-    if ((compressedData.size() + 24) >= contentSize)
+    updateCompressionCost(contentSize, timer.nsecsElapsed());
+
+    // "Content-Encoding: deflate\r\n" is 27 bytes long
+    if ((compressedData.size() + 27) >= contentSize)
         return;
 
+    updateCompressedResponses(contentSize, compressedData.size());
+
     response.content = compressedData;
-    response.headers[HEADER_CONTENT_ENCODING] = QLatin1String("gzip");
+    response.headers[HEADER_CONTENT_ENCODING] = encoding;
+}
+
+Http::CompressionStatistics Http::compressionStatistics()
+{
+    CompressionStatistics stats;
+    stats.compressedResponses = compressedResponses.load(std::memory_order_relaxed);
+    stats.bytesIn = compressedBytesIn.load(std::memory_order_relaxed);
+    stats.bytesOut = compressedBytesOut.load(std::memory_order_relaxed);
+    stats.cpuTimeNs = compressionCpuTimeNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Metrics::Histogram Http::jsonSerializationLatency()
+{
+    const QMutexLocker locker {&jsonSerializationLatencyMutex};
+    return jsonSerializationLatencyHistogram;
 }
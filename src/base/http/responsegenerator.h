@@ -30,6 +30,10 @@
 
 #pragma once
 
+#include <QtGlobal>
+
+#include "base/metrics.h"
+
 class QByteArray;
 class QString;
 
@@ -37,7 +41,19 @@ namespace Http
 {
     struct Response;
 
+    struct CompressionStatistics
+    {
+        // responses sent compressed, and their sizes before and after
+        quint64 compressedResponses = 0;
+        quint64 bytesIn = 0;
+        quint64 bytesOut = 0;
+        quint64 cpuTimeNs = 0;  // time spent inside the compressor, including the discarded attempts
+    };
+
     QByteArray toByteArray(Response response);
     QString httpDate();
     void compressContent(Response &response);
+    CompressionStatistics compressionStatistics();
+    // time the connections spent serializing JSON content
+    Metrics::Histogram jsonSerializationLatency();
 }
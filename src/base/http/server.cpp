@@ -37,17 +37,17 @@
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QStringList>
-#include <QTimer>
+#include <QThread>
 
-#include "base/algorithm.h"
+#include "base/global.h"
 #include "base/utils/net.h"
 #include "connection.h"
+#include "irequesthandler.h"
 
 namespace
 {
-    const int KEEP_ALIVE_DURATION = 7 * 1000;  // milliseconds
     const int CONNECTIONS_LIMIT = 500;
-    const int CONNECTIONS_SCAN_INTERVAL = 2;  // seconds
+    const int MAX_CONNECTION_THREADS = 4;
 
     QList<QSslCipher> safeCipherList()
     {
@@ -78,57 +78,69 @@ Server::Server(IRequestHandler *requestHandler, QObject *parent)
     sslConf.setCiphers(safeCipherList());
     QSslConfiguration::setDefaultConfiguration(sslConf);
 
-    auto *dropConnectionTimer = new QTimer(this);
-    connect(dropConnectionTimer, &QTimer::timeout, this, &Server::dropTimedOutConnection);
-    dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL * 1000);
+    qRegisterMetaType<Http::Environment>("Http::Environment");
+    qRegisterMetaType<Http::Request>("Http::Request");
+    qRegisterMetaType<Http::Response>("Http::Response");
+
+    // The connections do the socket I/O, TLS, parsing and compression in their own
+    // threads. The requests are still handled in the thread of the server.
+    const int threadCount = qBound(1, (QThread::idealThreadCount() / 2), MAX_CONNECTION_THREADS);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString::fromLatin1("HTTP connections %1").arg(i + 1));
+        thread->start();
+        m_connectionThreads.append(thread);
+    }
 }
 
-void Server::incomingConnection(const qintptr socketDescriptor)
+Server::~Server()
 {
-    if (m_connections.size() >= CONNECTIONS_LIMIT) return;
-
-    QTcpSocket *serverSocket;
-    if (m_https)
-        serverSocket = new QSslSocket(this);
-    else
-        serverSocket = new QTcpSocket(this);
+    // pending deferred deletions are processed when the threads finish
+    for (Connection *connection : asConst(m_connections))
+        connection->deleteLater();
+    m_connections.clear();
 
-    if (!serverSocket->setSocketDescriptor(socketDescriptor))
+    for (QThread *thread : asConst(m_connectionThreads))
     {
-        delete serverSocket;
-        return;
+        thread->quit();
+        thread->wait();
     }
+}
 
-    if (m_https)
-    {
-        static_cast<QSslSocket *>(serverSocket)->setProtocol(QSsl::SecureProtocols);
-        static_cast<QSslSocket *>(serverSocket)->setPrivateKey(m_key);
-        static_cast<QSslSocket *>(serverSocket)->setLocalCertificateChain(m_certificates);
-        static_cast<QSslSocket *>(serverSocket)->setPeerVerifyMode(QSslSocket::VerifyNone);
-        static_cast<QSslSocket *>(serverSocket)->startServerEncryption();
-    }
+void Server::incomingConnection(const qintptr socketDescriptor)
+{
+    if (m_connections.size() >= CONNECTIONS_LIMIT) return;
+
+    auto *c = new Connection(socketDescriptor
+        , (m_https ? m_certificates : QList<QSslCertificate> {}), (m_https ? m_key : QSslKey {}));
+    c->moveToThread(m_connectionThreads[m_nextConnectionThread]);
+    m_nextConnectionThread = (m_nextConnectionThread + 1) % m_connectionThreads.size();
 
-    auto *c = new Connection(serverSocket, m_requestHandler, this);
     m_connections.insert(c);
-    connect(serverSocket, &QAbstractSocket::disconnected, this, [c, this]() { removeConnection(c); });
+    connect(c, &Connection::requestReceived, this, [this, c](const Request &request, const Environment &env)
+    {
+        processRequest(c, request, env);
+    });
+    connect(c, &Connection::closed, this, [this, c]() { removeConnection(c); });
+
+    QMetaObject::invokeMethod(c, "start", Qt::QueuedConnection);
 }
 
-void Server::removeConnection(Connection *connection)
+void Server::processRequest(Connection *connection, const Request &request, const Environment &env)
 {
-    m_connections.remove(connection);
-    connection->deleteLater();
+    // the connection might have been closed while the request was queued
+    if (!m_connections.contains(connection))
+        return;
+
+    const Response response = m_requestHandler->processRequest(request, env);
+    QMetaObject::invokeMethod(connection, "sendResponse", Qt::QueuedConnection, Q_ARG(Http::Response, response));
 }
 
-void Server::dropTimedOutConnection()
+void Server::removeConnection(Connection *connection)
 {
-    Algorithm::removeIf(m_connections, [](Connection *connection)
-    {
-        if (!connection->hasExpired(KEEP_ALIVE_DURATION))
-            return false;
-
+    if (m_connections.remove(connection))
         connection->deleteLater();
-        return true;
-    });
 }
 
 bool Server::setupHttps(const QByteArray &certificates, const QByteArray &privateKey)
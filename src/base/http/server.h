@@ -34,11 +34,16 @@
 #include <QSslCertificate>
 #include <QSslKey>
 #include <QTcpServer>
+#include <QVector>
+
+class QThread;
 
 namespace Http
 {
     class IRequestHandler;
     class Connection;
+    struct Environment;
+    struct Request;
 
     class Server final : public QTcpServer
     {
@@ -47,19 +52,20 @@ namespace Http
 
     public:
         explicit Server(IRequestHandler *requestHandler, QObject *parent = nullptr);
+        ~Server() override;
 
         bool setupHttps(const QByteArray &certificates, const QByteArray &privateKey);
         void disableHttps();
 
-    private slots:
-        void dropTimedOutConnection();
-
     private:
         void incomingConnection(qintptr socketDescriptor) override;
+        void processRequest(Connection *connection, const Request &request, const Environment &env);
         void removeConnection(Connection *connection);
 
         IRequestHandler *m_requestHandler;
         QSet<Connection *> m_connections;  // for tracking persistent connections
+        QVector<QThread *> m_connectionThreads;
+        int m_nextConnectionThread = 0;
 
         bool m_https;
         QList<QSslCertificate> m_certificates;
@@ -30,26 +30,35 @@
 #pragma once
 
 #include <QHostAddress>
+#include <QJsonDocument>
+#include <QMetaType>
+#include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
 namespace Http
 {
+    class EventStream;
+
     const char METHOD_GET[] = "GET";
     const char METHOD_POST[] = "POST";
 
+    const char HEADER_ACCEPT_RANGES[] = "accept-ranges";
     const char HEADER_CACHE_CONTROL[] = "cache-control";
     const char HEADER_CONNECTION[] = "connection";
     const char HEADER_CONTENT_DISPOSITION[] = "content-disposition";
     const char HEADER_CONTENT_ENCODING[] = "content-encoding";
     const char HEADER_CONTENT_LENGTH[] = "content-length";
+    const char HEADER_CONTENT_RANGE[] = "content-range";
     const char HEADER_CONTENT_SECURITY_POLICY[] = "content-security-policy";
     const char HEADER_CONTENT_TYPE[] = "content-type";
     const char HEADER_DATE[] = "date";
     const char HEADER_HOST[] = "host";
     const char HEADER_ORIGIN[] = "origin";
+    const char HEADER_RANGE[] = "range";
     const char HEADER_REFERER[] = "referer";
     const char HEADER_REFERRER_POLICY[] = "referrer-policy";
+    const char HEADER_RETRY_AFTER[] = "retry-after";
     const char HEADER_SET_COOKIE[] = "set-cookie";
     const char HEADER_X_CONTENT_TYPE_OPTIONS[] = "x-content-type-options";
     const char HEADER_X_FORWARDED_HOST[] = "x-forwarded-host";
@@ -65,6 +74,9 @@ namespace Http
     const char CONTENT_TYPE_TXT[] = "text/plain; charset=UTF-8";
     const char CONTENT_TYPE_JS[] = "application/javascript";
     const char CONTENT_TYPE_JSON[] = "application/json";
+    const char CONTENT_TYPE_OCTET_STREAM[] = "application/octet-stream";
+    const char CONTENT_TYPE_EVENT_STREAM[] = "text/event-stream";
+    const char CONTENT_TYPE_OPENMETRICS[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
     const char CONTENT_TYPE_GIF[] = "image/gif";
     const char CONTENT_TYPE_PNG[] = "image/png";
     const char CONTENT_TYPE_FORM_ENCODED[] = "application/x-www-form-urlencoded";
@@ -108,6 +120,14 @@ namespace Http
         QVector<UploadedFile> files;
     };
 
+    // A part of a file that the connection sends, after the headers, as the content of the response
+    struct FileContent
+    {
+        QString path;
+        qint64 offset = 0;
+        qint64 size = 0;
+    };
+
     struct ResponseStatus
     {
         uint code;
@@ -119,6 +139,11 @@ namespace Http
         ResponseStatus status;
         HeaderMap headers;
         QByteArray content;
+        // serialized into the content by the connection, off the thread of the request handler
+        QJsonDocument jsonContent;
+        // the connection keeps sending the events of the stream after the response
+        QSharedPointer<EventStream> eventStream;
+        FileContent fileContent;
 
         Response(uint code = 200, const QString &text = "OK")
             : status {code, text}
@@ -126,3 +151,7 @@ namespace Http
         }
     };
 }
+
+Q_DECLARE_METATYPE(Http::Environment)
+Q_DECLARE_METATYPE(Http::Request)
+Q_DECLARE_METATYPE(Http::Response)
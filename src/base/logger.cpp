@@ -35,12 +35,39 @@
 
 namespace
 {
-    template <typename T>
-    QVector<T> loadFromBuffer(const boost::circular_buffer_space_optimized<T> &src, const int offset = 0)
+    const int MAX_PEER_REASONS = 1000;
+
+    // Index in the buffer of the first item newer than 'lastKnownId', -1 if there is none
+    int firstNewItemIndex(const int counter, const int lastKnownId, const int size)
+    {
+        const int diff = counter - lastKnownId - 1;
+
+        if ((lastKnownId == -1) || (diff >= size))
+            return 0;
+
+        if (diff <= 0)
+            return -1;
+
+        return (size - diff);
+    }
+
+    // Only the items that pass are copied, the buffer is read under the lock of the caller
+    template <typename T, typename Predicate>
+    QVector<T> loadFromBuffer(const boost::circular_buffer_space_optimized<T> &src, const int offset, const int limit, Predicate &&predicate)
     {
         QVector<T> ret;
-        ret.reserve(src.size() - offset);
-        std::copy((src.begin() + offset), src.end(), std::back_inserter(ret));
+        if (offset < 0)
+            return ret;
+
+        const int available = static_cast<int>(src.size()) - offset;
+        ret.reserve((limit >= 0) ? qMin(limit, available) : available);
+        for (auto iter = (src.begin() + offset); iter != src.end(); ++iter)
+        {
+            if ((limit >= 0) && (ret.size() >= limit))
+                break;
+            if (predicate(*iter))
+                ret.append(*iter);
+        }
         return ret;
     }
 }
@@ -83,43 +110,54 @@ void Logger::addMessage(const QString &message, const Log::MsgType &type)
 void Logger::addPeer(const QString &ip, const bool blocked, const QString &reason)
 {
     QWriteLocker locker(&m_lock);
-    const Log::Peer msg = {m_peerCounter++, blocked, QDateTime::currentMSecsSinceEpoch(), ip, reason};
+    if (m_peerReasons.size() >= MAX_PEER_REASONS)
+        m_peerReasons.clear();
+    const QString internedReason = *m_peerReasons.insert(reason);
+    const Log::Peer msg = {m_peerCounter++, blocked, QDateTime::currentMSecsSinceEpoch(), ip, internedReason};
     m_peers.push_back(msg);
     locker.unlock();
 
     emit newLogPeer(msg);
 }
 
-QVector<Log::Msg> Logger::getMessages(const int lastKnownId) const
+QVector<Log::Msg> Logger::getMessages(const int lastKnownId, const Log::MsgTypes types, const QString &text, const int limit) const
 {
     const QReadLocker locker(&m_lock);
 
-    const int diff = m_msgCounter - lastKnownId - 1;
-    const int size = m_messages.size();
-
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_messages);
-
-    if (diff <= 0)
-        return {};
-
-    return loadFromBuffer(m_messages, (size - diff));
+    const int offset = firstNewItemIndex(m_msgCounter, lastKnownId, m_messages.size());
+    return loadFromBuffer(m_messages, offset, limit, [types, &text](const Log::Msg &msg)
+    {
+        return types.testFlag(msg.type)
+            && (text.isEmpty() || msg.message.contains(text, Qt::CaseInsensitive));
+    });
 }
 
-QVector<Log::Peer> Logger::getPeers(const int lastKnownId) const
+QVector<Log::Peer> Logger::getPeers(const int lastKnownId, const QString &text, const int limit) const
 {
     const QReadLocker locker(&m_lock);
 
-    const int diff = m_peerCounter - lastKnownId - 1;
-    const int size = m_peers.size();
+    const int offset = firstNewItemIndex(m_peerCounter, lastKnownId, m_peers.size());
+    return loadFromBuffer(m_peers, offset, limit, [&text](const Log::Peer &peer)
+    {
+        return (text.isEmpty() || peer.ip.contains(text, Qt::CaseInsensitive)
+            || peer.reason.contains(text, Qt::CaseInsensitive));
+    });
+}
 
-    if ((lastKnownId == -1) || (diff >= size))
-        return loadFromBuffer(m_peers);
+void Logger::addFileLogCounts(const qint64 written, const qint64 dropped)
+{
+    m_fileLogWrittenMessages += written;
+    m_fileLogDroppedMessages += dropped;
+}
 
-    if (diff <= 0)
-        return {};
+qint64 Logger::fileLogWrittenMessages() const
+{
+    return m_fileLogWrittenMessages;
+}
 
-    return loadFromBuffer(m_peers, (size - diff));
+qint64 Logger::fileLogDroppedMessages() const
+{
+    return m_fileLogDroppedMessages;
 }
 
 void LogMsg(const QString &message, const Log::MsgType &type)
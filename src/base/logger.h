@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <boost/circular_buffer.hpp>
 
 #include <QObject>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QString>
 #include <QtContainerFwd>
 
@@ -81,8 +84,18 @@ public:
 
     void addMessage(const QString &message, const Log::MsgType &type = Log::NORMAL);
     void addPeer(const QString &ip, bool blocked, const QString &reason = {});
-    QVector<Log::Msg> getMessages(int lastKnownId = -1) const;
-    QVector<Log::Peer> getPeers(int lastKnownId = -1) const;
+    // Messages newer than 'lastKnownId', optionally filtered by type and by text (case insensitive).
+    // At most 'limit' messages are returned if it is not negative, the oldest first.
+    QVector<Log::Msg> getMessages(int lastKnownId = -1, Log::MsgTypes types = Log::ALL
+        , const QString &text = {}, int limit = -1) const;
+    // The text is matched against the IP and the reason
+    QVector<Log::Peer> getPeers(int lastKnownId = -1, const QString &text = {}, int limit = -1) const;
+
+    // Messages the file logger wrote to the log file or dropped because it couldn't keep up.
+    // Thread-safe, the file logger counts them from its writer thread.
+    void addFileLogCounts(qint64 written, qint64 dropped);
+    qint64 fileLogWrittenMessages() const;
+    qint64 fileLogDroppedMessages() const;
 
 signals:
     void newLogMessage(const Log::Msg &message);
@@ -95,9 +108,13 @@ private:
     static Logger *m_instance;
     boost::circular_buffer_space_optimized<Log::Msg> m_messages;
     boost::circular_buffer_space_optimized<Log::Peer> m_peers;
+    // the same few reasons are repeated for most of the peers
+    QSet<QString> m_peerReasons;
     mutable QReadWriteLock m_lock;
     int m_msgCounter = 0;
     int m_peerCounter = 0;
+    std::atomic<qint64> m_fileLogWrittenMessages {0};
+    std::atomic<qint64> m_fileLogDroppedMessages {0};
 };
 
 // Helper function
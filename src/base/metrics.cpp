@@ -0,0 +1,166 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "metrics.h"
+
+#include <iterator>
+
+#include <QString>
+
+using namespace Metrics;
+
+namespace
+{
+    const char *const HISTOGRAM_BOUND_LABELS[] = {"0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5"};
+    static_assert(std::size(HISTOGRAM_BOUND_LABELS) == HISTOGRAM_BOUNDS.size());
+}
+
+void Histogram::observe(const double value)
+{
+    int bucket = 0;
+    while ((bucket < static_cast<int>(HISTOGRAM_BOUNDS.size())) && (value > HISTOGRAM_BOUNDS[bucket]))
+        ++bucket;
+
+    ++m_bucketCounts[bucket];
+    ++m_count;
+    m_sum += value;
+}
+
+quint64 Histogram::bucketCount(const int bucket) const
+{
+    return m_bucketCounts[bucket];
+}
+
+quint64 Histogram::count() const
+{
+    return m_count;
+}
+
+double Histogram::sum() const
+{
+    return m_sum;
+}
+
+OpenMetricsWriter::OpenMetricsWriter(QByteArray &buffer)
+    : m_buffer(buffer)
+{
+}
+
+void OpenMetricsWriter::addFamily(const QByteArray &name, const Type type, const char *help)
+{
+    m_buffer += "# TYPE ";
+    m_buffer += name;
+    switch (type)
+    {
+    case Type::Counter:
+        m_buffer += " counter\n";
+        break;
+    case Type::Gauge:
+        m_buffer += " gauge\n";
+        break;
+    case Type::Histogram:
+        m_buffer += " histogram\n";
+        break;
+    }
+
+    if (help)
+    {
+        m_buffer += "# HELP ";
+        m_buffer += name;
+        m_buffer += ' ';
+        m_buffer += help;
+        m_buffer += '\n';
+    }
+}
+
+void OpenMetricsWriter::addSample(const QByteArray &name, const Type type, const qint64 value, const QByteArray &labels)
+{
+    appendSampleName(name, ((type == Type::Counter) ? "_total" : nullptr), labels);
+    m_buffer += QByteArray::number(value);
+    m_buffer += '\n';
+}
+
+void OpenMetricsWriter::addHistogram(const QByteArray &name, const Histogram &histogram, const QByteArray &labels)
+{
+    const auto appendBucket = [this, &name, &labels](const char *bound, const quint64 count)
+    {
+        m_buffer += name;
+        m_buffer += "_bucket{";
+        if (!labels.isEmpty())
+        {
+            m_buffer += labels;
+            m_buffer += ',';
+        }
+        m_buffer += "le=\"";
+        m_buffer += bound;
+        m_buffer += "\"} ";
+        m_buffer += QByteArray::number(count);
+        m_buffer += '\n';
+    };
+
+    quint64 cumulativeCount = 0;
+    for (int i = 0; i < static_cast<int>(HISTOGRAM_BOUNDS.size()); ++i)
+    {
+        cumulativeCount += histogram.bucketCount(i);
+        appendBucket(HISTOGRAM_BOUND_LABELS[i], cumulativeCount);
+    }
+    appendBucket("+Inf", histogram.count());
+
+    appendSampleName(name, "_count", labels);
+    m_buffer += QByteArray::number(histogram.count());
+    m_buffer += '\n';
+    appendSampleName(name, "_sum", labels);
+    m_buffer += QByteArray::number(histogram.sum(), 'g', 9);
+    m_buffer += '\n';
+}
+
+void OpenMetricsWriter::finish()
+{
+    m_buffer += "# EOF\n";
+}
+
+QByteArray OpenMetricsWriter::label(const char *name, const QString &value)
+{
+    QByteArray escapedValue = value.toUtf8();
+    escapedValue.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return (QByteArray(name) + "=\"" + escapedValue + '"');
+}
+
+void OpenMetricsWriter::appendSampleName(const QByteArray &name, const char *suffix, const QByteArray &labels)
+{
+    m_buffer += name;
+    if (suffix)
+        m_buffer += suffix;
+    if (!labels.isEmpty())
+    {
+        m_buffer += '{';
+        m_buffer += labels;
+        m_buffer += '}';
+    }
+    m_buffer += ' ';
+}
@@ -0,0 +1,85 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <QByteArray>
+#include <QtGlobal>
+
+namespace Metrics
+{
+    // upper bounds of the histogram buckets, in seconds
+    inline constexpr std::array<double, 12> HISTOGRAM_BOUNDS {{0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5}};
+
+    // Distribution of durations in seconds over fixed buckets, not thread-safe
+    class Histogram
+    {
+    public:
+        void observe(double value);
+
+        // Number of observations in the bucket, the last one counts what is above all the bounds
+        quint64 bucketCount(int bucket) const;
+        quint64 count() const;
+        double sum() const;
+
+    private:
+        std::array<quint64, (HISTOGRAM_BOUNDS.size() + 1)> m_bucketCounts {};
+        quint64 m_count = 0;
+        double m_sum = 0;
+    };
+
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    // Appends metrics to a buffer in the OpenMetrics text format.
+    // 'name' is the metric family name, '_total' is added to the counter samples.
+    // 'labels' are given already formatted, e.g. 'action="app/version"', see label().
+    class OpenMetricsWriter
+    {
+    public:
+        explicit OpenMetricsWriter(QByteArray &buffer);
+
+        void addFamily(const QByteArray &name, Type type, const char *help = nullptr);
+        void addSample(const QByteArray &name, Type type, qint64 value, const QByteArray &labels = {});
+        void addHistogram(const QByteArray &name, const Histogram &histogram, const QByteArray &labels = {});
+        void finish();
+
+        static QByteArray label(const char *name, const QString &value);
+
+    private:
+        void appendSampleName(const QByteArray &name, const char *suffix, const QByteArray &labels);
+
+        QByteArray &m_buffer;
+    };
+}
@@ -133,11 +133,19 @@ void GeoIPManager::downloadDatabaseFile()
 QString GeoIPManager::lookup(const QHostAddress &hostAddr) const
 {
     if (m_enabled && m_geoIPDatabase)
+    {
+        ++m_lookupCount;
         return m_geoIPDatabase->lookup(hostAddr);
+    }
 
     return {};
 }
 
+quint64 GeoIPManager::lookupCount() const
+{
+    return m_lookupCount;
+}
+
 QString GeoIPManager::CountryName(const QString &countryISOCode)
 {
     static const QHash<QString, QString> countries =
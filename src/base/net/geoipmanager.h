@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <QObject>
 
 class QHostAddress;
@@ -51,6 +53,8 @@ namespace Net
         static GeoIPManager *instance();
 
         QString lookup(const QHostAddress &hostAddr) const;
+        // Number of lookups done since the start
+        quint64 lookupCount() const;
 
         static QString CountryName(const QString &countryISOCode);
 
@@ -68,6 +72,7 @@ namespace Net
 
         bool m_enabled;
         GeoIPDatabase *m_geoIPDatabase;
+        mutable std::atomic<quint64> m_lookupCount {0};
 
         static GeoIPManager *m_instance;
     };
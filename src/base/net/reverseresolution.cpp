@@ -28,11 +28,27 @@
 
 #include "reverseresolution.h"
 
-#include <QHostAddress>
+#include <QDateTime>
+#include <QFile>
 #include <QHostInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
 #include <QString>
+#include <QTimer>
 
-const int CACHE_SIZE = 2048;
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/profile.h"
+
+const int CACHE_SIZE = 8192;
+const int MAX_CONCURRENT_LOOKUPS = 16;
+const int MAX_PENDING_LOOKUPS = 4096;
+const qint64 POSITIVE_TTL = 24 * 60 * 60;  // 1 day
+const qint64 NEGATIVE_TTL = 60 * 60;  // 1 hour
+const int STORE_INTERVAL = 5 * 60 * 1000;  // 5 min
+const char CACHE_FILENAME[] = "hostnames.json";
 
 using namespace Net;
 
@@ -42,12 +58,24 @@ namespace
     {
         return (!hostname.isEmpty() && (hostname != ip.toString()));
     }
+
+    QString cacheFilePath()
+    {
+        return specialFolderLocation(SpecialFolder::Cache) + QLatin1String(CACHE_FILENAME);
+    }
 }
 
-ReverseResolution::ReverseResolution(QObject *parent)
-    : QObject(parent)
+ReverseResolution *ReverseResolution::m_instance = nullptr;
+
+ReverseResolution::ReverseResolution()
+    : m_storeTimer {new QTimer(this)}
 {
     m_cache.setMaxCost(CACHE_SIZE);
+    loadCache();
+
+    m_storeTimer->setInterval(STORE_INTERVAL);
+    connect(m_storeTimer, &QTimer::timeout, this, &ReverseResolution::storeCache);
+    m_storeTimer->start();
 }
 
 ReverseResolution::~ReverseResolution()
@@ -55,35 +83,156 @@ ReverseResolution::~ReverseResolution()
     // abort on-going lookups instead of waiting them
     for (auto iter = m_lookups.cbegin(); iter != m_lookups.cend(); ++iter)
         QHostInfo::abortHostLookup(iter.key());
+
+    storeCache();
+}
+
+void ReverseResolution::initInstance()
+{
+    if (!m_instance)
+        m_instance = new ReverseResolution;
+}
+
+void ReverseResolution::freeInstance()
+{
+    delete m_instance;
+    m_instance = nullptr;
+}
+
+ReverseResolution *ReverseResolution::instance()
+{
+    return m_instance;
 }
 
 void ReverseResolution::resolve(const QHostAddress &ip)
 {
-    const QString *hostname = m_cache.object(ip);
-    if (hostname)
+    const CacheEntry *entry = m_cache.object(ip);
+    if (entry)
     {
-        emit ipResolved(ip, *hostname);
-        return;
+        if (entry->expiryTime > QDateTime::currentSecsSinceEpoch())
+        {
+            emit ipResolved(ip, entry->hostName);
+            return;
+        }
+
+        m_cache.remove(ip);
     }
 
-    // do reverse lookup: IP -> hostname
-    const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
-    m_lookups.insert(lookupId, ip);
+    // the same address is usually requested by several views and on every refresh
+    if (m_requestedIPs.contains(ip))
+        return;
+
+    if (m_pendingQueue.size() >= MAX_PENDING_LOOKUPS)
+        return;
+
+    m_requestedIPs.insert(ip);
+    m_pendingQueue.enqueue(ip);
+    startPendingLookups();
+}
+
+void ReverseResolution::startPendingLookups()
+{
+    // don't flood the system resolver (and Qt's lookup thread pool) with requests
+    while ((m_lookups.size() < MAX_CONCURRENT_LOOKUPS) && !m_pendingQueue.isEmpty())
+    {
+        const QHostAddress ip = m_pendingQueue.dequeue();
+
+        // do reverse lookup: IP -> hostname
+        const int lookupId = QHostInfo::lookupHost(ip.toString(), this, &ReverseResolution::hostResolved);
+        m_lookups.insert(lookupId, ip);
+    }
 }
 
 void ReverseResolution::hostResolved(const QHostInfo &host)
 {
     const QHostAddress ip = m_lookups.take(host.lookupId());
+    m_requestedIPs.remove(ip);
 
     if (host.error() != QHostInfo::NoError)
     {
+        // transient errors are not cached for long
+        if (host.error() == QHostInfo::HostNotFound)
+            addToCache(ip, {}, NEGATIVE_TTL);
+
         emit ipResolved(ip, {});
+    }
+    else
+    {
+        const QString hostname = isUsefulHostName(host.hostName(), ip)
+            ? host.hostName()
+            : QString();
+        addToCache(ip, hostname, (hostname.isEmpty() ? NEGATIVE_TTL : POSITIVE_TTL));
+        emit ipResolved(ip, hostname);
+    }
+
+    startPendingLookups();
+}
+
+void ReverseResolution::addToCache(const QHostAddress &ip, const QString &hostname, const qint64 ttl)
+{
+    m_cache.insert(ip, new CacheEntry {hostname, (QDateTime::currentSecsSinceEpoch() + ttl)});
+    m_isCacheDirty = true;
+}
+
+void ReverseResolution::loadCache()
+{
+    QFile file {cacheFilePath()};
+    if (!file.exists())
+        return;
+
+    if (!file.open(QFile::ReadOnly))
+    {
+        LogMsg(tr("Couldn't load host name cache. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), file.errorString()), Log::WARNING);
+        return;
+    }
+
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll());
+    if (!jsonDoc.isArray())
+        return;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const QJsonValue &jsonVal : asConst(jsonDoc.array()))
+    {
+        const QJsonObject jsonObj = jsonVal.toObject();
+        const QHostAddress ip {jsonObj.value(QLatin1String("ip")).toString()};
+        const qint64 expiryTime = jsonObj.value(QLatin1String("expires")).toVariant().toLongLong();
+        if (ip.isNull() || (expiryTime <= now))
+            continue;
+
+        m_cache.insert(ip, new CacheEntry {jsonObj.value(QLatin1String("hostname")).toString(), expiryTime});
+    }
+}
+
+void ReverseResolution::storeCache()
+{
+    if (!m_isCacheDirty)
+        return;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    QJsonArray jsonArr;
+    for (const QHostAddress &ip : asConst(m_cache.keys()))
+    {
+        const CacheEntry *entry = m_cache.object(ip);
+        if (entry->expiryTime <= now)
+            continue;
+
+        jsonArr.append(QJsonObject {
+            {QLatin1String("ip"), ip.toString()},
+            {QLatin1String("hostname"), entry->hostName},
+            {QLatin1String("expires"), entry->expiryTime}
+        });
+    }
+
+    QSaveFile file {cacheFilePath()};
+    if (!file.open(QFile::WriteOnly)
+        || (file.write(QJsonDocument(jsonArr).toJson(QJsonDocument::Compact)) == -1)
+        || !file.commit())
+    {
+        LogMsg(tr("Couldn't save host name cache. File: \"%1\". Error: \"%2\"")
+            .arg(file.fileName(), file.errorString()), Log::WARNING);
         return;
     }
 
-    const QString hostname = isUsefulHostName(host.hostName(), ip)
-        ? host.hostName()
-        : QString();
-    m_cache.insert(ip, new QString(hostname));
-    emit ipResolved(ip, hostname);
+    m_isCacheDirty = false;
 }
@@ -29,22 +29,30 @@
 #pragma once
 
 #include <QCache>
+#include <QHash>
+#include <QHostAddress>
 #include <QObject>
+#include <QQueue>
+#include <QSet>
 
-class QHostAddress;
 class QHostInfo;
 class QString;
+class QTimer;
 
 namespace Net
 {
+    // Shared by all peer views so that the same address is never looked up twice.
+    // Lookups are throttled and both positive and negative results are cached
+    // on disk until they expire.
     class ReverseResolution : public QObject
     {
         Q_OBJECT
         Q_DISABLE_COPY(ReverseResolution)
 
     public:
-        explicit ReverseResolution(QObject *parent = nullptr);
-        ~ReverseResolution();
+        static void initInstance();
+        static void freeInstance();
+        static ReverseResolution *instance();
 
         void resolve(const QHostAddress &ip);
 
@@ -53,9 +61,29 @@ namespace Net
 
     private slots:
         void hostResolved(const QHostInfo &host);
+        void storeCache();
 
     private:
+        struct CacheEntry
+        {
+            QString hostName;  // empty if lookup failed or yielded nothing useful
+            qint64 expiryTime;  // seconds since epoch
+        };
+
+        ReverseResolution();
+        ~ReverseResolution() override;
+
+        void startPendingLookups();
+        void addToCache(const QHostAddress &ip, const QString &hostname, qint64 ttl);
+        void loadCache();
+
+        static ReverseResolution *m_instance;
+
         QHash<int, QHostAddress> m_lookups;  // <LookupID, IP>
-        QCache<QHostAddress, QString> m_cache;  // <IP, HostName>
+        QQueue<QHostAddress> m_pendingQueue;
+        QSet<QHostAddress> m_requestedIPs;  // either pending or in flight
+        QCache<QHostAddress, CacheEntry> m_cache;  // <IP, HostName>
+        QTimer *m_storeTimer = nullptr;
+        bool m_isCacheDirty = false;
     };
 }
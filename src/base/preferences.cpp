@@ -492,6 +492,16 @@ void Preferences::setSearchEnabled(const bool enabled)
     setValue("Preferences/Search/SearchEnabled", enabled);
 }
 
+int Preferences::getSearchResultsCacheTTL() const
+{
+    return value("Preferences/Search/ResultsCacheTTL", 300).toInt();
+}
+
+void Preferences::setSearchResultsCacheTTL(const int seconds)
+{
+    setValue("Preferences/Search/ResultsCacheTTL", seconds);
+}
+
 bool Preferences::isWebUiEnabled() const
 {
 #ifdef DISABLE_GUI
@@ -168,6 +168,8 @@ public:
     // Search
     bool isSearchEnabled() const;
     void setSearchEnabled(bool enabled);
+    int getSearchResultsCacheTTL() const;
+    void setSearchResultsCacheTTL(int seconds);
 
     // HTTP Server
     bool isWebUiEnabled() const;
@@ -31,7 +31,6 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QStringList>
-#include <QTextStream>
 
 #include "bittorrent/session.h"
 #include "filesystemwatcher.h"
@@ -356,54 +355,36 @@ void ScanFoldersModel::configure()
     }
 }
 
-void ScanFoldersModel::addTorrentsToSession(const QStringList &pathList)
+void ScanFoldersModel::addTorrentsToSession(const QVector<WatchedTorrentFile> &files)
 {
-    for (const QString &file : pathList)
+    for (const WatchedTorrentFile &file : files)
     {
-        qDebug("File %s added", qUtf8Printable(file));
+        qDebug("File %s added", qUtf8Printable(file.path));
 
         BitTorrent::AddTorrentParams params;
-        if (downloadInWatchFolder(file))
+        if (downloadInWatchFolder(file.path))
         {
-            params.savePath = QFileInfo(file).dir().path();
+            params.savePath = QFileInfo(file.path).dir().path();
             params.useAutoTMM = false;
         }
-        else if (!downloadInDefaultFolder(file))
+        else if (!downloadInDefaultFolder(file.path))
         {
-            params.savePath = downloadPathTorrentFolder(file);
+            params.savePath = downloadPathTorrentFolder(file.path);
             params.useAutoTMM = false;
         }
 
-        if (file.endsWith(".magnet", Qt::CaseInsensitive))
+        // files are already validated and decoded by the watcher
+        if (file.torrentInfo.isValid())
         {
-            QFile f(file);
-            if (f.open(QIODevice::ReadOnly | QIODevice::Text))
-            {
-                QTextStream str(&f);
-                while (!str.atEnd())
-                    BitTorrent::Session::instance()->addTorrent(str.readLine(), params);
-
-                f.close();
-                Utils::Fs::forceRemove(file);
-            }
-            else
-            {
-                qDebug("Failed to open magnet file: %s", qUtf8Printable(f.errorString()));
-            }
+            BitTorrent::Session::instance()->addTorrent(file.torrentInfo, params);
         }
         else
         {
-            const BitTorrent::TorrentInfo torrentInfo = BitTorrent::TorrentInfo::loadFromFile(file);
-            if (torrentInfo.isValid())
-            {
-                BitTorrent::Session::instance()->addTorrent(torrentInfo, params);
-                Utils::Fs::forceRemove(file);
-            }
-            else
-            {
-                qDebug("Ignoring incomplete torrent file: %s", qUtf8Printable(file));
-            }
+            for (const QString &magnetURI : file.magnetURIs)
+                BitTorrent::Session::instance()->addTorrent(magnetURI, params);
         }
+
+        Utils::Fs::forceRemove(file.path);
     }
 }
 
@@ -33,6 +33,7 @@
 #include <QtContainerFwd>
 
 class FileSystemWatcher;
+struct WatchedTorrentFile;
 
 class ScanFoldersModel final : public QAbstractListModel
 {
@@ -91,7 +92,7 @@ public slots:
     void configure();
 
 private slots:
-    void addTorrentsToSession(const QStringList &pathList);
+    void addTorrentsToSession(const QVector<WatchedTorrentFile> &files);
 
 private:
     explicit ScanFoldersModel(QObject *parent = nullptr);
@@ -29,29 +29,11 @@
 
 #include "searchhandler.h"
 
-#include <QProcess>
 #include <QTimer>
 #include <QVector>
 
-#include "base/global.h"
-#include "base/utils/foreignapps.h"
-#include "base/utils/fs.h"
 #include "searchpluginmanager.h"
-
-namespace
-{
-    enum SearchResultColumn
-    {
-        PL_DL_LINK,
-        PL_NAME,
-        PL_SIZE,
-        PL_SEEDS,
-        PL_LEECHS,
-        PL_ENGINE_URL,
-        PL_DESC_LINK,
-        NB_PLUGIN_COLUMNS
-    };
-}
+#include "searchworkerpool.h"
 
 SearchHandler::SearchHandler(const QString &pattern, const QString &category, const QStringList &usedPlugins, SearchPluginManager *manager)
     : QObject {manager}
@@ -59,137 +41,98 @@ SearchHandler::SearchHandler(const QString &pattern, const QString &category, co
     , m_category {category}
     , m_usedPlugins {usedPlugins}
     , m_manager {manager}
-    , m_searchProcess {new QProcess {this}}
     , m_searchTimeout {new QTimer {this}}
 {
-    // Load environment variables (proxy)
-    m_searchProcess->setEnvironment(QProcess::systemEnvironment());
-
-    const QStringList params
+    QList<SearchResult> cachedResults;
+    if (m_manager->findCachedSearchResults(m_pattern, m_category, m_usedPlugins, cachedResults))
     {
-        Utils::Fs::toNativePath(m_manager->engineLocation() + "/nova2.py"),
-        m_usedPlugins.join(','),
-        m_category
-    };
-
-    // Launch search
-    m_searchProcess->setProgram(Utils::ForeignApps::pythonInfo().executableName);
-    m_searchProcess->setArguments(params + m_pattern.split(' '));
+        // deferred so that clients can handle starting-related signals
+        QTimer::singleShot(0, this, [this, cachedResults]()
+        {
+            m_results = cachedResults;
+            m_isActive = false;
+            if (!m_results.isEmpty())
+                emit newSearchResults(m_results.toVector());
+            emit searchFinished(false);
+        });
+        return;
+    }
 
-    connect(m_searchProcess, &QProcess::errorOccurred, this, &SearchHandler::processFailed);
-    connect(m_searchProcess, &QProcess::readyReadStandardOutput, this, &SearchHandler::readSearchOutput);
-    connect(m_searchProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
-            , this, &SearchHandler::processFinished);
+    m_workerPool = m_manager->workerPool();
+    connect(m_workerPool, &SearchWorkerPool::newSearchResults, this, &SearchHandler::handleSearchResults);
+    connect(m_workerPool, &SearchWorkerPool::searchFinished, this, &SearchHandler::handleSearchFinished);
+    connect(m_workerPool, &SearchWorkerPool::searchFailed, this, &SearchHandler::handleSearchFailed);
 
     m_searchTimeout->setSingleShot(true);
     connect(m_searchTimeout, &QTimer::timeout, this, &SearchHandler::cancelSearch);
     m_searchTimeout->start(180000); // 3 min
 
-    // deferred start allows clients to handle starting-related signals
-    QTimer::singleShot(0, this, [this]() { m_searchProcess->start(QIODevice::ReadOnly); });
+    m_requestID = m_workerPool->startSearch(m_pattern, m_category, m_usedPlugins);
+}
+
+SearchHandler::~SearchHandler()
+{
+    // the worker is shared, stop it from working for nobody
+    if (m_isActive && !m_searchCancelled && m_workerPool)
+        m_workerPool->cancelSearch(m_requestID);
 }
 
 bool SearchHandler::isActive() const
 {
-    return (m_searchProcess->state() != QProcess::NotRunning);
+    return m_isActive;
 }
 
 void SearchHandler::cancelSearch()
 {
-    if ((m_searchProcess->state() == QProcess::NotRunning) || m_searchCancelled)
+    if (!m_isActive || m_searchCancelled)
         return;
 
-#ifdef Q_OS_WIN
-    m_searchProcess->kill();
-#else
-    m_searchProcess->terminate();
-#endif
+    if (m_workerPool)
+        m_workerPool->cancelSearch(m_requestID);
     m_searchCancelled = true;
     m_searchTimeout->stop();
 }
 
-// Slot called when QProcess is Finished
-// QProcess can be finished for 3 reasons:
-// Error | Stopped by user | Finished normally
-void SearchHandler::processFinished(const int exitcode)
+void SearchHandler::handleSearchResults(const int requestID, const QVector<SearchResult> &results)
 {
-    m_searchTimeout->stop();
+    if ((requestID != m_requestID) || m_searchCancelled)
+        return;
 
-    if (m_searchCancelled)
-        emit searchFinished(true);
-    else if ((m_searchProcess->exitStatus() == QProcess::NormalExit) && (exitcode == 0))
-        emit searchFinished(false);
-    else
-        emit searchFailed();
+    for (const SearchResult &result : results)
+        m_results.append(result);
+    emit newSearchResults(results);
 }
 
-// search QProcess return output as soon as it gets new
-// stuff to read. We split it into lines and parse each
-// line to SearchResult calling parseSearchResult().
-void SearchHandler::readSearchOutput()
+void SearchHandler::handleSearchFinished(const int requestID, const bool cancelled)
 {
-    QByteArray output = m_searchProcess->readAllStandardOutput();
-    output.replace('\r', "");
-
-    QList<QByteArray> lines = output.split('\n');
-    if (!m_searchResultLineTruncated.isEmpty())
-        lines.prepend(m_searchResultLineTruncated + lines.takeFirst());
-    m_searchResultLineTruncated = lines.takeLast().trimmed();
-
-    QVector<SearchResult> searchResultList;
-    searchResultList.reserve(lines.size());
+    if (requestID != m_requestID)
+        return;
 
-    for (const QByteArray &line : asConst(lines))
-    {
-        SearchResult searchResult;
-        if (parseSearchResult(QString::fromUtf8(line), searchResult))
-            searchResultList << searchResult;
-    }
+    m_isActive = false;
+    m_searchTimeout->stop();
 
-    if (!searchResultList.isEmpty())
+    if (cancelled || m_searchCancelled)
     {
-        for (const SearchResult &result : searchResultList)
-            m_results.append(result);
-        emit newSearchResults(searchResultList);
+        emit searchFinished(true);
+        return;
     }
-}
 
-void SearchHandler::processFailed()
-{
-    if (!m_searchCancelled)
-        emit searchFailed();
+    m_manager->cacheSearchResults(m_pattern, m_category, m_usedPlugins, m_results);
+    emit searchFinished(false);
 }
 
-// Parse one line of search results list
-// Line is in the following form:
-// file url | file name | file size | nb seeds | nb leechers | Search engine url
-bool SearchHandler::parseSearchResult(const QString &line, SearchResult &searchResult)
+void SearchHandler::handleSearchFailed(const int requestID)
 {
-    const QVector<QStringRef> parts = line.splitRef('|');
-    const int nbFields = parts.size();
-
-    if (nbFields < (NB_PLUGIN_COLUMNS - 1)) return false; // -1 because desc_link is optional
-
-    searchResult = SearchResult();
-    searchResult.fileUrl = parts.at(PL_DL_LINK).trimmed().toString(); // download URL
-    searchResult.fileName = parts.at(PL_NAME).trimmed().toString(); // Name
-    searchResult.fileSize = parts.at(PL_SIZE).trimmed().toLongLong(); // Size
-
-    bool ok = false;
-
-    searchResult.nbSeeders = parts.at(PL_SEEDS).trimmed().toLongLong(&ok); // Seeders
-    if (!ok || (searchResult.nbSeeders < 0))
-        searchResult.nbSeeders = -1;
-
-    searchResult.nbLeechers = parts.at(PL_LEECHS).trimmed().toLongLong(&ok); // Leechers
-    if (!ok || (searchResult.nbLeechers < 0))
-        searchResult.nbLeechers = -1;
+    if (requestID != m_requestID)
+        return;
 
-    searchResult.siteUrl = parts.at(PL_ENGINE_URL).trimmed().toString(); // Search site URL
-    if (nbFields == NB_PLUGIN_COLUMNS)
-        searchResult.descrLink = parts.at(PL_DESC_LINK).trimmed().toString(); // Description Link
+    m_isActive = false;
+    m_searchTimeout->stop();
 
-    return true;
+    if (m_searchCancelled)
+        emit searchFinished(true);
+    else
+        emit searchFailed();
 }
 
 SearchPluginManager *SearchHandler::manager() const
@@ -32,10 +32,10 @@
 #include <QByteArray>
 #include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QString>
 #include <QtContainerFwd>
 
-class QProcess;
 class QTimer;
 
 struct SearchResult
@@ -50,6 +50,7 @@ struct SearchResult
 };
 
 class SearchPluginManager;
+class SearchWorkerPool;
 
 class SearchHandler : public QObject
 {
@@ -62,6 +63,8 @@ class SearchHandler : public QObject
                   , const QStringList &usedPlugins, SearchPluginManager *manager);
 
 public:
+    ~SearchHandler() override;
+
     bool isActive() const;
     QString pattern() const;
     SearchPluginManager *manager() const;
@@ -75,18 +78,19 @@ signals:
     void newSearchResults(const QVector<SearchResult> &results);
 
 private:
-    void readSearchOutput();
-    void processFailed();
-    void processFinished(int exitcode);
-    bool parseSearchResult(const QString &line, SearchResult &searchResult);
+    void handleSearchResults(int requestID, const QVector<SearchResult> &results);
+    void handleSearchFinished(int requestID, bool cancelled);
+    void handleSearchFailed(int requestID);
 
     const QString m_pattern;
     const QString m_category;
     const QStringList m_usedPlugins;
     SearchPluginManager *m_manager;
-    QProcess *m_searchProcess;
+    // the pool may be destroyed first when the manager goes away
+    QPointer<SearchWorkerPool> m_workerPool;
     QTimer *m_searchTimeout;
-    QByteArray m_searchResultLineTruncated;
+    int m_requestID = -1;
+    bool m_isActive = true;
     bool m_searchCancelled = false;
     QList<SearchResult> m_results;
 };
@@ -35,6 +35,7 @@
 #include <QDirIterator>
 #include <QDomDocument>
 #include <QDomElement>
+#include <QDateTime>
 #include <QDomNode>
 #include <QPointer>
 #include <QProcess>
@@ -49,6 +50,7 @@
 #include "base/utils/fs.h"
 #include "searchdownloadhandler.h"
 #include "searchhandler.h"
+#include "searchworkerpool.h"
 
 namespace
 {
@@ -79,6 +81,12 @@ namespace
             }
         }
     }
+
+    QString searchCacheKey(const QString &pattern, const QString &category, QStringList usedPlugins)
+    {
+        usedPlugins.sort();
+        return (category + '\n' + usedPlugins.join(',') + '\n' + pattern);
+    }
 }
 
 QPointer<SearchPluginManager> SearchPluginManager::m_instance = nullptr;
@@ -91,6 +99,14 @@ SearchPluginManager::SearchPluginManager()
 
     updateNova();
     update();
+
+    m_workerPool = new SearchWorkerPool(this);
+    connect(m_workerPool, &SearchWorkerPool::engineFinished, this, &SearchPluginManager::handleEngineFinished);
+
+    // workers have to re-import engines
+    connect(this, &SearchPluginManager::pluginInstalled, this, &SearchPluginManager::handlePluginsChanged);
+    connect(this, &SearchPluginManager::pluginUninstalled, this, &SearchPluginManager::handlePluginsChanged);
+    connect(this, &SearchPluginManager::pluginUpdated, this, &SearchPluginManager::handlePluginsChanged);
 }
 
 SearchPluginManager::~SearchPluginManager()
@@ -335,6 +351,71 @@ SearchHandler *SearchPluginManager::startSearch(const QString &pattern, const QS
     return new SearchHandler {pattern, category, usedPlugins, this};
 }
 
+SearchWorkerPool *SearchPluginManager::workerPool() const
+{
+    return m_workerPool;
+}
+
+bool SearchPluginManager::findCachedSearchResults(const QString &pattern, const QString &category
+    , const QStringList &usedPlugins, QList<SearchResult> &results) const
+{
+    const qint64 ttl = Preferences::instance()->getSearchResultsCacheTTL();
+    if (ttl <= 0)
+        return false;
+
+    const auto iter = m_searchCache.constFind(searchCacheKey(pattern, category, usedPlugins));
+    if (iter == m_searchCache.cend())
+        return false;
+
+    if ((QDateTime::currentMSecsSinceEpoch() - iter->timestamp) > (ttl * 1000))
+        return false;
+
+    results = iter->results;
+    return true;
+}
+
+void SearchPluginManager::cacheSearchResults(const QString &pattern, const QString &category
+    , const QStringList &usedPlugins, const QList<SearchResult> &results)
+{
+    const qint64 ttl = Preferences::instance()->getSearchResultsCacheTTL();
+    if (ttl <= 0)
+        return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // drop expired entries
+    for (auto i = m_searchCache.begin(); i != m_searchCache.end();)
+    {
+        if ((now - i->timestamp) > (ttl * 1000))
+            i = m_searchCache.erase(i);
+        else
+            ++i;
+    }
+
+    m_searchCache[searchCacheKey(pattern, category, usedPlugins)] = {results, now};
+}
+
+PluginStatistics SearchPluginManager::pluginStatistics(const QString &name) const
+{
+    return m_pluginStatistics.value(name);
+}
+
+void SearchPluginManager::handleEngineFinished(const QString &engineName, const qint64 elapsedMs, const bool ok)
+{
+    PluginStatistics &stats = m_pluginStatistics[engineName];
+    ++stats.searchCount;
+    if (!ok)
+        ++stats.failureCount;
+    stats.totalTime += elapsedMs;
+    stats.lastTime = elapsedMs;
+}
+
+void SearchPluginManager::handlePluginsChanged()
+{
+    m_searchCache.clear();
+    m_workerPool->restart();
+}
+
 QString SearchPluginManager::categoryFullName(const QString &categoryName)
 {
     const QHash<QString, QString> categoryTable
@@ -440,6 +521,7 @@ void SearchPluginManager::updateNova()
     updateFile("helpers.py", true);
     updateFile("nova2.py", true);
     updateFile("nova2dl.py", true);
+    updateFile("nova2worker.py", true);
     updateFile("novaprinter.py", true);
     updateFile("sgmllib3.py", false);
     updateFile("socks.py", false);
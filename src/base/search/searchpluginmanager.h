@@ -30,10 +30,12 @@
 #pragma once
 
 #include <QHash>
+#include <QList>
 #include <QMetaType>
 #include <QObject>
 
 #include "base/utils/version.h"
+#include "searchhandler.h"
 
 using PluginVersion = Utils::Version<unsigned short, 2>;
 Q_DECLARE_METATYPE(PluginVersion)
@@ -54,8 +56,16 @@ struct PluginInfo
     bool enabled;
 };
 
+struct PluginStatistics
+{
+    int searchCount = 0;
+    int failureCount = 0;
+    qint64 totalTime = 0;  // milliseconds
+    qint64 lastTime = 0;  // milliseconds
+};
+
 class SearchDownloadHandler;
-class SearchHandler;
+class SearchWorkerPool;
 
 class SearchPluginManager : public QObject
 {
@@ -83,6 +93,12 @@ public:
     void checkForUpdates();
 
     SearchHandler *startSearch(const QString &pattern, const QString &category, const QStringList &usedPlugins);
+    SearchWorkerPool *workerPool() const;
+    bool findCachedSearchResults(const QString &pattern, const QString &category, const QStringList &usedPlugins
+                                 , QList<SearchResult> &results) const;
+    void cacheSearchResults(const QString &pattern, const QString &category, const QStringList &usedPlugins
+                            , const QList<SearchResult> &results);
+    PluginStatistics pluginStatistics(const QString &name) const;
     SearchDownloadHandler *downloadTorrent(const QString &siteUrl, const QString &url);
 
     static PluginVersion getPluginVersion(const QString &filePath);
@@ -111,6 +127,8 @@ private:
 
     void versionInfoDownloadFinished(const Net::DownloadResult &result);
     void pluginDownloadFinished(const Net::DownloadResult &result);
+    void handleEngineFinished(const QString &engineName, qint64 elapsedMs, bool ok);
+    void handlePluginsChanged();
 
     static QString pluginPath(const QString &name);
 
@@ -119,4 +137,14 @@ private:
     const QString m_updateUrl;
 
     QHash<QString, PluginInfo*> m_plugins;
+    QHash<QString, PluginStatistics> m_pluginStatistics;
+
+    SearchWorkerPool *m_workerPool = nullptr;
+
+    struct CachedSearch
+    {
+        QList<SearchResult> results;
+        qint64 timestamp;  // msecs since epoch
+    };
+    QHash<QString, CachedSearch> m_searchCache;
 };
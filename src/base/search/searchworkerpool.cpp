@@ -0,0 +1,299 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include "searchworkerpool.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTimer>
+
+#include "base/global.h"
+#include "base/logger.h"
+#include "base/utils/foreignapps.h"
+#include "base/utils/fs.h"
+#include "searchhandler.h"
+#include "searchpluginmanager.h"
+
+namespace
+{
+    const int MAX_WORKERS = 2;
+}
+
+SearchWorkerPool::SearchWorkerPool(QObject *parent)
+    : QObject {parent}
+{
+}
+
+SearchWorkerPool::~SearchWorkerPool()
+{
+    for (Worker *worker : asConst(m_workers))
+    {
+        worker->process->disconnect(this);
+        worker->process->kill();
+        worker->process->waitForFinished(1000);
+        delete worker;
+    }
+}
+
+int SearchWorkerPool::startSearch(const QString &pattern, const QString &category, const QStringList &usedPlugins)
+{
+    const int requestID = ++m_lastRequestID;
+
+    Worker *worker = acquireWorker();
+    if (!worker)
+    {
+        // deferred so that clients can connect to the signal first
+        QTimer::singleShot(0, this, [this, requestID]() { emit searchFailed(requestID); });
+        return requestID;
+    }
+
+    worker->activeRequests.insert(requestID);
+    m_requestWorkers[requestID] = worker;
+
+    send(worker, {
+        {QLatin1String("op"), QLatin1String("search")},
+        {QLatin1String("id"), requestID},
+        {QLatin1String("engines"), QJsonArray::fromStringList(usedPlugins)},
+        {QLatin1String("category"), category},
+        {QLatin1String("query"), pattern}
+    });
+
+    return requestID;
+}
+
+void SearchWorkerPool::cancelSearch(const int requestID)
+{
+    Worker *worker = m_requestWorkers.value(requestID);
+    if (!worker)
+        return;
+
+    send(worker, {
+        {QLatin1String("op"), QLatin1String("cancel")},
+        {QLatin1String("id"), requestID}
+    });
+}
+
+void SearchWorkerPool::restart()
+{
+    for (Worker *worker : asConst(m_workers))
+        retireWorker(worker);
+}
+
+SearchWorkerPool::Worker *SearchWorkerPool::acquireWorker()
+{
+    Worker *leastBusyWorker = nullptr;
+    int workerCount = 0;
+    for (Worker *worker : asConst(m_workers))
+    {
+        if (worker->isRetired)
+            continue;
+
+        ++workerCount;
+        if (!leastBusyWorker || (worker->activeRequests.size() < leastBusyWorker->activeRequests.size()))
+            leastBusyWorker = worker;
+    }
+
+    // each worker already runs engines concurrently, only spread searches
+    // when a worker is busy
+    if ((!leastBusyWorker || !leastBusyWorker->activeRequests.isEmpty()) && (workerCount < MAX_WORKERS))
+        return createWorker();
+
+    return leastBusyWorker;
+}
+
+SearchWorkerPool::Worker *SearchWorkerPool::createWorker()
+{
+    auto *process = new QProcess(this);
+    // Load environment variables (proxy)
+    process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+    process->setProgram(Utils::ForeignApps::pythonInfo().executableName);
+    process->setArguments({Utils::Fs::toNativePath(SearchPluginManager::engineLocation() + "/nova2worker.py")});
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() { readWorkerOutput(process); });
+    connect(process, &QProcess::started, this, [this, process]() { handleWorkerStarted(process); });
+    connect(process, &QProcess::errorOccurred, this, [this, process](const QProcess::ProcessError error)
+    {
+        handleWorkerError(process, error);
+    });
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished)
+            , this, [this, process]() { handleWorkerExited(process); });
+
+    auto *worker = new Worker;
+    worker->process = process;
+    m_workers[process] = worker;
+
+    // requests are queued until the process is started, a failure is reported by errorOccurred()
+    process->start(QIODevice::ReadWrite);
+    return worker;
+}
+
+void SearchWorkerPool::send(Worker *worker, const QJsonObject &message)
+{
+    const QByteArray data = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    if (worker->isStarted)
+        worker->process->write(data);
+    else
+        worker->pendingMessages.append(data);
+}
+
+void SearchWorkerPool::retireWorker(Worker *worker)
+{
+    worker->isRetired = true;
+    if (worker->activeRequests.isEmpty() && worker->isStarted)
+        worker->process->closeWriteChannel();  // worker exits at end of input
+}
+
+void SearchWorkerPool::handleWorkerStarted(QProcess *process)
+{
+    Worker *worker = m_workers.value(process);
+    if (!worker)
+        return;
+
+    worker->isStarted = true;
+    for (const QByteArray &data : asConst(worker->pendingMessages))
+        process->write(data);
+    worker->pendingMessages.clear();
+
+    if (worker->isRetired && worker->activeRequests.isEmpty())
+        process->closeWriteChannel();
+}
+
+void SearchWorkerPool::handleWorkerError(QProcess *process, const QProcess::ProcessError error)
+{
+    // the other errors are followed by finished()
+    if (error != QProcess::FailedToStart)
+        return;
+
+    Worker *worker = m_workers.value(process);
+    if (!worker)
+        return;
+
+    LogMsg(tr("Failed to start search worker. Reason: %1").arg(process->errorString()), Log::WARNING);
+    // already reported, don't log it as an unexpected exit
+    worker->isRetired = true;
+    // it can be emitted from start(), while the caller is still setting up its request
+    QTimer::singleShot(0, this, [this, process]() { handleWorkerExited(process); });
+}
+
+void SearchWorkerPool::readWorkerOutput(QProcess *process)
+{
+    Worker *worker = m_workers.value(process);
+    if (!worker)
+        return;
+
+    worker->receivedData.append(process->readAllStandardOutput());
+
+    // results are delivered in batches, one per chunk of output
+    QHash<int, QVector<SearchResult>> results;
+
+    int start = 0;
+    int end = worker->receivedData.indexOf('\n');
+    while (end >= 0)
+    {
+        processMessage(worker, worker->receivedData.mid(start, (end - start)), results);
+        start = end + 1;
+        end = worker->receivedData.indexOf('\n', start);
+    }
+    worker->receivedData.remove(0, start);
+
+    for (auto i = results.cbegin(); i != results.cend(); ++i)
+        emit newSearchResults(i.key(), i.value());
+}
+
+void SearchWorkerPool::processMessage(Worker *worker, const QByteArray &message, QHash<int, QVector<SearchResult>> &results)
+{
+    const QJsonObject jsonObj = QJsonDocument::fromJson(message).object();
+    const int requestID = jsonObj.value(QLatin1String("id")).toInt(-1);
+    if (!worker->activeRequests.contains(requestID))
+        return;
+
+    const QString type = jsonObj.value(QLatin1String("type")).toString();
+    if (type == QLatin1String("result"))
+    {
+        SearchResult result;
+        result.fileUrl = jsonObj.value(QLatin1String("link")).toString().trimmed();
+        result.fileName = jsonObj.value(QLatin1String("name")).toString().trimmed();
+        result.fileSize = jsonObj.value(QLatin1String("size")).toVariant().toLongLong();
+
+        bool ok = false;
+        result.nbSeeders = jsonObj.value(QLatin1String("seeds")).toVariant().toLongLong(&ok);
+        if (!ok || (result.nbSeeders < 0))
+            result.nbSeeders = -1;
+
+        result.nbLeechers = jsonObj.value(QLatin1String("leech")).toVariant().toLongLong(&ok);
+        if (!ok || (result.nbLeechers < 0))
+            result.nbLeechers = -1;
+
+        result.siteUrl = jsonObj.value(QLatin1String("engine_url")).toString().trimmed();
+        result.descrLink = jsonObj.value(QLatin1String("desc_link")).toString().trimmed();
+
+        results[requestID].append(result);
+    }
+    else if (type == QLatin1String("engine_finished"))
+    {
+        emit engineFinished(jsonObj.value(QLatin1String("engine")).toString()
+                            , jsonObj.value(QLatin1String("elapsed_ms")).toVariant().toLongLong()
+                            , jsonObj.value(QLatin1String("ok")).toBool());
+    }
+    else if (type == QLatin1String("finished"))
+    {
+        worker->activeRequests.remove(requestID);
+        m_requestWorkers.remove(requestID);
+        if (worker->isRetired && worker->activeRequests.isEmpty() && worker->isStarted)
+            worker->process->closeWriteChannel();
+
+        const QVector<SearchResult> lastResults = results.take(requestID);
+        if (!lastResults.isEmpty())
+            emit newSearchResults(requestID, lastResults);
+        emit searchFinished(requestID, jsonObj.value(QLatin1String("cancelled")).toBool());
+    }
+}
+
+void SearchWorkerPool::handleWorkerExited(QProcess *process)
+{
+    Worker *worker = m_workers.take(process);
+    if (!worker)
+        return;
+
+    if (!worker->isRetired)
+    {
+        LogMsg(tr("Search worker exited unexpectedly. Exit code: %1").arg(process->exitCode()), Log::WARNING);
+    }
+
+    for (const int requestID : asConst(worker->activeRequests))
+    {
+        m_requestWorkers.remove(requestID);
+        emit searchFailed(requestID);
+    }
+
+    process->deleteLater();
+    delete worker;
+}
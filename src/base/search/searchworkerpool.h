@@ -0,0 +1,92 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+#include <QVector>
+
+class QJsonObject;
+
+struct SearchResult;
+
+// Keeps a few long-running Python search workers (nova2worker.py) so that
+// the interpreter start-up and engine imports happen once, not per search.
+// Requests and responses are exchanged as newline delimited JSON objects.
+class SearchWorkerPool final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SearchWorkerPool)
+
+public:
+    explicit SearchWorkerPool(QObject *parent = nullptr);
+    ~SearchWorkerPool() override;
+
+    int startSearch(const QString &pattern, const QString &category, const QStringList &usedPlugins);
+    void cancelSearch(int requestID);
+
+    // Workers stop accepting new searches and exit once their current ones
+    // are done, e.g. after search plugins were changed.
+    void restart();
+
+signals:
+    void newSearchResults(int requestID, const QVector<SearchResult> &results);
+    void searchFinished(int requestID, bool cancelled);
+    void searchFailed(int requestID);
+    void engineFinished(const QString &engineName, qint64 elapsedMs, bool ok);
+
+private:
+    struct Worker
+    {
+        QProcess *process = nullptr;
+        QByteArray receivedData;
+        // messages waiting for the process to be started
+        QVector<QByteArray> pendingMessages;
+        QSet<int> activeRequests;
+        bool isStarted = false;
+        bool isRetired = false;
+    };
+
+    Worker *acquireWorker();
+    Worker *createWorker();
+    void readWorkerOutput(QProcess *process);
+    void handleWorkerStarted(QProcess *process);
+    void handleWorkerError(QProcess *process, QProcess::ProcessError error);
+    void handleWorkerExited(QProcess *process);
+    void processMessage(Worker *worker, const QByteArray &message, QHash<int, QVector<SearchResult>> &results);
+    void send(Worker *worker, const QJsonObject &message);
+    void retireWorker(Worker *worker);
+
+    QHash<QProcess *, Worker *> m_workers;
+    QHash<int, Worker *> m_requestWorkers;  // <RequestID, Worker>
+    int m_lastRequestID = 0;
+};
@@ -29,9 +29,12 @@
 
 #include "settingsstorage.h"
 
+#include <atomic>
 #include <memory>
+
 #include <QFile>
 #include <QHash>
+#include <QMetaObject>
 
 #include "global.h"
 #include "logger.h"
@@ -40,6 +43,17 @@
 
 namespace
 {
+    // Bumped whenever the settings snapshot is replaced, by any instance
+    std::atomic<quint64> dataVersion {0};
+
+    struct ThreadData
+    {
+        quint64 version = 0;
+        std::shared_ptr<const QVariantHash> data;
+    };
+
+    thread_local ThreadData threadData;
+
     // Encapsulates serialization of settings in "atomic" way.
     // write() does not leave half-written files,
     // read() has a workaround for a case of power loss during a previous serialization
@@ -157,8 +171,9 @@ namespace
 SettingsStorage *SettingsStorage::m_instance = nullptr;
 
 SettingsStorage::SettingsStorage()
-    : m_data {TransactionalSettings(QLatin1String("qBittorrent")).read()}
 {
+    setData(std::make_shared<const QVariantHash>(TransactionalSettings(QLatin1String("qBittorrent")).read()));
+
     m_timer.setSingleShot(true);
     m_timer.setInterval(5 * 1000);
     connect(&m_timer, &QTimer::timeout, this, &SettingsStorage::save);
@@ -189,11 +204,11 @@ SettingsStorage *SettingsStorage::instance()
 bool SettingsStorage::save()
 {
     if (!m_dirty) return true; // Obtaining the lock is expensive, let's check early
-    const QWriteLocker locker(&m_lock);  // to guard for `m_dirty`
+    const QMutexLocker locker(&m_mutex);  // to guard for `m_dirty`
     if (!m_dirty) return true; // something might have changed while we were getting the lock
 
     const TransactionalSettings settings(QLatin1String("qBittorrent"));
-    if (!settings.write(m_data))
+    if (!settings.write(*m_data))
     {
         m_timer.start();
         return false;
@@ -206,33 +221,73 @@ bool SettingsStorage::save()
 QVariant SettingsStorage::loadValueImpl(const QString &key, const QVariant &defaultValue) const
 {
     const QString realKey = mapKey(key);
-    const QReadLocker locker(&m_lock);
-    return m_data.value(realKey, defaultValue);
+    return data().value(realKey, defaultValue);
 }
 
 void SettingsStorage::storeValueImpl(const QString &key, const QVariant &value)
 {
     const QString realKey = mapKey(key);
-    const QWriteLocker locker(&m_lock);
-
-    QVariant &currentValue = m_data[realKey];
-    if (currentValue != value)
     {
+        const QMutexLocker locker(&m_mutex);
+
+        if (m_data->value(realKey) == value)
+            return;
+
+        auto newData = std::make_shared<QVariantHash>(*m_data);
+        newData->insert(realKey, value);
+        setData(std::move(newData));
+
         m_dirty = true;
-        currentValue = value;
         m_timer.start();
     }
+
+    notifyValueChanged(key);
 }
 
 void SettingsStorage::removeValue(const QString &key)
 {
     const QString realKey = mapKey(key);
-    const QWriteLocker locker(&m_lock);
-    if (m_data.remove(realKey) > 0)
     {
+        const QMutexLocker locker(&m_mutex);
+
+        if (!m_data->contains(realKey))
+            return;
+
+        auto newData = std::make_shared<QVariantHash>(*m_data);
+        newData->remove(realKey);
+        setData(std::move(newData));
+
         m_dirty = true;
         m_timer.start();
     }
+
+    notifyValueChanged(key);
+}
+
+const QVariantHash &SettingsStorage::data() const
+{
+    // The reference stays valid until this thread refreshes its snapshot
+    if (threadData.version != dataVersion.load(std::memory_order_acquire))
+    {
+        const QMutexLocker locker(&m_mutex);
+        threadData = {dataVersion.load(std::memory_order_relaxed), m_data};
+    }
+
+    return *threadData.data;
+}
+
+void SettingsStorage::setData(std::shared_ptr<const QVariantHash> data)
+{
+    // must be called with the mutex locked, or before the instance is shared
+    m_data = std::move(data);
+    dataVersion.fetch_add(1, std::memory_order_release);
+}
+
+void SettingsStorage::notifyValueChanged(const QString &key)
+{
+    // Don't run the handlers from within storeValue(), they may store values too
+    // or expect to run in the thread of the storage
+    QMetaObject::invokeMethod(this, "valueChanged", Qt::QueuedConnection, Q_ARG(QString, key));
 }
 
 QVariantHash TransactionalSettings::read() const
@@ -29,15 +29,18 @@
 
 #pragma once
 
+#include <memory>
 #include <type_traits>
 
+#include <QMutex>
 #include <QObject>
-#include <QReadWriteLock>
 #include <QTimer>
 #include <QVariantHash>
 
 #include "utils/string.h"
 
+// Every loadValue() call still maps the key, looks it up and converts the QVariant,
+// so frequently read settings should be kept in a CachedSettingValue.
 class SettingsStorage : public QObject
 {
     Q_OBJECT
@@ -83,14 +86,24 @@ public:
 public slots:
     bool save();
 
+signals:
+    // Always delivered through the event loop, whichever thread stored the value
+    void valueChanged(const QString &key);
+
 private:
     QVariant loadValueImpl(const QString &key, const QVariant &defaultValue = {}) const;
     void storeValueImpl(const QString &key, const QVariant &value);
+    const QVariantHash &data() const;
+    void setData(std::shared_ptr<const QVariantHash> data);
+    void notifyValueChanged(const QString &key);
 
     static SettingsStorage *m_instance;
 
     bool m_dirty = false;
-    QVariantHash m_data;
+    // Writers replace the snapshot with a modified copy. Each reading thread
+    // keeps its own reference to it and only takes the mutex to refresh it
+    // once the version changed, so reads don't lock as long as nothing is written.
+    std::shared_ptr<const QVariantHash> m_data;
     QTimer m_timer;
-    mutable QReadWriteLock m_lock;
+    mutable QMutex m_mutex;
 };
@@ -38,62 +38,123 @@
 #endif
 #include <zlib.h>
 
+namespace
+{
+    class DeflateStream
+    {
+    public:
+        explicit DeflateStream(const Utils::Gzip::Format format)
+            : m_format {format}
+        {
+            m_strm.zalloc = Z_NULL;
+            m_strm.zfree = Z_NULL;
+            m_strm.opaque = Z_NULL;
+        }
+
+        ~DeflateStream()
+        {
+            if (m_initialized)
+                deflateEnd(&m_strm);
+        }
+
+        DeflateStream(const DeflateStream &) = delete;
+        DeflateStream &operator=(const DeflateStream &) = delete;
+
+        z_stream *acquire(const int level)
+        {
+            if (!m_initialized)
+            {
+                // windowBits = 15 + 16 to enable gzip
+                // From the zlib manual: windowBits can also be greater than 15 for optional gzip encoding. Add 16 to windowBits
+                // to write a simple gzip header and trailer around the compressed data instead of a zlib wrapper.
+                const int windowBits = (m_format == Utils::Gzip::Format::Gzip) ? (15 + 16) : 15;
+                if (deflateInit2(&m_strm, level, Z_DEFLATED, windowBits, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+                    return nullptr;
+
+                m_initialized = true;
+                m_level = level;
+                return &m_strm;
+            }
+
+            // reuse the internal state (window, hash chains) allocated by a previous call
+            if (deflateReset(&m_strm) != Z_OK)
+                return reinit(level);
+
+            if ((level != m_level) && (deflateParams(&m_strm, level, Z_DEFAULT_STRATEGY) != Z_OK))
+                return reinit(level);
+
+            m_level = level;
+            return &m_strm;
+        }
+
+        void release(const bool failed)
+        {
+            // stream is left in an unknown state, start from scratch next time
+            if (failed && m_initialized)
+            {
+                deflateEnd(&m_strm);
+                m_initialized = false;
+            }
+        }
+
+    private:
+        z_stream *reinit(const int level)
+        {
+            deflateEnd(&m_strm);
+            m_initialized = false;
+            return acquire(level);
+        }
+
+        const Utils::Gzip::Format m_format;
+        z_stream m_strm;
+        bool m_initialized = false;
+        int m_level = Z_DEFAULT_COMPRESSION;
+    };
+
+    DeflateStream &threadStream(const Utils::Gzip::Format format)
+    {
+        thread_local DeflateStream gzipStream {Utils::Gzip::Format::Gzip};
+        thread_local DeflateStream zlibStream {Utils::Gzip::Format::Zlib};
+        return (format == Utils::Gzip::Format::Gzip) ? gzipStream : zlibStream;
+    }
+}
+
 QByteArray Utils::Gzip::compress(const QByteArray &data, const int level, bool *ok)
+{
+    return compress(data, Format::Gzip, level, ok);
+}
+
+QByteArray Utils::Gzip::compress(const QByteArray &data, const Format format, const int level, bool *ok)
 {
     if (ok) *ok = false;
 
     if (data.isEmpty())
         return {};
 
-    const int BUFSIZE = 128 * 1024;
-    std::vector<char> tmpBuf(BUFSIZE);
-
-    z_stream strm;
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.next_in = reinterpret_cast<const Bytef *>(data.constData());
-    strm.avail_in = uInt(data.size());
-    strm.next_out = reinterpret_cast<Bytef *>(tmpBuf.data());
-    strm.avail_out = BUFSIZE;
-
-    // windowBits = 15 + 16 to enable gzip
-    // From the zlib manual: windowBits can also be greater than 15 for optional gzip encoding. Add 16 to windowBits
-    // to write a simple gzip header and trailer around the compressed data instead of a zlib wrapper.
-    int result = deflateInit2(&strm, level, Z_DEFLATED, (15 + 16), 9, Z_DEFAULT_STRATEGY);
-    if (result != Z_OK)
+    DeflateStream &stream = threadStream(format);
+    z_stream *strm = stream.acquire(level);
+    if (!strm)
         return {};
 
+    // deflateBound() is an upper bound for a single-pass compression, so the output
+    // can be written in place without an intermediate buffer
     QByteArray output;
-    output.reserve(deflateBound(&strm, data.size()));
+    output.resize(deflateBound(strm, data.size()));
 
-    // feed to deflate
-    while (strm.avail_in > 0)
-    {
-        result = deflate(&strm, Z_NO_FLUSH);
+    strm->next_in = reinterpret_cast<const Bytef *>(data.constData());
+    strm->avail_in = uInt(data.size());
+    strm->next_out = reinterpret_cast<Bytef *>(output.data());
+    strm->avail_out = uInt(output.size());
 
-        if (result != Z_OK)
-        {
-            deflateEnd(&strm);
-            return {};
-        }
-
-        output.append(tmpBuf.data(), (BUFSIZE - strm.avail_out));
-        strm.next_out = reinterpret_cast<Bytef *>(tmpBuf.data());
-        strm.avail_out = BUFSIZE;
-    }
-
-    // flush the rest from deflate
-    while (result != Z_STREAM_END)
+    const int result = deflate(strm, Z_FINISH);
+    if (result != Z_STREAM_END)
     {
-        result = deflate(&strm, Z_FINISH);
-
-        output.append(tmpBuf.data(), (BUFSIZE - strm.avail_out));
-        strm.next_out = reinterpret_cast<Bytef *>(tmpBuf.data());
-        strm.avail_out = BUFSIZE;
+        stream.release(true);
+        return {};
     }
 
-    deflateEnd(&strm);
+    output.truncate(output.size() - strm->avail_out);
+    stream.release(false);
 
     if (ok) *ok = true;
     return output;
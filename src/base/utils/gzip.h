@@ -33,6 +33,14 @@ class QByteArray;
 
 namespace Utils::Gzip
 {
+    enum class Format
+    {
+        Gzip,
+        Zlib  // HTTP "deflate" content coding
+    };
+
+    // Compression streams are kept per thread and reused between calls
     QByteArray compress(const QByteArray &data, int level = 6, bool *ok = nullptr);
+    QByteArray compress(const QByteArray &data, Format format, int level, bool *ok = nullptr);
     QByteArray decompress(const QByteArray &data, bool *ok = nullptr);
 }
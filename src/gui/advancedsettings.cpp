@@ -99,6 +99,8 @@ namespace
         // cache
         DISK_CACHE,
         DISK_CACHE_TTL,
+#else
+        READ_CACHE,
 #endif
         OS_CACHE,
 #if (LIBTORRENT_VERSION_NUM < 20000)
@@ -202,6 +204,9 @@ void AdvancedSettings::saveAdvancedSettings()
     // Disk write cache
     session->setDiskCacheSize(m_spinBoxCache.value());
     session->setDiskCacheTTL(m_spinBoxCacheTTL.value());
+#else
+    // Read cache
+    session->setReadCacheSize(m_spinBoxReadCache.value());
 #endif
     // Enable OS cache
     session->setUseOSCache(m_checkBoxOsCache.isChecked());
@@ -478,6 +483,18 @@ void AdvancedSettings::loadAdvancedSettings()
     m_spinBoxCacheTTL.setSuffix(tr(" s", " seconds"));
     addRow(DISK_CACHE_TTL, (tr("Disk cache expiry interval") + ' ' + makeLink("https://www.libtorrent.org/reference-Settings.html#cache_expiry", "(?)"))
             , &m_spinBoxCacheTTL);
+#else
+    // Read cache
+    m_spinBoxReadCache.setMinimum(0);
+#ifdef QBT_APP_64BIT
+    m_spinBoxReadCache.setMaximum(33554431);  // 32768GiB
+#else
+    m_spinBoxReadCache.setMaximum(1536);
+#endif
+    m_spinBoxReadCache.setValue(session->readCacheSize());
+    m_spinBoxReadCache.setSpecialValueText(tr("Disabled"));
+    m_spinBoxReadCache.setSuffix(tr(" MiB"));
+    addRow(READ_CACHE, tr("Disk read cache"), &m_spinBoxReadCache);
 #endif
     // Enable OS cache
     m_checkBoxOsCache.setChecked(session->useOSCache());
@@ -77,7 +77,7 @@ private:
     QSpinBox m_spinBoxCache, m_spinBoxCacheTTL;
     QCheckBox m_checkBoxCoalesceRW;
 #else
-    QSpinBox m_spinBoxHashingThreads;
+    QSpinBox m_spinBoxHashingThreads, m_spinBoxReadCache;
 #endif
 
     // OS dependent settings
@@ -228,14 +228,14 @@ void PeerListWidget::updatePeerHostNameResolutionState()
     {
         if (!m_resolver)
         {
-            m_resolver = new Net::ReverseResolution(this);
+            m_resolver = Net::ReverseResolution::instance();
             connect(m_resolver, &Net::ReverseResolution::ipResolved, this, &PeerListWidget::handleResolved);
             loadPeers(m_properties->getCurrentTorrent());
         }
     }
-    else
+    else if (m_resolver)
     {
-        delete m_resolver;
+        disconnect(m_resolver, nullptr, this, nullptr);
         m_resolver = nullptr;
     }
 }
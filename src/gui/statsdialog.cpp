@@ -55,9 +55,13 @@ StatsDialog::StatsDialog(QWidget *parent)
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::statsUpdated
             , this, &StatsDialog::update);
 
-#if (LIBTORRENT_VERSION_NUM >= 20000)
-    m_ui->labelCacheHitsText->hide();
-    m_ui->labelCacheHits->hide();
+#if (LIBTORRENT_VERSION_NUM < 20000)
+    m_ui->labelReadCacheSizeText->hide();
+    m_ui->labelReadCacheSize->hide();
+    m_ui->labelCacheEvictionsText->hide();
+    m_ui->labelCacheEvictions->hide();
+    m_ui->labelCacheBytesServedText->hide();
+    m_ui->labelCacheBytesServed->hide();
 #endif
 
     Utils::Gui::resize(this, m_storeDialogSize);
@@ -87,12 +91,16 @@ void StatsDialog::update()
                 ((atd > 0) && (atu > 0))
                 ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2)
                 : "-");
-#if (LIBTORRENT_VERSION_NUM < 20000)
     // Cache hits
     const qreal readRatio = cs.readRatio;
     m_ui->labelCacheHits->setText(QString::fromLatin1("%1%").arg((readRatio > 0)
         ? Utils::String::fromDouble(100 * readRatio, 2)
         : QLatin1String("0")));
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+    // Read cache
+    m_ui->labelReadCacheSize->setText(Utils::Misc::friendlyUnit(cs.readCacheUsedBytes));
+    m_ui->labelCacheEvictions->setText(QString::number(cs.readCacheEvictions));
+    m_ui->labelCacheBytesServed->setText(Utils::Misc::friendlyUnit(cs.readCacheBytesServed));
 #endif
     // Buffers size
     m_ui->labelTotalBuf->setText(Utils::Misc::friendlyUnit(cs.totalUsedBuffers * 16 * 1024));
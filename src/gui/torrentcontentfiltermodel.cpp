@@ -127,23 +127,6 @@ void TorrentContentFilterModel::selectNone()
 bool TorrentContentFilterModel::hasFiltered(const QModelIndex &folder) const
 {
     // this should be called only with folders
-    // check if the folder name itself matches the filter string
-    QString name = folder.data().toString();
-    if (name.contains(filterRegExp()))
-        return true;
-    for (int child = 0; child < m_model->rowCount(folder); ++child)
-    {
-        QModelIndex childIndex = m_model->index(child, 0, folder);
-        if (m_model->hasChildren(childIndex))
-        {
-            if (hasFiltered(childIndex))
-                return true;
-            continue;
-        }
-        name = childIndex.data().toString();
-        if (name.contains(filterRegExp()))
-            return true;
-    }
-
-    return false;
+    // the model also checks the rows it didn't expose yet
+    return m_model->hasMatchingItem(folder, filterRegExp());
 }
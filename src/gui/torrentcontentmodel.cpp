@@ -33,6 +33,8 @@
 #include <QFileIconProvider>
 #include <QFileInfo>
 #include <QIcon>
+#include <QRegExp>
+#include <QSet>
 
 #if defined(Q_OS_WIN)
 #include <Windows.h>
@@ -208,12 +210,12 @@ void TorrentContentModel::updateFilesProgress(const QVector<qreal> &fp)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fp.size()) return;
 
-    emit layoutAboutToBeChanged();
+    // Folders are updated from the changes of their files
     for (int i = 0; i < fp.size(); ++i)
-        m_filesIndex[i]->setProgress(fp[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
+    {
+        if (m_filesIndex[i]->progress() != fp[i])
+            m_filesIndex[i]->setProgress(fp[i]);
+    }
     emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
 }
 
@@ -236,11 +238,11 @@ void TorrentContentModel::updateFilesAvailability(const QVector<qreal> &fa)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fa.size()) return;
 
-    emit layoutAboutToBeChanged();
     for (int i = 0; i < m_filesIndex.size(); ++i)
-        m_filesIndex[i]->setAvailability(fa[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
+    {
+        if (m_filesIndex[i]->availability() != fa[i])
+            m_filesIndex[i]->setAvailability(fa[i]);
+    }
     emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
 }
 
@@ -287,9 +289,6 @@ bool TorrentContentModel::setData(const QModelIndex &index, const QVariant &valu
                 prio = BitTorrent::DownloadPriority::Ignored;
 
             item->setPriority(prio);
-            // Update folders progress in the tree
-            m_rootItem->recalculateProgress();
-            m_rootItem->recalculateAvailability();
             emit dataChanged(this->index(0, 0), this->index((rowCount() - 1), (columnCount() - 1)));
             emit filteredFilesChanged();
         }
@@ -429,7 +428,7 @@ QModelIndex TorrentContentModel::index(int row, int column, const QModelIndex &p
         parentItem = static_cast<TorrentContentModelFolder*>(parent.internalPointer());
     Q_ASSERT(parentItem);
 
-    if (row >= parentItem->childCount())
+    if (row >= parentItem->visibleChildCount())
         return {};
 
     TorrentContentModelItem *childItem = parentItem->child(row);
@@ -459,13 +458,69 @@ int TorrentContentModel::rowCount(const QModelIndex &parent) const
     if (parent.column() > 0)
         return 0;
 
-    TorrentContentModelFolder *parentItem;
-    if (!parent.isValid())
-        parentItem = m_rootItem;
-    else
-        parentItem = dynamic_cast<TorrentContentModelFolder*>(static_cast<TorrentContentModelItem*>(parent.internalPointer()));
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
+    return parentItem ? parentItem->visibleChildCount() : 0;
+}
+
+bool TorrentContentModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return false;
+
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
+    return parentItem && (parentItem->childCount() > 0);
+}
+
+bool TorrentContentModel::canFetchMore(const QModelIndex &parent) const
+{
+    const TorrentContentModelFolder *parentItem = folderItem(parent);
+    return parentItem && parentItem->hasHiddenChildren();
+}
+
+void TorrentContentModel::fetchMore(const QModelIndex &parent)
+{
+    TorrentContentModelFolder *parentItem = folderItem(parent);
+    if (!parentItem || !parentItem->hasHiddenChildren())
+        return;
 
-    return parentItem ? parentItem->childCount() : 0;
+    beginInsertRows(parent, parentItem->visibleChildCount(), (parentItem->nextVisibleChildCount() - 1));
+    parentItem->showMoreChildren();
+    endInsertRows();
+}
+
+// Hidden children are searched too, unlike when going through the indexes
+bool TorrentContentModel::hasMatchingItem(const QModelIndex &folderIndex, const QRegExp &pattern) const
+{
+    const TorrentContentModelFolder *folder = folderItem(folderIndex);
+    if (!folder)
+        return false;
+
+    if (folder->name().contains(pattern))
+        return true;
+
+    QVector<const TorrentContentModelFolder *> folders {folder};
+    while (!folders.isEmpty())
+    {
+        for (const TorrentContentModelItem *child : asConst(folders.takeLast()->children()))
+        {
+            if (child->name().contains(pattern))
+                return true;
+            if (child->itemType() == TorrentContentModelItem::FolderType)
+                folders.append(static_cast<const TorrentContentModelFolder *>(child));
+        }
+    }
+
+    return false;
+}
+
+TorrentContentModelFolder *TorrentContentModel::folderItem(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return m_rootItem;
+
+    auto *item = static_cast<TorrentContentModelItem *>(index.internalPointer());
+    return (item->itemType() == TorrentContentModelItem::FolderType)
+        ? static_cast<TorrentContentModelFolder *>(item) : nullptr;
 }
 
 void TorrentContentModel::clear()
@@ -489,27 +544,37 @@ void TorrentContentModel::setupModelData(const BitTorrent::TorrentInfo &info)
     qDebug("Torrent contains %d files", filesCount);
     m_filesIndex.reserve(filesCount);
 
-    TorrentContentModelFolder *currentParent;
+    // Folder names repeat a lot in large torrents, so share their data
+    QSet<QString> folderNames;
+    QString lastFolderPath;
+    TorrentContentModelFolder *lastParent = m_rootItem;
     // Iterate over files
     for (int i = 0; i < filesCount; ++i)
     {
-        currentParent = m_rootItem;
         const QString path = Utils::Fs::toUniformPath(info.filePath(i));
+        const int folderPathLength = qMax(0, path.lastIndexOf('/'));
 
-        // Iterate of parts of the path to create necessary folders
-        QVector<QStringRef> pathFolders = path.splitRef('/', QString::SkipEmptyParts);
-        pathFolders.removeLast();
-
-        for (const QStringRef &pathPartRef : asConst(pathFolders))
+        // Files are usually grouped by folder, so the previous parent can often be reused
+        TorrentContentModelFolder *currentParent = lastParent;
+        if (path.leftRef(folderPathLength) != lastFolderPath)
         {
-            const QString pathPart = pathPartRef.toString();
-            TorrentContentModelFolder *newParent = currentParent->childFolderWithName(pathPart);
-            if (!newParent)
+            currentParent = m_rootItem;
+            lastFolderPath = path.left(folderPathLength);
+
+            // Iterate of parts of the path to create necessary folders
+            const QVector<QStringRef> pathFolders = lastFolderPath.splitRef('/', QString::SkipEmptyParts);
+            for (const QStringRef &pathPartRef : pathFolders)
             {
-                newParent = new TorrentContentModelFolder(pathPart, currentParent);
-                currentParent->appendChild(newParent);
+                const QString pathPart = *folderNames.insert(pathPartRef.toString());
+                TorrentContentModelFolder *newParent = currentParent->childFolderWithName(pathPart);
+                if (!newParent)
+                {
+                    newParent = new TorrentContentModelFolder(pathPart, currentParent);
+                    currentParent->appendChild(newParent);
+                }
+                currentParent = newParent;
             }
-            currentParent = newParent;
+            lastParent = currentParent;
         }
         // Actually create the file
         TorrentContentModelFile *fileItem = new TorrentContentModelFile(info.fileName(i), info.fileSize(i), currentParent, i);
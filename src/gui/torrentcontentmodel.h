@@ -35,6 +35,7 @@
 
 class QFileIconProvider;
 class QModelIndex;
+class QRegExp;
 class QVariant;
 
 class TorrentContentModelFile;
@@ -73,6 +74,10 @@ public:
     QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
     QModelIndex parent(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    bool hasMatchingItem(const QModelIndex &folderIndex, const QRegExp &pattern) const;
     void clear();
     void setupModelData(const BitTorrent::TorrentInfo &info);
 
@@ -84,6 +89,8 @@ public slots:
     void selectNone();
 
 private:
+    TorrentContentModelFolder *folderItem(const QModelIndex &index) const;
+
     TorrentContentModelFolder *m_rootItem;
     QVector<TorrentContentModelFile *> m_filesIndex;
     QFileIconProvider *m_fileIconProvider;
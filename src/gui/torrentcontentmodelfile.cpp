@@ -59,7 +59,9 @@ void TorrentContentModelFile::setPriority(BitTorrent::DownloadPriority newPriori
     if (m_priority == newPriority)
         return;
 
+    const TorrentContentAggregate before = aggregate();
     m_priority = newPriority;
+    m_parentItem->updateAggregate(before, aggregate());
 
     // Update parent
     if (updateParent)
@@ -68,15 +70,38 @@ void TorrentContentModelFile::setPriority(BitTorrent::DownloadPriority newPriori
 
 void TorrentContentModelFile::setProgress(qreal progress)
 {
+    Q_ASSERT(progress <= 1.);
+
+    const TorrentContentAggregate before = aggregate();
     m_progress = progress;
     m_remaining = static_cast<qulonglong>(m_size * (1.0 - m_progress));
-    Q_ASSERT(m_progress <= 1.);
+    m_parentItem->updateAggregate(before, aggregate());
 }
 
 void TorrentContentModelFile::setAvailability(const qreal availability)
 {
+    Q_ASSERT(availability <= 1.);
+
+    const TorrentContentAggregate before = aggregate();
     m_availability = availability;
-    Q_ASSERT(m_availability <= 1.);
+    m_parentItem->updateAggregate(before, aggregate());
+}
+
+TorrentContentAggregate TorrentContentModelFile::aggregate() const
+{
+    TorrentContentAggregate aggregate;
+    if (m_priority == BitTorrent::DownloadPriority::Ignored)
+        return aggregate;
+
+    aggregate.wantedSize = m_size;
+    aggregate.progress = m_progress * m_size;
+    aggregate.remaining = m_remaining;
+    if (m_availability >= 0)
+    {
+        aggregate.availability = m_availability * m_size;
+        aggregate.availableFiles = 1;
+    }
+    return aggregate;
 }
 
 TorrentContentModelItem::ItemType TorrentContentModelFile::itemType() const
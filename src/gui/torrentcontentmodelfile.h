@@ -47,6 +47,8 @@ public:
     void setAvailability(qreal availability);
     ItemType itemType() const override;
 
+    TorrentContentAggregate aggregate() const;
+
 private:
     int m_fileIndex;
 };
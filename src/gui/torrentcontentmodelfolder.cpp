@@ -32,9 +32,16 @@
 
 #include "base/bittorrent/common.h"
 #include "base/global.h"
+#include "torrentcontentmodelfile.h"
+
+namespace
+{
+    const int CHILDREN_BATCH_SIZE = 1000;
+}
 
 TorrentContentModelFolder::TorrentContentModelFolder(const QString &name, TorrentContentModelFolder *parent)
     : TorrentContentModelItem(parent)
+    , m_visibleChildLimit(CHILDREN_BATCH_SIZE)
 {
     Q_ASSERT(parent);
     m_name = name;
@@ -45,6 +52,7 @@ TorrentContentModelFolder::TorrentContentModelFolder(const QString &name, Torren
 
 TorrentContentModelFolder::TorrentContentModelFolder(const QVector<QString> &data)
     : TorrentContentModelItem(nullptr)
+    , m_visibleChildLimit(CHILDREN_BATCH_SIZE)
 {
     Q_ASSERT(data.size() == NB_COL);
     m_itemData = data;
@@ -65,6 +73,9 @@ void TorrentContentModelFolder::deleteAllChildren()
     Q_ASSERT(isRootItem());
     qDeleteAll(m_childItems);
     m_childItems.clear();
+    m_childFolders.clear();
+    m_aggregate = {};
+    m_visibleChildLimit = CHILDREN_BATCH_SIZE;
 }
 
 const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children() const
@@ -75,10 +86,19 @@ const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children()
 void TorrentContentModelFolder::appendChild(TorrentContentModelItem *item)
 {
     Q_ASSERT(item);
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
-    // Update own size
-    if (item->itemType() == FileType)
+
+    if (item->itemType() == FolderType)
+    {
+        m_childFolders.insert(item->name(), static_cast<TorrentContentModelFolder *>(item));
+    }
+    else
+    {
+        // Update own size
         increaseSize(item->size());
+        updateAggregate({}, static_cast<TorrentContentModelFile *>(item)->aggregate());
+    }
 }
 
 TorrentContentModelItem *TorrentContentModelFolder::child(int row) const
@@ -88,12 +108,7 @@ TorrentContentModelItem *TorrentContentModelFolder::child(int row) const
 
 TorrentContentModelFolder *TorrentContentModelFolder::childFolderWithName(const QString &name) const
 {
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if ((child->itemType() == FolderType) && (child->name() == name))
-            return static_cast<TorrentContentModelFolder *>(child);
-    }
-    return nullptr;
+    return m_childFolders.value(name, nullptr);
 }
 
 int TorrentContentModelFolder::childCount() const
@@ -101,6 +116,26 @@ int TorrentContentModelFolder::childCount() const
     return m_childItems.count();
 }
 
+int TorrentContentModelFolder::visibleChildCount() const
+{
+    return qMin(m_childItems.count(), m_visibleChildLimit);
+}
+
+bool TorrentContentModelFolder::hasHiddenChildren() const
+{
+    return (m_childItems.count() > m_visibleChildLimit);
+}
+
+int TorrentContentModelFolder::nextVisibleChildCount() const
+{
+    return qMin(m_childItems.count(), (m_visibleChildLimit + CHILDREN_BATCH_SIZE));
+}
+
+void TorrentContentModelFolder::showMoreChildren()
+{
+    m_visibleChildLimit += CHILDREN_BATCH_SIZE;
+}
+
 // Only non-root folders use this function
 void TorrentContentModelFolder::updatePriority()
 {
@@ -143,61 +178,26 @@ void TorrentContentModelFolder::setPriority(BitTorrent::DownloadPriority newPrio
             child->setPriority(m_priority, false);
 }
 
-void TorrentContentModelFolder::recalculateProgress()
+void TorrentContentModelFolder::updateAggregate(const TorrentContentAggregate &before, const TorrentContentAggregate &after)
 {
-    qreal tProgress = 0;
-    qulonglong tSize = 0;
-    qulonglong tRemaining = 0;
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if (child->priority() == BitTorrent::DownloadPriority::Ignored)
-            continue;
-
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
-        tProgress += child->progress() * child->size();
-        tSize += child->size();
-        tRemaining += child->remaining();
-    }
+    m_aggregate.wantedSize += after.wantedSize - before.wantedSize;
+    m_aggregate.progress += after.progress - before.progress;
+    m_aggregate.remaining += after.remaining - before.remaining;
+    m_aggregate.availability += after.availability - before.availability;
+    m_aggregate.availableFiles += after.availableFiles - before.availableFiles;
 
-    if (!isRootItem() && (tSize > 0))
+    if (m_aggregate.wantedSize > 0)
     {
-        m_progress = tProgress / tSize;
-        m_remaining = tRemaining;
-        Q_ASSERT(m_progress <= 1.);
+        m_progress = qMin<qreal>((m_aggregate.progress / m_aggregate.wantedSize), 1);
+        m_remaining = m_aggregate.remaining;
     }
-}
 
-void TorrentContentModelFolder::recalculateAvailability()
-{
-    qreal tAvailability = 0;
-    qulonglong tSize = 0;
-    bool foundAnyData = false;
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if (child->priority() == BitTorrent::DownloadPriority::Ignored)
-            continue;
-
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder*>(child)->recalculateAvailability();
-        const qreal childAvailability = child->availability();
-        if (childAvailability >= 0)
-        { // -1 means "no data"
-            tAvailability += childAvailability * child->size();
-            foundAnyData = true;
-        }
-        tSize += child->size();
-    }
+    m_availability = ((m_aggregate.wantedSize > 0) && (m_aggregate.availableFiles > 0))
+        ? qMin<qreal>((m_aggregate.availability / m_aggregate.wantedSize), 1)
+        : -1.;
 
-    if (!isRootItem() && (tSize > 0) && foundAnyData)
-    {
-        m_availability = tAvailability / tSize;
-        Q_ASSERT(m_availability <= 1.);
-    }
-    else
-    {
-        m_availability = -1.;
-    }
+    if (!isRootItem())
+        m_parentItem->updateAggregate(before, after);
 }
 
 void TorrentContentModelFolder::increaseSize(qulonglong delta)
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <QHash>
+
 #include "torrentcontentmodelitem.h"
 
 namespace BitTorrent
@@ -49,8 +51,7 @@ public:
     ItemType itemType() const override;
 
     void increaseSize(qulonglong delta);
-    void recalculateProgress();
-    void recalculateAvailability();
+    void updateAggregate(const TorrentContentAggregate &before, const TorrentContentAggregate &after);
     void updatePriority();
 
     void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
@@ -62,6 +63,15 @@ public:
     TorrentContentModelFolder *childFolderWithName(const QString &name) const;
     int childCount() const;
 
+    // Children are exposed to the views in batches
+    int visibleChildCount() const;
+    bool hasHiddenChildren() const;
+    int nextVisibleChildCount() const;
+    void showMoreChildren();
+
 private:
     QVector<TorrentContentModelItem*> m_childItems;
+    QHash<QString, TorrentContentModelFolder *> m_childFolders;
+    TorrentContentAggregate m_aggregate;
+    int m_visibleChildLimit;
 };
@@ -37,9 +37,21 @@ class QVariant;
 
 class TorrentContentModelFolder;
 
+// Sums over the wanted (not ignored) files, maintained by the folders
+// from the changes of their files so that refreshes don't walk the whole tree
+struct TorrentContentAggregate
+{
+    qulonglong wantedSize = 0;
+    qreal progress = 0; // sum of progress * size
+    qulonglong remaining = 0;
+    qreal availability = 0; // sum of availability * size
+    int availableFiles = 0; // files with known availability
+};
+
 class TorrentContentModelItem
 {
     Q_DECLARE_TR_FUNCTIONS(TorrentContentModelItem)
+    friend class TorrentContentModelFolder;
 
 public:
     enum TreeItemColumns
@@ -94,4 +106,7 @@ protected:
     BitTorrent::DownloadPriority m_priority;
     qreal m_progress;
     qreal m_availability;
+
+private:
+    int m_row = 0;
 };
@@ -0,0 +1,163 @@
+#VERSION: 1.00
+
+# Author:
+#  The qBittorrent project
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#    * Redistributions of source code must retain the above copyright notice,
+#      this list of conditions and the following disclaimer.
+#    * Redistributions in binary form must reproduce the above copyright
+#      notice, this list of conditions and the following disclaimer in the
+#      documentation and/or other materials provided with the distribution.
+#    * Neither the name of the author nor the names of its contributors may be
+#      used to endorse or promote products derived from this software without
+#      specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+# Long-lived search worker.
+#
+# Engines are imported once, then search requests are read from stdin and
+# answered on stdout. Every frame is a single line holding one JSON object.
+#
+# Requests:
+#   {"op": "search", "id": <int>, "engines": [<name>, ...], "category": <str>, "query": <str>}
+#   {"op": "cancel", "id": <int>}
+#
+# Responses:
+#   {"id": <int>, "type": "result", "engine": <name>, "link": ..., "name": ..., "size": ...,
+#    "seeds": ..., "leech": ..., "engine_url": ..., "desc_link": ...}
+#   {"id": <int>, "type": "engine_finished", "engine": <name>, "elapsed_ms": <int>, "ok": <bool>}
+#   {"id": <int>, "type": "finished", "cancelled": <bool>}
+
+import io
+import json
+import sys
+import threading
+import time
+import urllib.parse
+from concurrent.futures import ThreadPoolExecutor, wait
+from multiprocessing import cpu_count
+
+import novaprinter
+
+_context = threading.local()
+_output_lock = threading.Lock()
+_cancelled_lock = threading.Lock()
+_cancelled = set()
+_stdout = io.TextIOWrapper(sys.stdout.buffer, encoding='utf-8', newline='\n')
+
+
+def send(message):
+    line = json.dumps(message, ensure_ascii=False)
+    with _output_lock:
+        _stdout.write(line + '\n')
+        _stdout.flush()
+
+
+def is_cancelled(request_id):
+    with _cancelled_lock:
+        return request_id in _cancelled
+
+
+def worker_printer(dictionary):
+    request_id = getattr(_context, 'request_id', None)
+    if (request_id is None) or is_cancelled(request_id):
+        return
+
+    message = {
+        'id': request_id,
+        'type': 'result',
+        'engine': _context.engine,
+        'link': dictionary['link'],
+        'name': dictionary['name'],
+        'size': novaprinter.anySizeToBytes(dictionary['size']),
+        'seeds': dictionary['seeds'],
+        'leech': dictionary['leech'],
+        'engine_url': dictionary['engine_url']
+    }
+    if 'desc_link' in dictionary:
+        message['desc_link'] = dictionary['desc_link']
+    send(message)
+
+
+# engines bind `prettyPrinter` when they are imported, so patch it first
+novaprinter.prettyPrinter = worker_printer
+
+import nova2  # noqa: E402
+
+SUPPORTED_ENGINES = nova2.initialize_engines()
+try:
+    MAX_THREADS = max(4, cpu_count() * 2)
+except NotImplementedError:
+    MAX_THREADS = 4
+EXECUTOR = ThreadPoolExecutor(max_workers=MAX_THREADS)
+
+
+def run_engine(request_id, engine_name, what, cat):
+    _context.request_id = request_id
+    _context.engine = engine_name
+    start = time.monotonic()
+    ok = nova2.run_search([getattr(nova2, engine_name), what, cat])
+    _context.request_id = None
+    send({'id': request_id, 'type': 'engine_finished', 'engine': engine_name,
+          'elapsed_ms': int((time.monotonic() - start) * 1000), 'ok': ok})
+
+
+def run_request(request):
+    request_id = request['id']
+    engines = [e.lower() for e in request.get('engines', [])]
+    if 'all' in engines:
+        engines = SUPPORTED_ENGINES
+    else:
+        engines = [e for e in set(engines) if e in SUPPORTED_ENGINES]
+
+    cat = request.get('category', 'all').lower()
+    if cat not in nova2.CATEGORIES:
+        cat = 'all'
+    what = urllib.parse.quote(request.get('query', ''))
+
+    futures = [EXECUTOR.submit(run_engine, request_id, engine, what, cat) for engine in engines]
+    wait(futures)
+
+    cancelled = is_cancelled(request_id)
+    with _cancelled_lock:
+        _cancelled.discard(request_id)
+    send({'id': request_id, 'type': 'finished', 'cancelled': cancelled})
+
+
+def main():
+    stdin = io.TextIOWrapper(sys.stdin.buffer, encoding='utf-8')
+    for line in stdin:
+        line = line.strip()
+        if not line:
+            continue
+
+        try:
+            request = json.loads(line)
+        except ValueError:
+            continue
+
+        op = request.get('op')
+        if op == 'search':
+            threading.Thread(target=run_request, args=(request,), daemon=True).start()
+        elif op == 'cancel':
+            # engines can't be interrupted, their remaining output is dropped instead
+            with _cancelled_lock:
+                _cancelled.add(request.get('id'))
+
+
+if __name__ == "__main__":
+    main()
@@ -35,6 +35,7 @@
 #include <QMetaObject>
 #include <QVector>
 
+#include "base/http/eventstream.h"
 #include "apierror.h"
 
 APIController::APIController(ISessionManager *sessionManager, QObject *parent)
@@ -43,11 +44,12 @@ APIController::APIController(ISessionManager *sessionManager, QObject *parent)
 {
 }
 
-QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data)
+QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data, const Http::HeaderMap &headers)
 {
     m_result.clear(); // clear result
     m_params = params;
     m_data = data;
+    m_headers = headers;
 
     const QByteArray methodName = action.toLatin1() + "Action";
     if (!QMetaObject::invokeMethod(this, methodName.constData()))
@@ -71,6 +73,11 @@ const DataMap &APIController::data() const
     return m_data;
 }
 
+const Http::HeaderMap &APIController::headers() const
+{
+    return m_headers;
+}
+
 void APIController::requireParams(const QVector<QString> &requiredParams) const
 {
     const bool hasAllRequiredParams = std::all_of(requiredParams.cbegin(), requiredParams.cend()
@@ -88,6 +95,11 @@ void APIController::setResult(const QString &result)
     m_result = result;
 }
 
+void APIController::setResult(const QByteArray &result)
+{
+    m_result = result;
+}
+
 void APIController::setResult(const QJsonArray &result)
 {
     m_result = QJsonDocument(result);
@@ -97,3 +109,13 @@ void APIController::setResult(const QJsonObject &result)
 {
     m_result = QJsonDocument(result);
 }
+
+void APIController::setResult(const QSharedPointer<Http::EventStream> &eventStream)
+{
+    m_result = QVariant::fromValue(eventStream);
+}
+
+void APIController::setResult(const Http::Response &response)
+{
+    m_result = QVariant::fromValue(response);
+}
@@ -29,11 +29,19 @@
 #pragma once
 
 #include <QObject>
+#include <QSharedPointer>
 #include <QVariant>
 #include <QtContainerFwd>
 
+#include "base/http/types.h"
+
 class QString;
 
+namespace Http
+{
+    class EventStream;
+}
+
 struct ISessionManager;
 
 using DataMap = QHash<QString, QByteArray>;
@@ -52,22 +60,28 @@ class APIController : public QObject
 public:
     explicit APIController(ISessionManager *sessionManager, QObject *parent = nullptr);
 
-    QVariant run(const QString &action, const StringMap &params, const DataMap &data = {});
+    QVariant run(const QString &action, const StringMap &params, const DataMap &data = {}, const Http::HeaderMap &headers = {});
 
     ISessionManager *sessionManager() const;
 
 protected:
     const StringMap &params() const;
     const DataMap &data() const;
+    const Http::HeaderMap &headers() const;
     void requireParams(const QVector<QString> &requiredParams) const;
 
     void setResult(const QString &result);
+    void setResult(const QByteArray &result);
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
+    void setResult(const QSharedPointer<Http::EventStream> &eventStream);
+    // for the actions that need full control over the HTTP response
+    void setResult(const Http::Response &response);
 
 private:
     ISessionManager *m_sessionManager;
     StringMap m_params;
     DataMap m_data;
+    Http::HeaderMap m_headers;
     QVariant m_result;
 };
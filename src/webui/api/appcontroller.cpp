@@ -45,6 +45,7 @@
 
 #include "base/bittorrent/session.h"
 #include "base/global.h"
+#include "base/http/responsegenerator.h"
 #include "base/net/portforwarder.h"
 #include "base/net/proxyconfigurationmanager.h"
 #include "base/preferences.h"
@@ -278,6 +279,11 @@ void AppController::preferencesAction()
     data["current_interface_address"] = BitTorrent::Session::instance()->networkInterfaceAddress();
     // Save resume data interval
     data["save_resume_data_interval"] = session->saveResumeDataInterval();
+    // Dormant torrent timeout
+    data["dormant_torrent_timeout"] = session->dormantTorrentTimeout();
+    // Quick recheck
+    data["quick_recheck_enabled"] = session->isQuickRecheckEnabled();
+    data["quick_recheck_spot_check_pieces"] = session->quickRecheckSpotCheckCount();
     // Recheck completed torrents
     data["recheck_completed_torrents"] = pref->recheckTorrentsOnCompletion();
     // Resolve peer countries
@@ -295,6 +301,8 @@ void AppController::preferencesAction()
     // Disk write cache
     data["disk_cache"] = session->diskCacheSize();
     data["disk_cache_ttl"] = session->diskCacheTTL();
+    // Disk read cache
+    data["read_cache_size"] = session->readCacheSize();
     // Enable OS cache
     data["enable_os_cache"] = session->useOSCache();
     // Coalesce reads & writes
@@ -730,6 +738,14 @@ void AppController::setPreferencesAction()
     // Save resume data interval
     if (hasKey("save_resume_data_interval"))
         session->setSaveResumeDataInterval(it.value().toInt());
+    // Dormant torrent timeout
+    if (hasKey("dormant_torrent_timeout"))
+        session->setDormantTorrentTimeout(it.value().toInt());
+    // Quick recheck
+    if (hasKey("quick_recheck_enabled"))
+        session->setQuickRecheckEnabled(it.value().toBool());
+    if (hasKey("quick_recheck_spot_check_pieces"))
+        session->setQuickRecheckSpotCheckCount(it.value().toInt());
     // Recheck completed torrents
     if (hasKey("recheck_completed_torrents"))
         pref->recheckTorrentsOnCompletion(it.value().toBool());
@@ -755,6 +771,9 @@ void AppController::setPreferencesAction()
         session->setDiskCacheSize(it.value().toInt());
     if (hasKey("disk_cache_ttl"))
         session->setDiskCacheTTL(it.value().toInt());
+    // Disk read cache
+    if (hasKey("read_cache_size"))
+        session->setReadCacheSize(it.value().toInt());
     // Enable OS cache
     if (hasKey("enable_os_cache"))
         session->setUseOSCache(it.value().toBool());
@@ -889,3 +908,15 @@ void AppController::networkInterfaceAddressListAction()
 
     setResult(addressList);
 }
+
+void AppController::compressionStatsAction()
+{
+    const Http::CompressionStatistics stats = Http::compressionStatistics();
+    setResult(QJsonObject {
+        {"compressed_responses", static_cast<qint64>(stats.compressedResponses)},
+        {"bytes_in", static_cast<qint64>(stats.bytesIn)},
+        {"bytes_out", static_cast<qint64>(stats.bytesOut)},
+        {"bytes_saved", (static_cast<qint64>(stats.bytesIn) - static_cast<qint64>(stats.bytesOut))},
+        {"cpu_time_ms", static_cast<qint64>(stats.cpuTimeNs / 1000000)}
+    });
+}
@@ -44,6 +44,16 @@ const char KEY_LOG_PEER_IP[] = "ip";
 const char KEY_LOG_PEER_BLOCKED[] = "blocked";
 const char KEY_LOG_PEER_REASON[] = "reason";
 
+namespace
+{
+    int parseInt(const QString &value, const int defaultValue)
+    {
+        bool ok = false;
+        const int result = value.toInt(&ok);
+        return ok ? result : defaultValue;
+    }
+}
+
 // Returns the log in JSON format.
 // The return value is an array of dictionaries.
 // The dictionary keys are:
@@ -57,6 +67,9 @@ const char KEY_LOG_PEER_REASON[] = "reason";
 //   - warning (bool): include warning messages (default true)
 //   - critical (bool): include critical messages (default true)
 //   - last_known_id (int): exclude messages with id <= 'last_known_id' (default -1)
+//   - filter (string): include only the messages containing this text, case insensitive (default "")
+//   - limit (int): return at most 'limit' messages, the oldest first; the id of the last one
+//     is the 'last_known_id' of the next page (default -1, no limit)
 void LogController::mainAction()
 {
     using Utils::String::parseBool;
@@ -66,22 +79,21 @@ void LogController::mainAction()
     const bool isWarning = parseBool(params()["warning"]).value_or(true);
     const bool isCritical = parseBool(params()["critical"]).value_or(true);
 
-    bool ok = false;
-    int lastKnownId = params()["last_known_id"].toInt(&ok);
-    if (!ok)
-        lastKnownId = -1;
+    Log::MsgTypes types;
+    types.setFlag(Log::NORMAL, isNormal);
+    types.setFlag(Log::INFO, isInfo);
+    types.setFlag(Log::WARNING, isWarning);
+    types.setFlag(Log::CRITICAL, isCritical);
+
+    const int lastKnownId = parseInt(params()["last_known_id"], -1);
+    const int limit = parseInt(params()["limit"], -1);
+    const QString filter = params()["filter"];
 
     Logger *const logger = Logger::instance();
     QJsonArray msgList;
 
-    for (const Log::Msg &msg : asConst(logger->getMessages(lastKnownId)))
+    for (const Log::Msg &msg : asConst(logger->getMessages(lastKnownId, types, filter, limit)))
     {
-        if (!(((msg.type == Log::NORMAL) && isNormal)
-              || ((msg.type == Log::INFO) && isInfo)
-              || ((msg.type == Log::WARNING) && isWarning)
-              || ((msg.type == Log::CRITICAL) && isCritical)))
-            continue;
-
         msgList.append(QJsonObject
         {
             {QLatin1String(KEY_LOG_ID), msg.id},
@@ -104,17 +116,18 @@ void LogController::mainAction()
 //   - "reason": reason of the block
 // GET params:
 //   - last_known_id (int): exclude messages with id <= 'last_known_id' (default -1)
+//   - filter (string): include only the peers whose IP or reason contains this text, case insensitive (default "")
+//   - limit (int): return at most 'limit' messages, the oldest first (default -1, no limit)
 void LogController::peersAction()
 {
-    bool ok = false;
-    int lastKnownId = params()["last_known_id"].toInt(&ok);
-    if (!ok)
-        lastKnownId = -1;
+    const int lastKnownId = parseInt(params()["last_known_id"], -1);
+    const int limit = parseInt(params()["limit"], -1);
+    const QString filter = params()["filter"];
 
     Logger *const logger = Logger::instance();
     QJsonArray peerList;
 
-    for (const Log::Peer &peer : asConst(logger->getPeers(lastKnownId)))
+    for (const Log::Peer &peer : asConst(logger->getPeers(lastKnownId, filter, limit)))
     {
         peerList.append(QJsonObject
         {
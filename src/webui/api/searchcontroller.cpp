@@ -384,6 +384,7 @@ QJsonArray SearchController::getPluginsInfo(const QStringList &plugins) const
     for (const QString &plugin : plugins)
     {
         const PluginInfo *const pluginInfo = SearchPluginManager::instance()->pluginInfo(plugin);
+        const PluginStatistics stats = SearchPluginManager::instance()->pluginStatistics(plugin);
 
         pluginsArray << QJsonObject
         {
@@ -392,7 +393,11 @@ QJsonArray SearchController::getPluginsInfo(const QStringList &plugins) const
             {"fullName", pluginInfo->fullName},
             {"url", pluginInfo->url},
             {"supportedCategories", getPluginCategories(pluginInfo->supportedCategories)},
-            {"enabled", pluginInfo->enabled}
+            {"enabled", pluginInfo->enabled},
+            {"searchCount", stats.searchCount},
+            {"failureCount", stats.failureCount},
+            {"averageLatency", ((stats.searchCount > 0) ? (stats.totalTime / stats.searchCount) : 0)},
+            {"lastLatency", stats.lastTime}
         };
     }
 
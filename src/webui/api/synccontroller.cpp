@@ -30,17 +30,22 @@
 
 #include <algorithm>
 
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QMetaObject>
+#include <QSet>
 #include <QThread>
+#include <QTimer>
 
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
-#include "base/bittorrent/trackerentry.h"
+#include "base/algorithm.h"
 #include "base/global.h"
+#include "base/http/eventstream.h"
+#include "base/logger.h"
 #include "base/net/geoipmanager.h"
 #include "base/preferences.h"
 #include "base/utils/string.h"
@@ -96,8 +101,11 @@ namespace
     const char KEY_TRANSFER_AVERAGE_TIME_QUEUE[] = "average_time_queue";
     const char KEY_TRANSFER_GLOBAL_RATIO[] = "global_ratio";
     const char KEY_TRANSFER_QUEUED_IO_JOBS[] = "queued_io_jobs";
+    const char KEY_TRANSFER_READ_CACHE_BYTES_SERVED[] = "read_cache_bytes_served";
+    const char KEY_TRANSFER_READ_CACHE_EVICTIONS[] = "read_cache_evictions";
     const char KEY_TRANSFER_READ_CACHE_HITS[] = "read_cache_hits";
     const char KEY_TRANSFER_READ_CACHE_OVERLOAD[] = "read_cache_overload";
+    const char KEY_TRANSFER_READ_CACHE_SIZE[] = "read_cache_size";
     const char KEY_TRANSFER_TOTAL_BUFFERS_SIZE[] = "total_buffers_size";
     const char KEY_TRANSFER_TOTAL_PEER_CONNECTIONS[] = "total_peer_connections";
     const char KEY_TRANSFER_TOTAL_QUEUED_SIZE[] = "total_queued_size";
@@ -108,11 +116,97 @@ namespace
     const char KEY_RESPONSE_ID[] = "rid";
     const char KEY_SUFFIX_REMOVED[] = "_removed";
 
+    // Log Msg keys
+    const char KEY_LOG_ID[] = "id";
+    const char KEY_LOG_TIMESTAMP[] = "timestamp";
+    const char KEY_LOG_MSG_TYPE[] = "type";
+    const char KEY_LOG_MSG_MESSAGE[] = "message";
+
+    const int EVENTS_INTERVAL = 500;  // milliseconds
+    const int MAX_PENDING_LOG_MESSAGES = 100;
+
     void processMap(const QVariantMap &prevData, const QVariantMap &data, QVariantMap &syncData);
     void processHash(QVariantHash prevData, const QVariantHash &data, QVariantMap &syncData, QVariantList &removedItems);
     void processList(QVariantList prevData, const QVariantList &data, QVariantList &syncData, QVariantList &removedItems);
     QVariantMap generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData);
 
+    void removeItem(QVariantMap &changes, const QString &key, const QVariant &item)
+    {
+        const auto iter = changes.find(key);
+        if (iter == changes.end())
+            return;
+
+        if (iter->userType() == QMetaType::QVariantList)
+        {
+            QVariantList items = iter->toList();
+            items.removeAll(item);
+            *iter = items;
+        }
+        else
+        {
+            QVariantMap items = iter->toMap();
+            items.remove(item.toString());
+            *iter = items;
+        }
+    }
+
+    // Merges the changes into the ones not sent to a client yet, the latest value of a field wins.
+    // Changes are structured as sync/maindata responses.
+    void mergeChanges(QVariantMap &pendingChanges, const QVariantMap &changes)
+    {
+        const int suffixLength = static_cast<int>(qstrlen(KEY_SUFFIX_REMOVED));
+
+        for (auto i = changes.cbegin(); i != changes.cend(); ++i)
+        {
+            const QString &key = i.key();
+            if (key.endsWith(QLatin1String(KEY_SUFFIX_REMOVED)))
+            {
+                const QString itemsKey = key.left(key.size() - suffixLength);
+                QVariantList removedItems = pendingChanges.value(key).toList();
+                for (const QVariant &item : asConst(i.value().toList()))
+                {
+                    removeItem(pendingChanges, itemsKey, item);
+                    if (!removedItems.contains(item))
+                        removedItems.append(item);
+                }
+                pendingChanges[key] = removedItems;
+            }
+            else if (i.value().userType() == QMetaType::QVariantList)
+            {
+                QVariantList items = pendingChanges.value(key).toList();
+                for (const QVariant &item : asConst(i.value().toList()))
+                {
+                    removeItem(pendingChanges, (key + KEY_SUFFIX_REMOVED), item);
+                    if (!items.contains(item))
+                        items.append(item);
+                }
+                pendingChanges[key] = items;
+            }
+            else
+            {
+                QVariantMap items = pendingChanges.value(key).toMap();
+                const QVariantMap changedItems = i.value().toMap();
+                for (auto j = changedItems.cbegin(); j != changedItems.cend(); ++j)
+                {
+                    removeItem(pendingChanges, (key + KEY_SUFFIX_REMOVED), j.key());
+                    if (j.value().userType() == QMetaType::QVariantMap)
+                    {
+                        QVariantMap fields = items.value(j.key()).toMap();
+                        const QVariantMap changedFields = j.value().toMap();
+                        for (auto k = changedFields.cbegin(); k != changedFields.cend(); ++k)
+                            fields[k.key()] = k.value();
+                        items[j.key()] = fields;
+                    }
+                    else
+                    {
+                        items[j.key()] = j.value();
+                    }
+                }
+                pendingChanges[key] = items;
+            }
+        }
+    }
+
     QVariantMap getTransferInfo()
     {
         QVariantMap map;
@@ -135,8 +229,11 @@ namespace
         map[KEY_TRANSFER_GLOBAL_RATIO] = ((atd > 0) && (atu > 0)) ? Utils::String::fromDouble(static_cast<qreal>(atu) / atd, 2) : "-";
         map[KEY_TRANSFER_TOTAL_PEER_CONNECTIONS] = sessionStatus.peersCount;
 
-        const qreal readRatio = cacheStatus.readRatio;  // TODO: remove when LIBTORRENT_VERSION_NUM >= 20000
+        const qreal readRatio = cacheStatus.readRatio;
         map[KEY_TRANSFER_READ_CACHE_HITS] = (readRatio > 0) ? Utils::String::fromDouble(100 * readRatio, 2) : "0";
+        map[KEY_TRANSFER_READ_CACHE_EVICTIONS] = cacheStatus.readCacheEvictions;
+        map[KEY_TRANSFER_READ_CACHE_BYTES_SERVED] = cacheStatus.readCacheBytesServed;
+        map[KEY_TRANSFER_READ_CACHE_SIZE] = cacheStatus.readCacheUsedBytes;
         map[KEY_TRANSFER_TOTAL_BUFFERS_SIZE] = cacheStatus.totalUsedBuffers * 16 * 1024;
 
         map[KEY_TRANSFER_WRITE_CACHE_OVERLOAD] = ((sessionStatus.diskWriteQueue > 0) && (sessionStatus.peersCount > 0))
@@ -367,7 +464,37 @@ namespace
 
 SyncController::SyncController(ISessionManager *sessionManager, QObject *parent)
     : APIController(sessionManager, parent)
+    , m_eventsTimer {new QTimer(this)}
 {
+    const auto *session = BitTorrent::Session::instance();
+    connect(session, &BitTorrent::Session::torrentAdded, this, &SyncController::handleTorrentAdded);
+    connect(session, &BitTorrent::Session::torrentAboutToBeRemoved, this, &SyncController::handleTorrentAboutToBeRemoved);
+    connect(session, &BitTorrent::Session::torrentsUpdated, this, &SyncController::handleTorrentsUpdated);
+    connect(session, &BitTorrent::Session::statsUpdated, this, &SyncController::handleStatsUpdated);
+    connect(session, &BitTorrent::Session::categoryAdded, this, [this](const QString &categoryName)
+    {
+        publishChanges({{"categories", QVariantMap {{categoryName, QVariantMap {
+            {"name", categoryName},
+            {"savePath", BitTorrent::Session::instance()->categorySavePath(categoryName)}
+        }}}}});
+    });
+    connect(session, &BitTorrent::Session::categoryRemoved, this, [this](const QString &categoryName)
+    {
+        publishChanges({{"categories_removed", QVariantList {categoryName}}});
+    });
+    connect(session, &BitTorrent::Session::tagAdded, this, [this](const QString &tag)
+    {
+        publishChanges({{"tags", QVariantList {tag}}});
+    });
+    connect(session, &BitTorrent::Session::tagRemoved, this, [this](const QString &tag)
+    {
+        publishChanges({{"tags_removed", QVariantList {tag}}});
+    });
+    connect(Logger::instance(), &Logger::newLogMessage, this, &SyncController::handleNewLogMessage);
+
+    m_eventsTimer->setInterval(EVENTS_INTERVAL);
+    connect(m_eventsTimer, &QTimer::timeout, this, &SyncController::sendPendingEvents);
+
     m_freeDiskSpaceThread = new QThread(this);
     m_freeDiskSpaceChecker = new FreeDiskSpaceChecker();
     m_freeDiskSpaceChecker->moveToThread(m_freeDiskSpaceThread);
@@ -382,6 +509,14 @@ SyncController::SyncController(ISessionManager *sessionManager, QObject *parent)
 
 SyncController::~SyncController()
 {
+    // the connections would otherwise keep streams nobody feeds open
+    for (const EventSubscriber &subscriber : asConst(m_eventSubscribers))
+    {
+        const QSharedPointer<Http::EventStream> stream = subscriber.stream.toStrongRef();
+        if (stream)
+            stream->close();
+    }
+
     m_freeDiskSpaceThread->quit();
     m_freeDiskSpaceThread->wait();
 }
@@ -458,7 +593,6 @@ void SyncController::maindataAction()
     QVariantMap lastAcceptedResponse = sessionManager()->session()->getData(QLatin1String("syncMainDataLastAcceptedResponse")).toMap();
 
     QVariantHash torrents;
-    QHash<QString, QStringList> trackers;
     for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
     {
         const BitTorrent::InfoHash torrentHash = torrent->hash();
@@ -488,9 +622,6 @@ void SyncController::maindataAction()
             }
         }
 
-        for (const BitTorrent::TrackerEntry &tracker : asConst(torrent->trackers()))
-            trackers[tracker.url()] << torrentHash;
-
         torrents[torrentHash] = map;
     }
     data["torrents"] = torrents;
@@ -514,18 +645,18 @@ void SyncController::maindataAction()
     data["tags"] = tags;
 
     QVariantHash trackersHash;
-    for (auto i = trackers.constBegin(); i != trackers.constEnd(); ++i)
+    const QHash<QString, QSet<BitTorrent::InfoHash>> trackerIndex = session->trackerIndex();
+    for (auto i = trackerIndex.constBegin(); i != trackerIndex.constEnd(); ++i)
     {
-        trackersHash[i.key()] = i.value();
+        QStringList torrentHashes;
+        torrentHashes.reserve(i.value().size());
+        for (const BitTorrent::InfoHash &hash : i.value())
+            torrentHashes << hash;
+        trackersHash[i.key()] = torrentHashes;
     }
     data["trackers"] = trackersHash;
 
-    QVariantMap serverState = getTransferInfo();
-    serverState[KEY_TRANSFER_FREESPACEONDISK] = getFreeDiskSpace();
-    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
-    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
-    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
-    data["server_state"] = serverState;
+    data["server_state"] = getServerState();
 
     const int acceptedResponseId {params()["rid"].toInt()};
     setResult(QJsonObject::fromVariantMap(generateSyncData(acceptedResponseId, data, lastAcceptedResponse, lastResponse)));
@@ -595,6 +726,210 @@ void SyncController::torrentPeersAction()
     sessionManager()->session()->setData(QLatin1String("syncTorrentPeersLastAcceptedResponse"), lastAcceptedResponse);
 }
 
+// Opens a stream of Server-Sent Events that carry the changes as they happen,
+// so that clients don't need to poll sync/maindata.
+// Events:
+//  - "maindata": changes structured as a sync/maindata response without "rid" and "full_update".
+//    Changes of trackers are not streamed.
+//  - "log": a new log message, with the same keys as in log/main
+// A client should request sync/maindata once the stream is open to get the initial state.
+// Changes are coalesced while a client doesn't keep up with them.
+void SyncController::eventsAction()
+{
+    const QSharedPointer<Http::EventStream> stream {new Http::EventStream, &QObject::deleteLater};
+    m_eventSubscribers.append({stream, sessionManager()->session()->id(), QSharedPointer<PendingEvents>::create()});
+    m_eventsTimer->start();
+
+    setResult(stream);
+}
+
+void SyncController::closeEventStreams(const QString &sessionId)
+{
+    Algorithm::removeIf(m_eventSubscribers, [&sessionId](const EventSubscriber &subscriber)
+    {
+        if (subscriber.sessionId != sessionId)
+            return false;
+
+        const QSharedPointer<Http::EventStream> stream = subscriber.stream.toStrongRef();
+        if (stream)
+            stream->close();
+        return true;
+    });
+}
+
+QVariantMap SyncController::getServerState()
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    QVariantMap serverState = getTransferInfo();
+    serverState[KEY_TRANSFER_FREESPACEONDISK] = getFreeDiskSpace();
+    serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
+    serverState[KEY_SYNC_MAINDATA_USE_ALT_SPEED_LIMITS] = session->isAltGlobalSpeedLimitEnabled();
+    serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
+    return serverState;
+}
+
+void SyncController::publishChanges(const QVariantMap &changes)
+{
+    QSet<PendingEvents *> mergedEvents;
+    for (const EventSubscriber &subscriber : asConst(m_eventSubscribers))
+    {
+        PendingEvents *pendingEvents = subscriber.pendingEvents.data();
+        if (mergedEvents.contains(pendingEvents))
+            continue;
+
+        mergeChanges(pendingEvents->changes, changes);
+        mergedEvents.insert(pendingEvents);
+    }
+}
+
+void SyncController::handleTorrentAdded(const BitTorrent::Torrent *torrent)
+{
+    if (m_eventSubscribers.isEmpty())
+        return;
+
+    const QString hash = torrent->hash();
+    QVariantMap map = serialize(*torrent);
+    map.remove(KEY_TORRENT_HASH);
+    m_publishedTorrents[hash] = map;
+
+    publishChanges({{"torrents", QVariantMap {{hash, map}}}});
+}
+
+void SyncController::handleTorrentAboutToBeRemoved(const BitTorrent::Torrent *torrent)
+{
+    if (m_eventSubscribers.isEmpty())
+        return;
+
+    const QString hash = torrent->hash();
+    m_publishedTorrents.remove(hash);
+
+    publishChanges({{"torrents_removed", QVariantList {hash}}});
+}
+
+void SyncController::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+{
+    if (m_eventSubscribers.isEmpty())
+        return;
+
+    // Only the changed fields are computed, once for all the clients.
+    // They are merged and serialized once per group of clients that are in sync.
+    QVariantMap changedTorrents;
+    for (const BitTorrent::Torrent *torrent : torrents)
+    {
+        const QString hash = torrent->hash();
+
+        QVariantMap map = serialize(*torrent);
+        map.remove(KEY_TORRENT_HASH);
+
+        QVariantMap &publishedMap = m_publishedTorrents[hash];
+        // See maindataAction() about the tolerance on last activity time
+        const auto iterLastActivity = publishedMap.constFind(KEY_TORRENT_LAST_ACTIVITY_TIME);
+        if ((iterLastActivity != publishedMap.cend())
+            && (qAbs(iterLastActivity->toInt() - map[KEY_TORRENT_LAST_ACTIVITY_TIME].toInt()) < 15))
+        {
+            map[KEY_TORRENT_LAST_ACTIVITY_TIME] = *iterLastActivity;
+        }
+
+        QVariantMap changedFields;
+        processMap(publishedMap, map, changedFields);
+        if (changedFields.isEmpty())
+            continue;
+
+        publishedMap = map;
+        changedTorrents[hash] = changedFields;
+    }
+
+    if (!changedTorrents.isEmpty())
+        publishChanges({{"torrents", changedTorrents}});
+}
+
+void SyncController::handleStatsUpdated()
+{
+    if (m_eventSubscribers.isEmpty())
+        return;
+
+    const QVariantMap serverState = getServerState();
+    QVariantMap changedFields;
+    processMap(m_publishedServerState, serverState, changedFields);
+    if (changedFields.isEmpty())
+        return;
+
+    m_publishedServerState = serverState;
+    publishChanges({{"server_state", changedFields}});
+}
+
+void SyncController::handleNewLogMessage(const Log::Msg &message)
+{
+    if (m_eventSubscribers.isEmpty())
+        return;
+
+    const QJsonObject object
+    {
+        {QLatin1String(KEY_LOG_ID), message.id},
+        {QLatin1String(KEY_LOG_TIMESTAMP), message.timestamp},
+        {QLatin1String(KEY_LOG_MSG_TYPE), message.type},
+        {QLatin1String(KEY_LOG_MSG_MESSAGE), message.message}
+    };
+    const QByteArray data = QJsonDocument(object).toJson(QJsonDocument::Compact);
+
+    QSet<PendingEvents *> appendedEvents;
+    for (const EventSubscriber &subscriber : asConst(m_eventSubscribers))
+    {
+        PendingEvents *pendingEvents = subscriber.pendingEvents.data();
+        if (appendedEvents.contains(pendingEvents))
+            continue;
+
+        pendingEvents->logMessages.append(data);
+        if (pendingEvents->logMessages.size() > MAX_PENDING_LOG_MESSAGES)
+            pendingEvents->logMessages.removeFirst();
+        appendedEvents.insert(pendingEvents);
+    }
+}
+
+void SyncController::sendPendingEvents()
+{
+    // the clients sent their events now are in sync from here on
+    const auto sentEvents = QSharedPointer<PendingEvents>::create();
+    QHash<const PendingEvents *, QByteArray> serializedChanges;
+
+    Algorithm::removeIf(m_eventSubscribers, [&sentEvents, &serializedChanges](EventSubscriber &subscriber)
+    {
+        const QSharedPointer<Http::EventStream> stream = subscriber.stream.toStrongRef();
+        if (!stream || stream->isClosed())
+            return true;
+
+        // keep coalescing until the client has consumed what it was sent before
+        if (!stream->isReady())
+            return false;
+
+        const PendingEvents *pendingEvents = subscriber.pendingEvents.data();
+        if (!pendingEvents->changes.isEmpty())
+        {
+            auto iter = serializedChanges.find(pendingEvents);
+            if (iter == serializedChanges.end())
+            {
+                iter = serializedChanges.insert(pendingEvents
+                    , QJsonDocument(QJsonObject::fromVariantMap(pendingEvents->changes)).toJson(QJsonDocument::Compact));
+            }
+            stream->sendEvent(QLatin1String("maindata"), iter.value());
+        }
+
+        for (const QByteArray &message : pendingEvents->logMessages)
+            stream->sendEvent(QLatin1String("log"), message);
+
+        subscriber.pendingEvents = sentEvents;
+        return false;
+    });
+
+    if (m_eventSubscribers.isEmpty())
+    {
+        m_eventsTimer->stop();
+        m_publishedTorrents.clear();
+        m_publishedServerState.clear();
+    }
+}
+
 qint64 SyncController::getFreeDiskSpace()
 {
     if (m_freeDiskSpaceElapsedTimer.hasExpired(FREEDISKSPACE_CHECK_TIMEOUT))
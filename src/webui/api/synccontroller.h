@@ -29,12 +29,34 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QVariant>
+#include <QVector>
+#include <QWeakPointer>
 
 #include "apicontroller.h"
 
 struct ISessionManager;
 
 class QThread;
+class QTimer;
+
+namespace BitTorrent
+{
+    class Torrent;
+}
+
+namespace Http
+{
+    class EventStream;
+}
+
+namespace Log
+{
+    struct Msg;
+}
 
 class FreeDiskSpaceChecker;
 
@@ -49,17 +71,51 @@ public:
     explicit SyncController(ISessionManager *sessionManager, QObject *parent = nullptr);
     ~SyncController() override;
 
+public slots:
+    // Closes the event streams opened from the given WebUI session
+    void closeEventStreams(const QString &sessionId);
+
 private slots:
     void maindataAction();
     void torrentPeersAction();
+    void eventsAction();
     void freeDiskSpaceSizeUpdated(qint64 freeSpaceSize);
 
 private:
+    // Events coalesced since the last send. The clients that were sent their events
+    // at the same time share one instance, so their events are merged and serialized once.
+    struct PendingEvents
+    {
+        QVariantMap changes;
+        QList<QByteArray> logMessages;
+    };
+
+    struct EventSubscriber
+    {
+        QWeakPointer<Http::EventStream> stream;
+        QString sessionId;
+        QSharedPointer<PendingEvents> pendingEvents;
+    };
+
     qint64 getFreeDiskSpace();
     void invokeChecker() const;
+    QVariantMap getServerState();
+
+    void publishChanges(const QVariantMap &changes);
+    void handleTorrentAdded(const BitTorrent::Torrent *torrent);
+    void handleTorrentAboutToBeRemoved(const BitTorrent::Torrent *torrent);
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents);
+    void handleStatsUpdated();
+    void handleNewLogMessage(const Log::Msg &message);
+    void sendPendingEvents();
 
     qint64 m_freeDiskSpace = 0;
     FreeDiskSpaceChecker *m_freeDiskSpaceChecker = nullptr;
     QThread *m_freeDiskSpaceThread = nullptr;
     QElapsedTimer m_freeDiskSpaceElapsedTimer;
+
+    QVector<EventSubscriber> m_eventSubscribers;
+    QHash<QString, QVariantMap> m_publishedTorrents;
+    QVariantMap m_publishedServerState;
+    QTimer *m_eventsTimer = nullptr;
 };
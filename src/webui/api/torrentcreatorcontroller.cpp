@@ -0,0 +1,217 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#include "torrentcreatorcontroller.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "base/global.h"
+#include "base/utils/string.h"
+#include "apierror.h"
+
+TorrentCreatorController::TorrentCreatorController(ISessionManager *sessionManager, QObject *parent)
+    : APIController {sessionManager, parent}
+    , m_creatorThread {new BitTorrent::TorrentCreatorThread(this)}
+{
+    connect(m_creatorThread, &BitTorrent::TorrentCreatorThread::creationSuccess, this, &TorrentCreatorController::handleCreationSuccess);
+    connect(m_creatorThread, &BitTorrent::TorrentCreatorThread::creationFailure, this, &TorrentCreatorController::handleCreationFailure);
+    connect(m_creatorThread, &BitTorrent::TorrentCreatorThread::updateProgress, this, &TorrentCreatorController::handleProgress);
+    // the next task can only be started once the thread has actually stopped
+    connect(m_creatorThread, &QThread::finished, this, &TorrentCreatorController::handleThreadFinished);
+}
+
+// Queues creation of a torrent file. Tasks are run one at a time,
+// each of them hashing pieces with all available cores.
+// POST params:
+//   - "sourcePath": file or folder to create the torrent from
+//   - "torrentFilePath": where to save the created torrent file
+//   - "pieceSize": piece size in bytes, 0 (default) to pick it automatically
+//   - "private": whether the torrent is private
+//   - "format": "v1", "v2" or "hybrid" (libtorrent 2.0 only, default "hybrid")
+//   - "optimizeAlignment", "paddedFileSizeLimit": file alignment options (libtorrent 1.2 only)
+//   - "trackers": newline separated tracker URLs, an empty line starts a new tier
+//   - "urlSeeds": newline separated web seed URLs
+//   - "comment", "source": optional torrent fields
+void TorrentCreatorController::addTaskAction()
+{
+    requireParams({"sourcePath", "torrentFilePath"});
+
+    const QString sourcePath = params()["sourcePath"].trimmed();
+    const QString torrentFilePath = params()["torrentFilePath"].trimmed();
+    if (sourcePath.isEmpty() || torrentFilePath.isEmpty())
+        throw APIError(APIErrorType::BadParams);
+
+    bool ok = true;
+    const int pieceSize = params().value("pieceSize", "0").toInt(&ok);
+    if (!ok || (pieceSize < 0))
+        throw APIError(APIErrorType::BadParams, tr("Invalid piece size"));
+
+    BitTorrent::TorrentCreatorParams creatorParams;
+    creatorParams.isPrivate = Utils::String::parseBool(params()["private"]).value_or(false);
+#if (LIBTORRENT_VERSION_NUM >= 20000)
+    const QString format = params().value("format", "hybrid").toLower();
+    if (format == QLatin1String("v1"))
+        creatorParams.torrentFormat = BitTorrent::TorrentFormat::V1;
+    else if (format == QLatin1String("v2"))
+        creatorParams.torrentFormat = BitTorrent::TorrentFormat::V2;
+    else if (format == QLatin1String("hybrid"))
+        creatorParams.torrentFormat = BitTorrent::TorrentFormat::Hybrid;
+    else
+        throw APIError(APIErrorType::BadParams, tr("Invalid torrent format"));
+#else
+    creatorParams.isAlignmentOptimized = Utils::String::parseBool(params()["optimizeAlignment"]).value_or(false);
+    creatorParams.paddedFileSizeLimit = params().value("paddedFileSizeLimit", "-1").toInt();
+#endif
+    creatorParams.pieceSize = pieceSize;
+    creatorParams.inputPath = sourcePath;
+    creatorParams.savePath = torrentFilePath;
+    creatorParams.comment = params()["comment"];
+    creatorParams.source = params()["source"];
+    creatorParams.trackers = params()["trackers"].trimmed().split('\n');
+    creatorParams.urlSeeds = params()["urlSeeds"].split('\n', QString::SkipEmptyParts);
+
+    const QString taskID = QString::number(++m_lastTaskID);
+    Task task;
+    task.params = creatorParams;
+    task.timeAdded = QDateTime::currentDateTime();
+    m_tasks[taskID] = task;
+    m_queuedTaskIDs.enqueue(taskID);
+
+    startNextTask();
+
+    setResult(QJsonObject {{"taskID", taskID}});
+}
+
+void TorrentCreatorController::statusAction()
+{
+    const QString filterID = params()["taskID"];
+    if (!filterID.isEmpty() && !m_tasks.contains(filterID))
+        throw APIError(APIErrorType::NotFound);
+
+    QJsonArray statusArray;
+    for (auto i = m_tasks.cbegin(); i != m_tasks.cend(); ++i)
+    {
+        if (!filterID.isEmpty() && (i.key() != filterID))
+            continue;
+
+        const Task &task = i.value();
+        QJsonObject taskObj
+        {
+            {"taskID", i.key()},
+            {"sourcePath", task.params.inputPath},
+            {"torrentFilePath", task.params.savePath},
+            {"status", taskStatusString(task.status)},
+            {"progress", task.progress},
+            {"timeAdded", task.timeAdded.toString(Qt::ISODate)}
+        };
+        if (task.status == TaskStatus::Failed)
+            taskObj[QLatin1String("errorMessage")] = task.errorMessage;
+
+        statusArray << taskObj;
+    }
+
+    setResult(statusArray);
+}
+
+void TorrentCreatorController::deleteTaskAction()
+{
+    requireParams({"taskID"});
+
+    const QString taskID = params()["taskID"];
+    if (!m_tasks.contains(taskID))
+        throw APIError(APIErrorType::NotFound);
+
+    // piece hashing can't be aborted midway
+    if (taskID == m_activeTaskID)
+        throw APIError(APIErrorType::Conflict, tr("Task is running"));
+
+    m_queuedTaskIDs.removeOne(taskID);
+    m_tasks.remove(taskID);
+}
+
+void TorrentCreatorController::startNextTask()
+{
+    if (!m_activeTaskID.isEmpty() || m_queuedTaskIDs.isEmpty())
+        return;
+
+    m_activeTaskID = m_queuedTaskIDs.dequeue();
+    Task &task = m_tasks[m_activeTaskID];
+    task.status = TaskStatus::Running;
+    m_creatorThread->create(task.params);
+}
+
+void TorrentCreatorController::handleCreationSuccess()
+{
+    Task &task = m_tasks[m_activeTaskID];
+    task.status = TaskStatus::Finished;
+    task.progress = 100;
+}
+
+void TorrentCreatorController::handleCreationFailure(const QString &msg)
+{
+    Task &task = m_tasks[m_activeTaskID];
+    task.status = TaskStatus::Failed;
+    task.errorMessage = msg;
+}
+
+void TorrentCreatorController::handleThreadFinished()
+{
+    Task &task = m_tasks[m_activeTaskID];
+    if (task.status == TaskStatus::Running)
+    {
+        // creation was interrupted
+        task.status = TaskStatus::Failed;
+    }
+
+    m_activeTaskID.clear();
+    startNextTask();
+}
+
+QString TorrentCreatorController::taskStatusString(const TaskStatus status)
+{
+    switch (status)
+    {
+    case TaskStatus::Queued:
+        return QLatin1String("Queued");
+    case TaskStatus::Running:
+        return QLatin1String("Running");
+    case TaskStatus::Finished:
+        return QLatin1String("Finished");
+    case TaskStatus::Failed:
+    default:
+        return QLatin1String("Failed");
+    }
+}
+
+void TorrentCreatorController::handleProgress(const int progress)
+{
+    if (!m_activeTaskID.isEmpty())
+        m_tasks[m_activeTaskID].progress = progress;
+}
@@ -0,0 +1,83 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QQueue>
+
+#include "base/bittorrent/torrentcreatorthread.h"
+#include "apicontroller.h"
+
+class TorrentCreatorController final : public APIController
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TorrentCreatorController)
+
+public:
+    explicit TorrentCreatorController(ISessionManager *sessionManager, QObject *parent = nullptr);
+
+private slots:
+    void addTaskAction();
+    void statusAction();
+    void deleteTaskAction();
+
+private:
+    enum class TaskStatus
+    {
+        Queued,
+        Running,
+        Finished,
+        Failed
+    };
+
+    struct Task
+    {
+        BitTorrent::TorrentCreatorParams params;
+        TaskStatus status = TaskStatus::Queued;
+        int progress = 0;
+        QString errorMessage;
+        QDateTime timeAdded;
+    };
+
+    void startNextTask();
+    void handleCreationSuccess();
+    void handleCreationFailure(const QString &msg);
+    void handleProgress(int progress);
+    void handleThreadFinished();
+
+    static QString taskStatusString(TaskStatus status);
+
+    BitTorrent::TorrentCreatorThread *m_creatorThread;
+    QHash<QString, Task> m_tasks;
+    QQueue<QString> m_queuedTaskIDs;
+    QString m_activeTaskID;
+    int m_lastTaskID = 0;
+};
@@ -28,6 +28,7 @@
 
 #include "torrentscontroller.h"
 
+#include <algorithm>
 #include <functional>
 
 #include <QBitArray>
@@ -35,6 +36,8 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QList>
+#include <QMimeDatabase>
+#include <QMimeType>
 #include <QNetworkCookie>
 #include <QRegularExpression>
 #include <QUrl>
@@ -55,6 +58,7 @@
 #include "base/utils/fs.h"
 #include "base/utils/string.h"
 #include "apierror.h"
+#include "isessionmanager.h"
 #include "serialize/serialize_torrent.h"
 
 // Tracker keys
@@ -70,6 +74,16 @@ const char KEY_TRACKER_DOWNLOADED_COUNT[] = "num_downloaded";
 // Web seed keys
 const char KEY_WEBSEED_URL[] = "url";
 
+// Memory usage keys
+const char KEY_MEMORY_METADATA[] = "metadata";
+const char KEY_MEMORY_RESUME_DATA[] = "resume_data";
+const char KEY_MEMORY_STATUS[] = "status";
+const char KEY_MEMORY_TRACKERS[] = "trackers";
+const char KEY_MEMORY_TAGS[] = "tags";
+const char KEY_MEMORY_OTHER[] = "other";
+const char KEY_MEMORY_TOTAL[] = "total";
+const char KEY_MEMORY_TORRENTS[] = "torrents";
+
 // Torrent keys (Properties)
 const char KEY_PROP_TIME_ELAPSED[] = "time_elapsed";
 const char KEY_PROP_SEEDING_TIME[] = "seeding_time";
@@ -106,6 +120,7 @@ const char KEY_PROP_SAVE_PATH[] = "save_path";
 const char KEY_PROP_COMMENT[] = "comment";
 
 // File keys
+const char KEY_FILE_INDEX[] = "index";
 const char KEY_FILE_NAME[] = "name";
 const char KEY_FILE_SIZE[] = "size";
 const char KEY_FILE_PROGRESS[] = "progress";
@@ -114,10 +129,48 @@ const char KEY_FILE_IS_SEED[] = "is_seed";
 const char KEY_FILE_PIECE_RANGE[] = "piece_range";
 const char KEY_FILE_AVAILABILITY[] = "availability";
 
+// Piece map keys
+const char KEY_PIECES_VERSION[] = "version";
+const char KEY_PIECES_COUNT[] = "pieces";
+const char KEY_PIECES_OFFSET[] = "offset";
+const char KEY_PIECES_RUNS[] = "runs";
+
 namespace
 {
     using Utils::String::parseBool;
 
+    struct ByteRange
+    {
+        qint64 first;
+        qint64 last;
+    };
+
+    // [rfc7233] 2.1. Byte Ranges
+    // Only single ranges are supported, nothing is returned for anything else
+    std::optional<ByteRange> parseByteRange(const QString &header, const qint64 size)
+    {
+        const QRegularExpressionMatch match = QRegularExpression(QLatin1String("^bytes=(\\d*)-(\\d*)$"), QRegularExpression::CaseInsensitiveOption)
+            .match(header.trimmed());
+        if (!match.hasMatch() || (size <= 0))
+            return std::nullopt;
+
+        const QString first = match.captured(1);
+        const QString last = match.captured(2);
+        if (first.isEmpty())
+        {
+            // suffix range, i.e. the last bytes of the file
+            const qint64 suffixLength = last.toLongLong();
+            if (suffixLength <= 0)
+                return std::nullopt;
+            return ByteRange {qMax<qint64>(0, (size - suffixLength)), (size - 1)};
+        }
+
+        const ByteRange range {first.toLongLong(), (last.isEmpty() ? (size - 1) : qMin(last.toLongLong(), (size - 1)))};
+        if (range.last < range.first)
+            return std::nullopt;
+        return range;
+    }
+
     void applyToTorrents(const QStringList &hashes, const std::function<void (BitTorrent::Torrent *torrent)> &func)
     {
         if ((hashes.size() == 1) && (hashes[0] == QLatin1String("all")))
@@ -136,6 +189,19 @@ namespace
         }
     }
 
+    QJsonObject memoryUsageToJson(const BitTorrent::TorrentMemoryUsage &usage)
+    {
+        return {
+            {KEY_MEMORY_METADATA, usage.metadata},
+            {KEY_MEMORY_RESUME_DATA, usage.resumeData},
+            {KEY_MEMORY_STATUS, usage.status},
+            {KEY_MEMORY_TRACKERS, usage.trackers},
+            {KEY_MEMORY_TAGS, usage.tags},
+            {KEY_MEMORY_OTHER, usage.other},
+            {KEY_MEMORY_TOTAL, usage.total()}
+        };
+    }
+
     QJsonArray getStickyTrackers(const BitTorrent::Torrent *const torrent)
     {
         int seedsDHT = 0, seedsPeX = 0, seedsLSD = 0, leechesDHT = 0, leechesPeX = 0, leechesLSD = 0;
@@ -208,6 +274,51 @@ namespace
         return {dht, pex, lsd};
     }
 
+    // Number of torrents whose recently sent piece maps are remembered
+    const int MAX_PIECE_MAP_HISTORIES = 16;
+    // Number of piece map versions remembered for each of them
+    const int MAX_PIECE_MAP_VERSIONS = 4;
+
+    QByteArray pieceStates(const BitTorrent::Torrent *torrent)
+    {
+        const QBitArray states = torrent->pieces();
+        const QBitArray dlstates = torrent->downloadingPieces();
+
+        QByteArray pieceStates(states.size(), 0);
+        for (int i = 0; i < states.size(); ++i)
+            pieceStates[i] = dlstates[i] ? 1 : (states[i] ? 2 : 0);
+
+        return pieceStates;
+    }
+
+    // Each run of equal states is an unsigned LEB128 integer holding (length << 2) | state
+    QByteArray encodePieceRuns(const QByteArray &states, const int begin, const int end)
+    {
+        QByteArray runs;
+        int i = begin;
+        while (i < end)
+        {
+            const char state = states[i];
+            int runEnd = i + 1;
+            while ((runEnd < end) && (states[runEnd] == state))
+                ++runEnd;
+
+            quint64 value = (static_cast<quint64>(runEnd - i) << 2) | static_cast<quint64>(state);
+            do
+            {
+                char byte = static_cast<char>(value & 0x7F);
+                value >>= 7;
+                if (value != 0)
+                    byte |= 0x80;
+                runs.append(byte);
+            } while (value != 0);
+
+            i = runEnd;
+        }
+
+        return runs;
+    }
+
     QVector<BitTorrent::InfoHash> toInfoHashes(const QStringList &hashes)
     {
         QVector<BitTorrent::InfoHash> infoHashes;
@@ -498,6 +609,7 @@ void TorrentsController::webseedsAction()
 // Returns the files in a torrent in JSON format.
 // The return value is a JSON-formatted list of dictionaries.
 // The dictionary keys are:
+//   - "index": File index
 //   - "name": File name
 //   - "size": File size
 //   - "progress": File progress
@@ -505,11 +617,21 @@ void TorrentsController::webseedsAction()
 //   - "is_seed": Flag indicating if torrent is seeding/complete
 //   - "piece_range": Piece index range, the first number is the starting piece index
 //        and the second number is the ending piece index (inclusive)
+// GET params:
+//   - hash (string): torrent hash
+//   - indexes (string): file indexes separated by |, all files if omitted or empty
+//   - offset (int): number of files skipped
+//   - limit (int): maximum number of files returned (if greater than 0, otherwise - unlimited)
 void TorrentsController::filesAction()
 {
     requireParams({"hash"});
 
     const QString hash {params()["hash"]};
+    const int offset {params()["offset"].toInt()};
+    const int limit {params()["limit"].toInt()};
+    if (offset < 0)
+        throw APIError(APIErrorType::BadParams, tr("'offset' parameter is invalid"));
+
     const BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
@@ -517,18 +639,43 @@ void TorrentsController::filesAction()
     QJsonArray fileList;
     if (torrent->hasMetadata())
     {
+        const int filesCount = torrent->filesCount();
+        QVector<int> fileIndexes;
+        const QString indexes = params()["indexes"];
+        if (!indexes.isEmpty())
+        {
+            for (const QString &fileIndex : indexes.split('|'))
+            {
+                bool ok = false;
+                const int index = fileIndex.toInt(&ok);
+                if (!ok || (index < 0) || (index >= filesCount))
+                    throw APIError(APIErrorType::Conflict, tr("File index is not valid"));
+                fileIndexes.append(index);
+            }
+            fileIndexes = fileIndexes.mid(offset, ((limit > 0) ? limit : -1));
+        }
+        else
+        {
+            const int end = (limit > 0) ? static_cast<int>(std::min<qint64>((static_cast<qint64>(offset) + limit), filesCount)) : filesCount;
+            for (int i = offset; i < end; ++i)
+                fileIndexes.append(i);
+        }
+
         const QVector<BitTorrent::DownloadPriority> priorities = torrent->filePriorities();
-        const QVector<qreal> fp = torrent->filesProgress();
-        const QVector<qreal> fileAvailability = torrent->availableFileFractions();
+        // computed for the requested page only
+        const QVector<qreal> fp = torrent->filesProgress(fileIndexes);
+        const QVector<qreal> fileAvailability = torrent->availableFileFractions(fileIndexes);
         const BitTorrent::TorrentInfo info = torrent->info();
-        for (int i = 0; i < torrent->filesCount(); ++i)
+        for (int j = 0; j < fileIndexes.size(); ++j)
         {
+            const int i = fileIndexes[j];
             QJsonObject fileDict =
             {
-                {KEY_FILE_PROGRESS, fp[i]},
+                {KEY_FILE_INDEX, i},
+                {KEY_FILE_PROGRESS, fp.value(j)},
                 {KEY_FILE_PRIORITY, static_cast<int>(priorities[i])},
                 {KEY_FILE_SIZE, torrent->fileSize(i)},
-                {KEY_FILE_AVAILABILITY, fileAvailability[i]}
+                {KEY_FILE_AVAILABILITY, fileAvailability.value(j)}
             };
 
             QString fileName = torrent->filePath(i);
@@ -539,7 +686,7 @@ void TorrentsController::filesAction()
             const BitTorrent::TorrentInfo::PieceRange idx = info.filePieces(i);
             fileDict[KEY_FILE_PIECE_RANGE] = QJsonArray {idx.first(), idx.last()};
 
-            if (i == 0)
+            if (fileList.isEmpty())
                 fileDict[KEY_FILE_IS_SEED] = torrent->isSeed();
 
             fileList.append(fileDict);
@@ -549,52 +696,277 @@ void TorrentsController::filesAction()
     setResult(fileList);
 }
 
+// Sends the content of a file of the torrent. The Range header is supported so that
+// the file can be read while it downloads. Only the part of the requested range that has
+// been downloaded is sent, and the next missing pieces are requested before any other.
+// Requests for several ranges, or in a unit other than bytes, are served as if they had no Range header. If none of the requested range is available yet, the reply is 503 with a Retry-After header.
+// GET params:
+//   - hash (string): torrent hash
+//   - index (int): file index
+void TorrentsController::contentAction()
+{
+    requireParams({"hash", "index"});
+
+    const QString hash {params()["hash"]};
+    bool ok = false;
+    const int fileIndex = params()["index"].toInt(&ok);
+    if (!ok)
+        throw APIError(APIErrorType::BadParams, tr("File index must be an integer"));
+
+    BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
+    if (!torrent)
+        throw APIError(APIErrorType::NotFound);
+    if (!torrent->hasMetadata())
+        throw APIError(APIErrorType::Conflict, tr("Torrent's metadata has not yet downloaded"));
+    if ((fileIndex < 0) || (fileIndex >= torrent->filesCount()))
+        throw APIError(APIErrorType::Conflict, tr("File index is not valid"));
+
+    const BitTorrent::TorrentInfo info = torrent->info();
+    const qint64 fileSize = info.fileSize(fileIndex);
+
+    QString rangeHeader = headers().value(QLatin1String(Http::HEADER_RANGE)).trimmed();
+    // [RFC 9110] 14.2. A Range header with a unit that isn't understood is ignored
+    if (!rangeHeader.startsWith(QLatin1String("bytes="), Qt::CaseInsensitive))
+        rangeHeader.clear();
+    // Several ranges would need a multipart/byteranges reply. A server may ignore
+    // the Range header instead, so the request is served as if it had none.
+    if (rangeHeader.contains(QLatin1Char(',')))
+        rangeHeader.clear();
+    const std::optional<ByteRange> requestedRange = parseByteRange(rangeHeader, fileSize);
+    if (!rangeHeader.isEmpty() && !requestedRange)
+    {
+        Http::Response response {416, QLatin1String("Range Not Satisfiable")};
+        response.headers[Http::HEADER_CONTENT_RANGE] = QString::fromLatin1("bytes */%1").arg(fileSize);
+        setResult(response);
+        return;
+    }
+
+    const ByteRange range = requestedRange.value_or(ByteRange {0, (fileSize - 1)});
+
+    // Find the downloaded part at the start of the range
+    const qint64 fileOffset = info.fileOffset(fileIndex);
+    const qint64 pieceLength = info.pieceLength();
+    const int firstPiece = static_cast<int>((fileOffset + range.first) / pieceLength);
+    const int lastPiece = static_cast<int>((fileOffset + qMax<qint64>(range.first, range.last)) / pieceLength);
+    const QBitArray pieces = torrent->pieces();
+    int firstMissingPiece = firstPiece;
+    while ((firstMissingPiece <= lastPiece) && (firstMissingPiece < pieces.size()) && pieces.testBit(firstMissingPiece))
+        ++firstMissingPiece;
+
+    if ((firstMissingPiece <= lastPiece) && !torrent->isSeed())
+    {
+        // each client reading the file has its own read-ahead window
+        const QString readerId = sessionManager()->session()->id() + QLatin1Char('/') + QString::number(fileIndex);
+        torrent->setPieceDeadlines(readerId, firstMissingPiece, lastPiece);
+    }
+
+    const qint64 availableLast = (firstMissingPiece > lastPiece)
+        ? range.last
+        : qMin(range.last, ((firstMissingPiece * pieceLength) - fileOffset - 1));
+
+    // without a Range header the whole file has to be sent in one go
+    if ((fileSize > 0) && ((availableLast < range.first) || (!requestedRange && (availableLast < range.last))))
+    {
+        Http::Response response {503, QLatin1String("Service Unavailable")};
+        response.headers[Http::HEADER_RETRY_AFTER] = QLatin1String("1");
+        setResult(response);
+        return;
+    }
+
+    QString fileName = info.filePath(fileIndex);
+    if (fileName.endsWith(QB_EXT, Qt::CaseInsensitive))
+        fileName.chop(QB_EXT.size());
+
+    Http::Response response;
+    if (requestedRange)
+    {
+        response.status = {206, QLatin1String("Partial Content")};
+        response.headers[Http::HEADER_CONTENT_RANGE] = QString::fromLatin1("bytes %1-%2/%3")
+            .arg(QString::number(range.first), QString::number(availableLast), QString::number(fileSize));
+    }
+    response.headers[Http::HEADER_ACCEPT_RANGES] = QLatin1String("bytes");
+    response.headers[Http::HEADER_CONTENT_TYPE] = QMimeDatabase().mimeTypeForFile(fileName, QMimeDatabase::MatchExtension).name();
+    response.headers[Http::HEADER_CACHE_CONTROL] = QLatin1String("no-store");
+    response.fileContent = {
+        Utils::Fs::expandPathAbs(QDir(torrent->savePath(true)).absoluteFilePath(info.filePath(fileIndex)))
+        , range.first, (fileSize > 0) ? (availableLast - range.first + 1) : 0};
+    setResult(response);
+}
+
 // Returns an array of hashes (of each pieces respectively) for a torrent in JSON format.
 // The return value is a JSON-formatted array of strings (hex strings).
+// GET params:
+//   - hash (string): torrent hash
+//   - offset (int): index of the first piece returned
+//   - limit (int): maximum number of hashes returned (if greater than 0, otherwise - unlimited)
+//   - format (string): "json" (default) or "binary" to get the raw hashes
+//     concatenated as application/octet-stream
 void TorrentsController::pieceHashesAction()
 {
     requireParams({"hash"});
 
     const QString hash {params()["hash"]};
+    const int offset {params()["offset"].toInt()};
+    const int limit {params()["limit"].toInt()};
+    const QString format {params()["format"]};
+    if (offset < 0)
+        throw APIError(APIErrorType::BadParams, tr("'offset' parameter is invalid"));
+    if (!format.isEmpty() && (format != QLatin1String("json")) && (format != QLatin1String("binary")))
+        throw APIError(APIErrorType::BadParams, tr("'format' parameter is invalid"));
+
     BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
+    const QVector<QByteArray> hashes = torrent->info().pieceHashes().mid(offset, ((limit > 0) ? limit : -1));
+
+    if (format == QLatin1String("binary"))
+    {
+        QByteArray rawHashes;
+        for (const QByteArray &hash : hashes)
+            rawHashes.append(hash);
+
+        setResult(rawHashes);
+        return;
+    }
+
     QJsonArray pieceHashes;
-    const QVector<QByteArray> hashes = torrent->info().pieceHashes();
     for (const QByteArray &hash : hashes)
         pieceHashes.append(QString(hash.toHex()));
 
     setResult(pieceHashes);
 }
 
+// Returns the estimated memory usage of the torrents, in bytes, broken down by component.
+// GET param:
+//   - hashes (string): hashes separated by |, or "all" (default)
+// The return value is a JSON object with the usage of each torrent
+// under "torrents" (keyed by hash) and their sum under "total".
+void TorrentsController::memoryUsageAction()
+{
+    const QString hashesParam = params()["hashes"];
+    const QStringList hashes = hashesParam.isEmpty()
+        ? QStringList {QLatin1String("all")} : hashesParam.split('|', QString::SkipEmptyParts);
+
+    BitTorrent::TorrentMemoryUsage total;
+    QJsonObject torrents;
+    applyToTorrents(hashes, [&total, &torrents](const BitTorrent::Torrent *torrent)
+    {
+        const BitTorrent::TorrentMemoryUsage usage = torrent->memoryUsage();
+        total.metadata += usage.metadata;
+        total.resumeData += usage.resumeData;
+        total.status += usage.status;
+        total.trackers += usage.trackers;
+        total.tags += usage.tags;
+        total.other += usage.other;
+
+        torrents[torrent->hash()] = memoryUsageToJson(usage);
+    });
+
+    setResult(QJsonObject {
+        {KEY_MEMORY_TORRENTS, torrents},
+        {KEY_MEMORY_TOTAL, memoryUsageToJson(total)}
+    });
+}
+
 // Returns an array of states (of each pieces respectively) for a torrent in JSON format.
 // The return value is a JSON-formatted array of ints.
 // 0: piece not downloaded
 // 1: piece requested or downloading
 // 2: piece already downloaded
+// GET params:
+//   - hash (string): torrent hash
+//   - format (string): "json" (default), "rle" or "binary"
+//   - version (int): version of the piece map the client has, "rle" format only
+// The "rle" format returns a JSON-formatted dictionary:
+//   - "version": version of the piece map
+//   - "pieces": number of pieces
+//   - "offset": index of the first piece covered by "runs"
+//   - "runs": base64 encoded runs of the pieces that changed since "version"
+//     (all pieces if "version" is unknown), omitted if none changed
+// Each run is an unsigned LEB128 integer holding (length << 2) | state.
+// The "binary" format returns the runs of all pieces as application/octet-stream.
 void TorrentsController::pieceStatesAction()
 {
     requireParams({"hash"});
 
     const QString hash {params()["hash"]};
+    const QString format {params()["format"]};
+    if (!format.isEmpty() && (format != QLatin1String("json"))
+        && (format != QLatin1String("rle")) && (format != QLatin1String("binary")))
+    {
+        throw APIError(APIErrorType::BadParams, tr("'format' parameter is invalid"));
+    }
+
     BitTorrent::Torrent *const torrent = BitTorrent::Session::instance()->findTorrent(hash);
     if (!torrent)
         throw APIError(APIErrorType::NotFound);
 
-    QJsonArray pieceStates;
-    const QBitArray states = torrent->pieces();
-    for (int i = 0; i < states.size(); ++i)
-        pieceStates.append(static_cast<int>(states[i]) * 2);
+    const QByteArray states = pieceStates(torrent);
+
+    if (format == QLatin1String("binary"))
+    {
+        setResult(encodePieceRuns(states, 0, states.size()));
+        return;
+    }
+
+    if (format != QLatin1String("rle"))
+    {
+        QJsonArray pieceStates;
+        for (const char state : states)
+            pieceStates.append(static_cast<int>(state));
+
+        setResult(pieceStates);
+        return;
+    }
+
+    if (!m_pieceMapHistories.contains(hash) && (m_pieceMapHistories.size() >= MAX_PIECE_MAP_HISTORIES))
+    {
+        const auto leastRecentlyUsed = std::min_element(m_pieceMapHistories.cbegin(), m_pieceMapHistories.cend()
+            , [](const PieceMapHistory &left, const PieceMapHistory &right)
+        {
+            return (left.lastUsed < right.lastUsed);
+        });
+        m_pieceMapHistories.erase(leastRecentlyUsed);
+    }
+
+    PieceMapHistory &history = m_pieceMapHistories[hash];
+    history.lastUsed = ++m_pieceMapRequestCount;
+
+    const qint64 clientVersion = params()["version"].toLongLong();
+    const auto baseSnapshot = std::find_if(history.snapshots.cbegin(), history.snapshots.cend()
+        , [clientVersion, &states](const PieceMapSnapshot &snapshot)
+    {
+        return (snapshot.version == clientVersion) && (snapshot.states.size() == states.size());
+    });
+    const bool isDelta = (baseSnapshot != history.snapshots.cend());
 
-    const QBitArray dlstates = torrent->downloadingPieces();
-    for (int i = 0; i < states.size(); ++i)
+    int begin = 0;
+    int end = states.size();
+    if (isDelta)
     {
-        if (dlstates[i])
-            pieceStates[i] = 1;
+        while ((begin < end) && (states[begin] == baseSnapshot->states[begin]))
+            ++begin;
+        while ((end > begin) && (states[end - 1] == baseSnapshot->states[end - 1]))
+            --end;
     }
 
-    setResult(pieceStates);
+    if (history.snapshots.isEmpty() || (history.snapshots.last().states != states))
+    {
+        history.snapshots.append({++m_lastPieceMapVersion, states});
+        if (history.snapshots.size() > MAX_PIECE_MAP_VERSIONS)
+            history.snapshots.removeFirst();
+    }
+
+    QJsonObject result {
+        {KEY_PIECES_VERSION, history.snapshots.last().version},
+        {KEY_PIECES_COUNT, states.size()},
+        {KEY_PIECES_OFFSET, begin}
+    };
+    if (begin < end)
+        result[KEY_PIECES_RUNS] = QString::fromLatin1(encodePieceRuns(states, begin, end).toBase64());
+
+    setResult(result);
 }
 
 void TorrentsController::addAction()
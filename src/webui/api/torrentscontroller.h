@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <QHash>
+#include <QVector>
+
 #include "apicontroller.h"
 
 class TorrentsController : public APIController
@@ -44,8 +47,10 @@ private slots:
     void trackersAction();
     void webseedsAction();
     void filesAction();
+    void contentAction();
     void pieceHashesAction();
     void pieceStatesAction();
+    void memoryUsageAction();
     void resumeAction();
     void pauseAction();
     void recheckAction();
@@ -85,4 +90,24 @@ private slots:
     void toggleFirstLastPiecePrioAction();
     void renameFileAction();
     void renameFolderAction();
+
+private:
+    struct PieceMapSnapshot
+    {
+        qint64 version = 0;
+        QByteArray states;
+    };
+
+    struct PieceMapHistory
+    {
+        QVector<PieceMapSnapshot> snapshots; // oldest first
+        qint64 lastUsed = 0;
+    };
+
+    // Recent piece states sent for each torrent, to reply with the changes only.
+    // The versions are unique across torrents and clients, so each client gets
+    // the changes since the version it has, whatever the other clients requested.
+    QHash<QString, PieceMapHistory> m_pieceMapHistories;
+    qint64 m_lastPieceMapVersion = 0;
+    qint64 m_pieceMapRequestCount = 0;
 };
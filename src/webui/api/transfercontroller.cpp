@@ -28,12 +28,18 @@
 
 #include "transfercontroller.h"
 
+#include <algorithm>
+
+#include <QDateTime>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QVector>
 
 #include "base/bittorrent/peeraddress.h"
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
+#include "base/bittorrent/trackerannouncecoordinator.h"
+#include "base/bittorrent/transferhistory.h"
 #include "base/global.h"
 #include "apierror.h"
 
@@ -46,6 +52,54 @@ const char KEY_TRANSFER_UPRATELIMIT[] = "up_rate_limit";
 const char KEY_TRANSFER_DHT_NODES[] = "dht_nodes";
 const char KEY_TRANSFER_CONNECTION_STATUS[] = "connection_status";
 
+const char KEY_TRACKER_URL[] = "url";
+const char KEY_TRACKER_TORRENTS[] = "torrents";
+const char KEY_TRACKER_ANNOUNCES[] = "announces";
+const char KEY_TRACKER_REPLIES[] = "replies";
+const char KEY_TRACKER_FAILURES[] = "failures";
+const char KEY_TRACKER_FAILURE_RATE[] = "failure_rate";
+const char KEY_TRACKER_CONSECUTIVE_FAILURES[] = "consecutive_failures";
+const char KEY_TRACKER_AVG_LATENCY[] = "avg_latency";
+const char KEY_TRACKER_LAST_LATENCY[] = "last_latency";
+const char KEY_TRACKER_LAST_ERROR[] = "last_error";
+const char KEY_TRACKER_LAST_REPLY[] = "last_reply";
+const char KEY_TRACKER_LAST_FAILURE[] = "last_failure";
+const char KEY_TRACKER_SUPPRESSED_UNTIL[] = "suppressed_until";
+
+const char KEY_MOVE_JOB_HASH[] = "hash";
+const char KEY_MOVE_JOB_SOURCE[] = "source";
+const char KEY_MOVE_JOB_DESTINATION[] = "destination";
+const char KEY_MOVE_JOB_ACTIVE[] = "active";
+const char KEY_MOVE_JOB_TOTAL_SIZE[] = "total_size";
+const char KEY_MOVE_JOB_MOVED_SIZE[] = "moved_size";
+const char KEY_MOVE_JOB_PROGRESS[] = "progress";
+const char KEY_MOVE_JOB_SPEED[] = "speed";
+
+const char KEY_HISTORY_RESOLUTION[] = "resolution";
+const char KEY_HISTORY_POINTS[] = "points";
+
+const qint64 MAX_HISTORY_POINTS = 10000;
+
+namespace
+{
+    qint64 toSecsSinceEpoch(const QDateTime &dateTime)
+    {
+        return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : -1;
+    }
+
+    qint64 parseSecs(const QString &value, const qint64 defaultValue)
+    {
+        if (value.isEmpty())
+            return defaultValue;
+
+        bool ok = false;
+        const qint64 secs = value.toLongLong(&ok);
+        if (!ok)
+            throw APIError(APIErrorType::BadParams);
+        return secs;
+    }
+}
+
 // Returns the global transfer information in JSON format.
 // The return value is a JSON-formatted dictionary.
 // The dictionary keys are:
@@ -129,3 +183,122 @@ void TransferController::banPeersAction()
             BitTorrent::Session::instance()->banIP(addr.ip.toString());
     }
 }
+
+// Returns the announce statistics of every tracker seen in this session.
+// The return value is a JSON-formatted list of dictionaries.
+// The dictionary keys are:
+//   - "url": Tracker URL
+//   - "torrents": Number of torrents using the tracker
+//   - "announces": Announces sent
+//   - "replies": Successful replies
+//   - "failures": Failed announces
+//   - "failure_rate": Failed announces / (replies + failed announces)
+//   - "consecutive_failures": Failures since the last successful reply
+//   - "avg_latency": Average reply latency in milliseconds, -1 if unknown
+//   - "last_latency": Latency of the last reply in milliseconds, -1 if unknown
+//   - "last_error": Last error message
+//   - "last_reply": Time of the last successful reply (epoch seconds), -1 if none
+//   - "last_failure": Time of the last failure (epoch seconds), -1 if none
+//   - "suppressed_until": End of the current announce backoff (epoch seconds), -1 if not suppressed
+void TransferController::trackerHealthAction()
+{
+    const BitTorrent::Session *session = BitTorrent::Session::instance();
+    const QHash<QString, QSet<BitTorrent::InfoHash>> trackerIndex = session->trackerIndex();
+
+    QJsonArray result;
+    for (const BitTorrent::TrackerHealth &health : asConst(session->trackerHealth()))
+    {
+        const int attempts = health.replies + health.failures;
+        result << QJsonObject {
+            {KEY_TRACKER_URL, health.url},
+            {KEY_TRACKER_TORRENTS, trackerIndex.value(health.url).size()},
+            {KEY_TRACKER_ANNOUNCES, health.announces},
+            {KEY_TRACKER_REPLIES, health.replies},
+            {KEY_TRACKER_FAILURES, health.failures},
+            {KEY_TRACKER_FAILURE_RATE, ((attempts > 0) ? (static_cast<double>(health.failures) / attempts) : 0.0)},
+            {KEY_TRACKER_CONSECUTIVE_FAILURES, health.consecutiveFailures},
+            {KEY_TRACKER_AVG_LATENCY, health.averageLatency},
+            {KEY_TRACKER_LAST_LATENCY, health.lastLatency},
+            {KEY_TRACKER_LAST_ERROR, health.lastError},
+            {KEY_TRACKER_LAST_REPLY, toSecsSinceEpoch(health.lastReplyTime)},
+            {KEY_TRACKER_LAST_FAILURE, toSecsSinceEpoch(health.lastFailureTime)},
+            {KEY_TRACKER_SUPPRESSED_UNTIL, toSecsSinceEpoch(health.suppressedUntil)}
+        };
+    }
+
+    setResult(result);
+}
+
+// Returns the storage move jobs, the active ones first, then the pending ones in the order they will be started.
+// The return value is a JSON array of objects with the following fields:
+//   - "hash": Torrent hash
+//   - "source": Path the content is moved from
+//   - "destination": Path the content is moved to
+//   - "active": Whether the job is running
+//   - "total_size": Size of the content in bytes
+//   - "moved_size": Bytes already at the destination, 0 for pending jobs
+//   - "progress": moved_size / total_size
+//   - "speed": Average throughput in bytes per second since the job started
+void TransferController::moveStorageJobsAction()
+{
+    QJsonArray result;
+    for (const BitTorrent::MoveStorageJobStatus &job : asConst(BitTorrent::Session::instance()->moveStorageJobs()))
+    {
+        result << QJsonObject {
+            {KEY_MOVE_JOB_HASH, QString {job.hash}},
+            {KEY_MOVE_JOB_SOURCE, job.sourcePath},
+            {KEY_MOVE_JOB_DESTINATION, job.destinationPath},
+            {KEY_MOVE_JOB_ACTIVE, job.isActive},
+            {KEY_MOVE_JOB_TOTAL_SIZE, job.totalSize},
+            {KEY_MOVE_JOB_MOVED_SIZE, job.movedSize},
+            {KEY_MOVE_JOB_PROGRESS, ((job.totalSize > 0) ? (static_cast<double>(job.movedSize) / job.totalSize) : 0.0)},
+            {KEY_MOVE_JOB_SPEED, job.speed}
+        };
+    }
+
+    setResult(result);
+}
+
+// Returns the payload transfer rate history.
+// The return value is a JSON object with the following fields:
+//   - "resolution": Seconds each point is averaged over, coarser than requested if the history
+//     isn't kept at the requested resolution that far back
+//   - "points": Array of [timestamp, download rate, upload rate], timestamp being the start of the interval
+// GET params:
+//   - hash (string): Torrent hash, or
+//   - category (string): Category name, the whole session if neither is given
+//   - from (int): Seconds since epoch (default one hour ago)
+//   - to (int): Seconds since epoch, excluded (default now)
+//   - resolution (int): Seconds (default 1)
+void TransferController::historyAction()
+{
+    const QString hash = params()["hash"];
+    const QString category = params()["category"];
+    const QString series = !hash.isEmpty() ? BitTorrent::TransferHistory::torrentSeries(BitTorrent::InfoHash {hash})
+        : !category.isEmpty() ? BitTorrent::TransferHistory::categorySeries(category)
+        : BitTorrent::TransferHistory::globalSeries();
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const qint64 to = parseSecs(params()["to"], now);
+    const qint64 from = parseSecs(params()["from"], (to - (60 * 60)));
+    if (from >= to)
+        throw APIError(APIErrorType::BadParams);
+
+    // don't let a huge range at a fine resolution produce an unreasonably large reply
+    const qint64 minResolution = ((to - from) + MAX_HISTORY_POINTS - 1) / MAX_HISTORY_POINTS;
+    const int resolution = static_cast<int>(std::clamp<qint64>(std::max<qint64>(parseSecs(params()["resolution"], 1), minResolution)
+        , 1, (365 * 24 * 60 * 60)));
+
+    int actualResolution = resolution;
+    const QVector<BitTorrent::TransferRatePoint> points = BitTorrent::Session::instance()->transferHistory()
+        ->points(series, from, to, resolution, &actualResolution);
+
+    QJsonArray pointList;
+    for (const BitTorrent::TransferRatePoint &point : points)
+        pointList.append(QJsonArray {point.timestamp, point.downloadRate, point.uploadRate});
+
+    setResult(QJsonObject {
+        {KEY_HISTORY_RESOLUTION, actualResolution},
+        {KEY_HISTORY_POINTS, pointList}
+    });
+}
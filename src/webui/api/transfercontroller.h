@@ -47,4 +47,7 @@ private slots:
     void setUploadLimitAction();
     void setDownloadLimitAction();
     void banPeersAction();
+    void trackerHealthAction();
+    void moveStorageJobsAction();
+    void historyAction();
 };
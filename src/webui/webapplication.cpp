@@ -42,9 +42,14 @@
 #include <QUrl>
 
 #include "base/algorithm.h"
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/trackerregistry.h"
 #include "base/global.h"
+#include "base/http/eventstream.h"
 #include "base/http/httperror.h"
+#include "base/http/responsegenerator.h"
 #include "base/logger.h"
+#include "base/net/geoipmanager.h"
 #include "base/preferences.h"
 #include "base/types.h"
 #include "base/utils/bytearray.h"
@@ -59,12 +64,14 @@
 #include "api/rsscontroller.h"
 #include "api/searchcontroller.h"
 #include "api/synccontroller.h"
+#include "api/torrentcreatorcontroller.h"
 #include "api/torrentscontroller.h"
 #include "api/transfercontroller.h"
 
 constexpr int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
 
 const QString PATH_PREFIX_ICONS {QStringLiteral("/icons/")};
+const QString PATH_METRICS {QStringLiteral("/metrics")};
 const QString WWW_FOLDER {QStringLiteral(":/www")};
 const QString PUBLIC_FOLDER {QStringLiteral("/public")};
 const QString PRIVATE_FOLDER {QStringLiteral("/private")};
@@ -124,7 +131,10 @@ WebApplication::WebApplication(QObject *parent)
     registerAPIController(QLatin1String("log"), new LogController(this, this));
     registerAPIController(QLatin1String("rss"), new RSSController(this, this));
     registerAPIController(QLatin1String("search"), new SearchController(this, this));
-    registerAPIController(QLatin1String("sync"), new SyncController(this, this));
+    auto *syncController = new SyncController(this, this);
+    connect(this, &WebApplication::sessionEnded, syncController, &SyncController::closeEventStreams);
+    registerAPIController(QLatin1String("sync"), syncController);
+    registerAPIController(QLatin1String("torrentcreator"), new TorrentCreatorController(this, this));
     registerAPIController(QLatin1String("torrents"), new TorrentsController(this, this));
     registerAPIController(QLatin1String("transfer"), new TransferController(this, this));
 
@@ -202,6 +212,101 @@ void WebApplication::sendWebUIFile()
     sendFile(localPath);
 }
 
+// Exports the libtorrent session counters and gauges along with qBittorrent's own metrics
+// in the OpenMetrics text format
+void WebApplication::sendMetrics()
+{
+    if (!session())
+        throw ForbiddenHTTPError();
+
+    QByteArray data;
+    data.reserve(m_metricsSizeHint);
+    Metrics::OpenMetricsWriter writer {data};
+
+    const BitTorrent::Session *btSession = BitTorrent::Session::instance();
+    const QVector<qint64> &values = btSession->metricValues();
+    for (const BitTorrent::SessionMetric &metric : btSession->metrics())
+    {
+        // no stats received yet
+        if (metric.index >= values.size())
+            continue;
+
+        const Metrics::Type type = metric.isGauge ? Metrics::Type::Gauge : Metrics::Type::Counter;
+        writer.addFamily(metric.name, type);
+        writer.addSample(metric.name, type, values[metric.index]);
+    }
+
+    const BitTorrent::SessionStatus &status = btSession->status();
+    writer.addFamily(QByteArrayLiteral("qbittorrent_alert_queue_depth"), Metrics::Type::Gauge
+        , "Alerts fetched from libtorrent by the last read");
+    writer.addSample(QByteArrayLiteral("qbittorrent_alert_queue_depth"), Metrics::Type::Gauge
+        , static_cast<qint64>(status.alertQueueDepth));
+    writer.addFamily(QByteArrayLiteral("qbittorrent_alerts"), Metrics::Type::Counter, "Alerts processed");
+    writer.addSample(QByteArrayLiteral("qbittorrent_alerts"), Metrics::Type::Counter
+        , static_cast<qint64>(status.alertsProcessed));
+
+    const QHash<QString, quint64> blockedPeerCounts = btSession->blockedPeerCounts();
+    writer.addFamily(QByteArrayLiteral("qbittorrent_blocked_peers"), Metrics::Type::Counter
+        , "Peers blocked or banned, by filter");
+    for (auto iter = blockedPeerCounts.cbegin(); iter != blockedPeerCounts.cend(); ++iter)
+    {
+        writer.addSample(QByteArrayLiteral("qbittorrent_blocked_peers"), Metrics::Type::Counter
+            , static_cast<qint64>(iter.value()), Metrics::OpenMetricsWriter::label("filter", iter.key()));
+    }
+
+    writer.addFamily(QByteArrayLiteral("qbittorrent_resume_data_save_seconds"), Metrics::Type::Histogram
+        , "Time spent writing resume data files");
+    writer.addHistogram(QByteArrayLiteral("qbittorrent_resume_data_save_seconds"), btSession->resumeDataSaveLatency());
+
+    if (const Net::GeoIPManager *geoIPManager = Net::GeoIPManager::instance())
+    {
+        writer.addFamily(QByteArrayLiteral("qbittorrent_geoip_lookups"), Metrics::Type::Counter, "GeoIP database lookups");
+        writer.addSample(QByteArrayLiteral("qbittorrent_geoip_lookups"), Metrics::Type::Counter
+            , static_cast<qint64>(geoIPManager->lookupCount()));
+    }
+
+    const BitTorrent::TrackerRegistry::Statistics trackerStats = BitTorrent::TrackerRegistry::statistics();
+    writer.addFamily(QByteArrayLiteral("qbittorrent_tracker_urls"), Metrics::Type::Gauge
+        , "Distinct tracker URLs in use");
+    writer.addSample(QByteArrayLiteral("qbittorrent_tracker_urls"), Metrics::Type::Gauge, trackerStats.urlCount);
+    writer.addFamily(QByteArrayLiteral("qbittorrent_tracker_references"), Metrics::Type::Gauge
+        , "Trackers of all the torrents");
+    writer.addSample(QByteArrayLiteral("qbittorrent_tracker_references"), Metrics::Type::Gauge, trackerStats.references);
+    writer.addFamily(QByteArrayLiteral("qbittorrent_tracker_url_bytes"), Metrics::Type::Gauge
+        , "Memory held by the shared tracker URLs");
+    writer.addSample(QByteArrayLiteral("qbittorrent_tracker_url_bytes"), Metrics::Type::Gauge, trackerStats.urlBytes);
+    writer.addFamily(QByteArrayLiteral("qbittorrent_tracker_url_saved_bytes"), Metrics::Type::Gauge
+        , "Memory the tracker URLs would take if every torrent had its own copies");
+    writer.addSample(QByteArrayLiteral("qbittorrent_tracker_url_saved_bytes"), Metrics::Type::Gauge, trackerStats.savedBytes);
+
+    const Logger *logger = Logger::instance();
+    writer.addFamily(QByteArrayLiteral("qbittorrent_log_file_written_messages"), Metrics::Type::Counter
+        , "Log messages written to the log file");
+    writer.addSample(QByteArrayLiteral("qbittorrent_log_file_written_messages"), Metrics::Type::Counter
+        , logger->fileLogWrittenMessages());
+    writer.addFamily(QByteArrayLiteral("qbittorrent_log_file_dropped_messages"), Metrics::Type::Counter
+        , "Log messages not written to the log file because it couldn't keep up");
+    writer.addSample(QByteArrayLiteral("qbittorrent_log_file_dropped_messages"), Metrics::Type::Counter
+        , logger->fileLogDroppedMessages());
+
+    writer.addFamily(QByteArrayLiteral("qbittorrent_webui_request_seconds"), Metrics::Type::Histogram
+        , "Time spent handling Web API requests, by action");
+    for (auto iter = m_apiLatencies.cbegin(); iter != m_apiLatencies.cend(); ++iter)
+    {
+        writer.addHistogram(QByteArrayLiteral("qbittorrent_webui_request_seconds"), iter.value()
+            , Metrics::OpenMetricsWriter::label("action", iter.key()));
+    }
+
+    writer.addFamily(QByteArrayLiteral("qbittorrent_webui_json_serialization_seconds"), Metrics::Type::Histogram
+        , "Time spent serializing JSON responses, in the connection threads");
+    writer.addHistogram(QByteArrayLiteral("qbittorrent_webui_json_serialization_seconds"), Http::jsonSerializationLatency());
+
+    writer.finish();
+
+    m_metricsSizeHint = data.size();
+    print(data, Http::CONTENT_TYPE_OPENMETRICS);
+}
+
 void WebApplication::translateDocument(QString &data) const
 {
     const QRegularExpression regex("QBT_TR\\((([^\\)]|\\)(?!QBT_TR))+)\\)QBT_TR\\[CONTEXT=([a-zA-Z_][a-zA-Z0-9_]*)\\]");
@@ -258,6 +363,12 @@ const Http::Environment &WebApplication::env() const
 
 void WebApplication::doProcessRequest()
 {
+    if (request().path == PATH_METRICS)
+    {
+        sendMetrics();
+        return;
+    }
+
     const QRegularExpressionMatch match = m_apiPathPattern.match(request().path);
     if (!match.hasMatch())
     {
@@ -281,11 +392,49 @@ void WebApplication::doProcessRequest()
 
     try
     {
-        const QVariant result = controller->run(action, m_params, data);
+        QVariant result;
+        {
+            // failed requests are timed too, but not the unknown actions, they would only add noise
+            const bool isKnownAction = (controller->metaObject()->indexOfMethod((action + QLatin1String("Action()")).toLatin1()) >= 0);
+            QElapsedTimer timer;
+            timer.start();
+            const auto observeLatency = [&]()
+            {
+                if (isKnownAction)
+                    m_apiLatencies[scope + QLatin1Char('/') + action].observe(timer.nsecsElapsed() / 1e9);
+            };
+
+            try
+            {
+                result = controller->run(action, m_params, data, request().headers);
+            }
+            catch (...)
+            {
+                observeLatency();
+                throw;
+            }
+            observeLatency();
+        }
+
+        if (result.userType() == qMetaTypeId<QSharedPointer<Http::EventStream>>())
+        {
+            openEventStream(result.value<QSharedPointer<Http::EventStream>>());
+            return;
+        }
+        if (result.userType() == qMetaTypeId<Http::Response>())
+        {
+            setResponse(result.value<Http::Response>());
+            return;
+        }
+
         switch (result.userType())
         {
         case QMetaType::QJsonDocument:
-            print(result.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
+            // serialized by the connection, in its own thread
+            print(result.toJsonDocument());
+            break;
+        case QMetaType::QByteArray:
+            print(result.toByteArray(), Http::CONTENT_TYPE_OCTET_STREAM);
             break;
         case QMetaType::QString:
         default:
@@ -531,6 +680,7 @@ void WebApplication::sessionInitialize()
             {
                 // session is outdated - removing it
                 delete m_sessions.take(sessionId);
+                emit sessionEnded(sessionId);
                 m_currentSession = nullptr;
             }
             else
@@ -587,6 +737,7 @@ void WebApplication::sessionStart()
     {
         if (session->hasExpired(m_sessionTimeout))
         {
+            emit sessionEnded(session->id());
             delete session;
             return true;
         }
@@ -615,8 +766,10 @@ void WebApplication::sessionEnd()
     cookie.setPath(QLatin1String("/"));
     cookie.setExpirationDate(QDateTime::currentDateTime().addDays(-1));
 
-    delete m_sessions.take(m_currentSession->id());
+    const QString sessionId = m_currentSession->id();
+    delete m_sessions.take(sessionId);
     m_currentSession = nullptr;
+    emit sessionEnded(sessionId);
 
     setHeader({Http::HEADER_SET_COOKIE, cookie.toRawForm()});
 }
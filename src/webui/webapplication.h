@@ -40,10 +40,11 @@
 #include "base/http/irequesthandler.h"
 #include "base/http/responsebuilder.h"
 #include "base/http/types.h"
+#include "base/metrics.h"
 #include "base/utils/net.h"
 #include "base/utils/version.h"
 
-constexpr Utils::Version<int, 3, 2> API_VERSION {2, 7, 0};
+constexpr Utils::Version<int, 3, 2> API_VERSION {2, 9, 0};
 
 class APIController;
 class WebApplication;
@@ -95,6 +96,9 @@ public:
     const Http::Request &request() const;
     const Http::Environment &env() const;
 
+signals:
+    void sessionEnded(const QString &sessionId);
+
 private:
     void doProcessRequest();
     void configure();
@@ -104,6 +108,7 @@ private:
 
     void sendFile(const QString &path);
     void sendWebUIFile();
+    void sendMetrics();
 
     void translateDocument(QString &data) const;
 
@@ -157,4 +162,8 @@ private:
     bool m_isHttpsEnabled;
 
     QVector<Http::Header> m_prebuiltHeaders;
+
+    // handling time of the successful API calls, keyed by "scope/action"
+    QHash<QString, Metrics::Histogram> m_apiLatencies;
+    int m_metricsSizeHint = 0;
 };
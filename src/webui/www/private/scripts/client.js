@@ -540,6 +540,138 @@ window.addEvent('load', function() {
             child.className = (child.id === selectedTracker) ? "selectedFilter" : "";
     };
 
+    // Applies changes received from sync/maindata or from the event stream
+    const processMainData = function(response) {
+        clearTimeout(torrentsFilterInputTimer);
+        let torrentsTableSelectedRows;
+        let update_categories = false;
+        let updateTags = false;
+        let updateTrackers = false;
+        const full_update = (response['full_update'] === true);
+        if (full_update) {
+            torrentsTableSelectedRows = torrentsTable.selectedRowsIds();
+            torrentsTable.clear();
+            category_list = {};
+            tagList = {};
+        }
+        if (response['rid']) {
+            syncMainDataLastResponseId = response['rid'];
+        }
+        if (response['categories']) {
+            for (const key in response['categories']) {
+                const category = response['categories'][key];
+                const categoryHash = genHash(key);
+                if (category_list[categoryHash] !== undefined) {
+                    // only the save path can change for existing categories
+                    category_list[categoryHash].savePath = category.savePath;
+                }
+                else {
+                    category_list[categoryHash] = {
+                        name: category.name,
+                        savePath: category.savePath,
+                        torrents: []
+                    };
+                }
+            }
+            update_categories = true;
+        }
+        if (response['categories_removed']) {
+            response['categories_removed'].each(function(category) {
+                const categoryHash = genHash(category);
+                delete category_list[categoryHash];
+            });
+            update_categories = true;
+        }
+        if (response['tags']) {
+            for (const tag of response['tags']) {
+                const tagHash = genHash(tag);
+                if (!tagList[tagHash]) {
+                    tagList[tagHash] = {
+                        name: tag,
+                        torrents: []
+                    };
+                }
+            }
+            updateTags = true;
+        }
+        if (response['tags_removed']) {
+            for (let i = 0; i < response['tags_removed'].length; ++i) {
+                const tagHash = genHash(response['tags_removed'][i]);
+                delete tagList[tagHash];
+            }
+            updateTags = true;
+        }
+        if (response['trackers']) {
+            for (const tracker in response['trackers']) {
+                const torrents = response['trackers'][tracker];
+                const hash = genHash(tracker);
+                trackerList.set(hash, {
+                    url: tracker,
+                    torrents: torrents
+                });
+            }
+            updateTrackers = true;
+        }
+        if (response['trackers_removed']) {
+            for (let i = 0; i < response['trackers_removed'].length; ++i) {
+                const tracker = response['trackers_removed'][i];
+                const hash = genHash(tracker);
+                trackerList.delete(hash);
+            }
+            updateTrackers = true;
+        }
+        if (response['torrents']) {
+            let updateTorrentList = false;
+            for (const key in response['torrents']) {
+                response['torrents'][key]['hash'] = key;
+                response['torrents'][key]['rowId'] = key;
+                if (response['torrents'][key]['state'])
+                    response['torrents'][key]['status'] = response['torrents'][key]['state'];
+                torrentsTable.updateRowData(response['torrents'][key]);
+                if (addTorrentToCategoryList(response['torrents'][key]))
+                    update_categories = true;
+                if (addTorrentToTagList(response['torrents'][key]))
+                    updateTags = true;
+                if (response['torrents'][key]['name'])
+                    updateTorrentList = true;
+            }
+
+            if (updateTorrentList)
+                setupCopyEventHandler();
+        }
+        if (response['torrents_removed'])
+            response['torrents_removed'].each(function(hash) {
+                torrentsTable.removeRow(hash);
+                removeTorrentFromCategoryList(hash);
+                update_categories = true; // Always to update All category
+                removeTorrentFromTagList(hash);
+                updateTags = true; // Always to update All tag
+            });
+        torrentsTable.updateTable(full_update);
+        torrentsTable.altRow();
+        if (response['server_state']) {
+            const tmp = response['server_state'];
+            for (const k in tmp)
+                serverState[k] = tmp[k];
+            processServerState();
+        }
+        updateFiltersList();
+        if (update_categories) {
+            updateCategoryList();
+            window.qBittorrent.TransferList.contextMenu.updateCategoriesSubMenu(category_list);
+        }
+        if (updateTags) {
+            updateTagList();
+            window.qBittorrent.TransferList.contextMenu.updateTagsSubMenu(tagList);
+        }
+        if (updateTrackers)
+            updateTrackerList();
+
+        if (full_update)
+            // re-select previously selected rows
+            torrentsTable.reselectRows(torrentsTableSelectedRows);
+    };
+
     let syncMainDataTimer;
     const syncMainData = function() {
         const url = new URI('api/v2/sync/maindata');
@@ -557,144 +689,38 @@ window.addEvent('load', function() {
             },
             onSuccess: function(response) {
                 $('error_div').set('html', '');
-                if (response) {
-                    clearTimeout(torrentsFilterInputTimer);
-                    let torrentsTableSelectedRows;
-                    let update_categories = false;
-                    let updateTags = false;
-                    let updateTrackers = false;
-                    const full_update = (response['full_update'] === true);
-                    if (full_update) {
-                        torrentsTableSelectedRows = torrentsTable.selectedRowsIds();
-                        torrentsTable.clear();
-                        category_list = {};
-                        tagList = {};
-                    }
-                    if (response['rid']) {
-                        syncMainDataLastResponseId = response['rid'];
-                    }
-                    if (response['categories']) {
-                        for (const key in response['categories']) {
-                            const category = response['categories'][key];
-                            const categoryHash = genHash(key);
-                            if (category_list[categoryHash] !== undefined) {
-                                // only the save path can change for existing categories
-                                category_list[categoryHash].savePath = category.savePath;
-                            }
-                            else {
-                                category_list[categoryHash] = {
-                                    name: category.name,
-                                    savePath: category.savePath,
-                                    torrents: []
-                                };
-                            }
-                        }
-                        update_categories = true;
-                    }
-                    if (response['categories_removed']) {
-                        response['categories_removed'].each(function(category) {
-                            const categoryHash = genHash(category);
-                            delete category_list[categoryHash];
-                        });
-                        update_categories = true;
-                    }
-                    if (response['tags']) {
-                        for (const tag of response['tags']) {
-                            const tagHash = genHash(tag);
-                            if (!tagList[tagHash]) {
-                                tagList[tagHash] = {
-                                    name: tag,
-                                    torrents: []
-                                };
-                            }
-                        }
-                        updateTags = true;
-                    }
-                    if (response['tags_removed']) {
-                        for (let i = 0; i < response['tags_removed'].length; ++i) {
-                            const tagHash = genHash(response['tags_removed'][i]);
-                            delete tagList[tagHash];
-                        }
-                        updateTags = true;
-                    }
-                    if (response['trackers']) {
-                        for (const tracker in response['trackers']) {
-                            const torrents = response['trackers'][tracker];
-                            const hash = genHash(tracker);
-                            trackerList.set(hash, {
-                                url: tracker,
-                                torrents: torrents
-                            });
-                        }
-                        updateTrackers = true;
-                    }
-                    if (response['trackers_removed']) {
-                        for (let i = 0; i < response['trackers_removed'].length; ++i) {
-                            const tracker = response['trackers_removed'][i];
-                            const hash = genHash(tracker);
-                            trackerList.delete(hash);
-                        }
-                        updateTrackers = true;
-                    }
-                    if (response['torrents']) {
-                        let updateTorrentList = false;
-                        for (const key in response['torrents']) {
-                            response['torrents'][key]['hash'] = key;
-                            response['torrents'][key]['rowId'] = key;
-                            if (response['torrents'][key]['state'])
-                                response['torrents'][key]['status'] = response['torrents'][key]['state'];
-                            torrentsTable.updateRowData(response['torrents'][key]);
-                            if (addTorrentToCategoryList(response['torrents'][key]))
-                                update_categories = true;
-                            if (addTorrentToTagList(response['torrents'][key]))
-                                updateTags = true;
-                            if (response['torrents'][key]['name'])
-                                updateTorrentList = true;
-                        }
-
-                        if (updateTorrentList)
-                            setupCopyEventHandler();
-                    }
-                    if (response['torrents_removed'])
-                        response['torrents_removed'].each(function(hash) {
-                            torrentsTable.removeRow(hash);
-                            removeTorrentFromCategoryList(hash);
-                            update_categories = true; // Always to update All category
-                            removeTorrentFromTagList(hash);
-                            updateTags = true; // Always to update All tag
-                        });
-                    torrentsTable.updateTable(full_update);
-                    torrentsTable.altRow();
-                    if (response['server_state']) {
-                        const tmp = response['server_state'];
-                        for (const k in tmp)
-                            serverState[k] = tmp[k];
-                        processServerState();
-                    }
-                    updateFiltersList();
-                    if (update_categories) {
-                        updateCategoryList();
-                        window.qBittorrent.TransferList.contextMenu.updateCategoriesSubMenu(category_list);
-                    }
-                    if (updateTags) {
-                        updateTagList();
-                        window.qBittorrent.TransferList.contextMenu.updateTagsSubMenu(tagList);
-                    }
-                    if (updateTrackers)
-                        updateTrackerList();
-
-                    if (full_update)
-                        // re-select previously selected rows
-                        torrentsTable.reselectRows(torrentsTableSelectedRows);
-                }
+                if (response)
+                    processMainData(response);
+                openEventStream();
                 syncRequestInProgress = false;
-                syncData(getSyncMainDataInterval());
+                // with the event stream open, polling only picks up what isn't streamed (e.g. trackers)
+                syncData(isEventStreamOpen() ? EVENT_STREAM_SYNC_INTERVAL : getSyncMainDataInterval());
             }
         });
         syncRequestInProgress = true;
         request.send();
     };
 
+    const EVENT_STREAM_SYNC_INTERVAL = 30000;
+    let eventStream = null;
+    const isEventStreamOpen = function() {
+        return ((eventStream !== null) && (eventStream.readyState === EventSource.OPEN));
+    };
+
+    const openEventStream = function() {
+        if ((typeof EventSource === 'undefined') || (eventStream !== null))
+            return;
+
+        eventStream = new EventSource('api/v2/sync/events');
+        eventStream.addEventListener('maindata', function(event) {
+            processMainData(JSON.parse(event.data));
+        });
+        // events may have been missed while disconnected, catch up by polling
+        eventStream.onopen = function() {
+            updateMainData();
+        };
+    };
+
     updateMainData = function() {
         torrentsTable.updateTable();
         syncData(100);
@@ -0,0 +1,179 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2026  The qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+'use strict';
+
+if (window.qBittorrent === undefined) {
+    window.qBittorrent = {};
+}
+
+window.qBittorrent.PiecesBar = (function() {
+    const exports = function() {
+        return {
+            PiecesBar: PiecesBar
+        };
+    };
+
+    const STATUS_DOWNLOADING = 1;
+    const STATUS_DOWNLOADED = 2;
+
+    let piecesBarUniqueId = 0;
+    const PiecesBar = new Class({
+        initialize: function(parameters) {
+            const vals = {
+                'id': 'piecesbar_' + (piecesBarUniqueId++),
+                'height': 16,
+                'downloadingColor': 'green',
+                'haveColor': 'blue',
+                'borderColor': '#999'
+            };
+            if (parameters && ($type(parameters) == 'object')) $extend(vals, parameters);
+            if (vals.height < 12) vals.height = 12;
+
+            const obj = new Element('div', {
+                'id': vals.id,
+                'class': 'piecesbarWrapper',
+                'styles': {
+                    'border': '1px solid ' + vals.borderColor,
+                    'height': vals.height,
+                    'position': 'relative'
+                }
+            });
+            obj.vals = vals;
+            obj.vals.pieces = new Uint8Array(0);
+            obj.vals.version = 0;
+            obj.vals.canvas = new Element('canvas', {
+                'id': vals.id + '_canvas',
+                'class': 'piecesbarCanvas',
+                'styles': {
+                    'width': '100%',
+                    'height': vals.height,
+                    'display': 'block'
+                }
+            });
+            obj.appendChild(obj.vals.canvas);
+
+            obj.getVersion = PiecesBar_getVersion;
+            obj.applyRuns = PiecesBar_applyRuns;
+            obj.clear = PiecesBar_clear;
+            obj.refresh = PiecesBar_refresh;
+            return obj;
+        }
+    });
+
+    function PiecesBar_getVersion() {
+        return this.vals.version;
+    }
+
+    // Applies a "rle" formatted answer of torrents/pieceStates
+    function PiecesBar_applyRuns(data) {
+        if (data.pieces !== this.vals.pieces.length)
+            this.vals.pieces = new Uint8Array(data.pieces);
+        this.vals.version = data.version;
+
+        if (data.runs === undefined) {
+            this.refresh();
+            return;
+        }
+
+        const runs = atob(data.runs);
+        let index = data.offset;
+        let value = 0;
+        let shift = 0;
+        for (let i = 0; i < runs.length; ++i) {
+            const byte = runs.charCodeAt(i);
+            value += (byte & 0x7F) * Math.pow(2, shift);
+            shift += 7;
+            if ((byte & 0x80) !== 0)
+                continue;
+
+            const state = value % 4;
+            const length = Math.floor(value / 4);
+            this.vals.pieces.fill(state, index, index + length);
+            index += length;
+            value = 0;
+            shift = 0;
+        }
+
+        this.refresh();
+    }
+
+    function PiecesBar_clear() {
+        this.vals.pieces = new Uint8Array(0);
+        this.vals.version = 0;
+        this.refresh();
+    }
+
+    function PiecesBar_refresh() {
+        const canvas = this.vals.canvas;
+        const width = canvas.offsetWidth;
+        const height = this.vals.height;
+        if (width <= 0)
+            return;
+
+        canvas.width = width;
+        canvas.height = height;
+        const ctx = canvas.getContext('2d');
+        ctx.clearRect(0, 0, width, height);
+
+        const pieces = this.vals.pieces;
+        if (pieces.length === 0)
+            return;
+
+        // Draw each pixel column with the state of most of its pieces
+        const piecesPerPixel = pieces.length / width;
+        for (let x = 0; x < width; ++x) {
+            const first = Math.floor(x * piecesPerPixel);
+            const last = Math.max(first + 1, Math.floor((x + 1) * piecesPerPixel));
+            let downloading = 0;
+            let downloaded = 0;
+            for (let i = first; i < last; ++i) {
+                if (pieces[i] === STATUS_DOWNLOADING)
+                    ++downloading;
+                else if (pieces[i] === STATUS_DOWNLOADED)
+                    ++downloaded;
+            }
+
+            if (downloading > 0) {
+                ctx.fillStyle = this.vals.downloadingColor;
+                ctx.globalAlpha = 1;
+            }
+            else if (downloaded > 0) {
+                ctx.fillStyle = this.vals.haveColor;
+                ctx.globalAlpha = downloaded / (last - first);
+            }
+            else {
+                continue;
+            }
+            ctx.fillRect(x, 0, 1, height);
+        }
+        ctx.globalAlpha = 1;
+    }
+
+    return exports();
+})();
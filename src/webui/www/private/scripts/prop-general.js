@@ -39,7 +39,13 @@ window.qBittorrent.PropGeneral = (function() {
         };
     };
 
+    const piecesBar = new window.qBittorrent.PiecesBar.PiecesBar({
+        height: 16
+    });
+    $('pieces_bar').appendChild(piecesBar);
+
     const clearData = function() {
+        piecesBar.clear();
         $('time_elapsed').set('html', '');
         $('eta').set('html', '');
         $('nb_connections').set('html', '');
@@ -67,6 +73,7 @@ window.qBittorrent.PropGeneral = (function() {
     };
 
     let loadTorrentDataTimer;
+    let piecesBarHash = "";
     const loadTorrentData = function() {
         if ($('prop_general').hasClass('invisible')
             || $('propertiesPanel_collapseToggle').hasClass('panel-expand')) {
@@ -202,6 +209,22 @@ window.qBittorrent.PropGeneral = (function() {
                 loadTorrentDataTimer = loadTorrentData.delay(5000);
             }
         }).send();
+
+        if (current_hash !== piecesBarHash) {
+            piecesBarHash = current_hash;
+            piecesBar.clear();
+        }
+        const piecesUrl = new URI('api/v2/torrents/pieceStates?hash=' + current_hash
+            + '&format=rle&version=' + piecesBar.getVersion());
+        new Request.JSON({
+            url: piecesUrl,
+            noCache: true,
+            method: 'get',
+            onSuccess: function(data) {
+                if (data && (current_hash === piecesBarHash))
+                    piecesBar.applyRuns(data);
+            }
+        }).send();
     };
 
     const updateData = function() {